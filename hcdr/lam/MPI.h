@@ -37,6 +37,11 @@
 #define MPI_INCLUDED
 #include <mpi.h>
 
+/* following for the Annealer the mixing functions below take */
+#ifndef SA_INCLUDED
+#include "sa.h"
+#endif
+
 
 /*** CONSTANTS *************************************************************/
 
@@ -74,7 +79,6 @@ unsigned short score_method;
 int glob_interval;
 
 MPI_Group world;
-MPI_Comm *my_comm;
 MPI_Group *my_group;
 MPI_Group *local_groups;
 MPI_Comm *local_comms;
@@ -94,7 +98,7 @@ MPI_Comm root_comm;
  *                    current S                                            *
  ***************************************************************************/
 
-void UpdateLParameter(void);
+void UpdateLParameter(Annealer *an);
 
 
 
@@ -106,28 +110,29 @@ void UpdateLParameter(void);
  *          between all communicators.                                     *
  ***************************************************************************/
 
-void DoMix(void);
+void DoMix(Annealer *an);
 
-void DoGlobalMix(void);
+void DoGlobalMix(Annealer *an);
 
-void DoLocalMix(void);
+void DoLocalMix(Annealer *an);
 
-void AssignDancePartner(int nodesInMix, MPI_Comm comm, double score);
+void AssignDancePartner(Annealer *an, int nodesInMix, MPI_Comm comm,
+                        double score);
 /*** DoFixMix: for equilibration run, we only need to pass the move state **
  *             since Lam stats are not needed at constant temperature      *
  ***************************************************************************/
 
-void DoFixMix(void);
+void DoFixMix(Annealer *an);
 
 /*** MakeLamMsg: packages local Lam stats into send buffer *****************
  ***************************************************************************/
 
-void MakeLamMsg(unsigned char**sendbuf, MPI_Aint size);
+void MakeLamMsg(Annealer *an, unsigned char**sendbuf, MPI_Aint size);
 
 /*** AcceptLamMsg: receives new energy and Lam stats upon mixing ***********
  ***************************************************************************/
 
-void AcceptLamMsg(unsigned char**recvbuf, MPI_Aint size);
+void AcceptLamMsg(Annealer *an, unsigned char**recvbuf, MPI_Aint size);
 
 
 
@@ -136,7 +141,7 @@ void AcceptLamMsg(unsigned char**recvbuf, MPI_Aint size);
 /*** InitTuning: sets up/restores structs and variables for tuning runs ****
  ***************************************************************************/
 
-void InitTuning(void);
+void InitTuning(Annealer *an);
 
 /*** DoTuning: calculates the cross-correlation (for lower bound) and the **
  *             variance of local means (for upper bound) for a sub_tune_   *
@@ -147,19 +152,19 @@ void InitTuning(void);
  *             Chu's thesis, p. 63)                                        *
  ***************************************************************************/
 
-void DoTuning(void);
+void DoTuning(Annealer *an);
 
 /*** WriteTuning: writes tuning stats to files ever tune_interval **********
  ***************************************************************************/
 
-void WriteTuning(void);
+void WriteTuning(Annealer *an);
 
 /*** StopTuning: is to tuning runs what Frozen() is to a normal annealing **
  *               run: it basically checks if the tuning stop criterion     *
  *               applies and returns true if that's the case               *
  ***************************************************************************/
 
-int StopTuning(void);
+int StopTuning(Annealer *an);
 
 
 
@@ -180,17 +185,19 @@ int StopTuning(void);
  *                 their problem-specific size in move(s).c                *
  ***************************************************************************/
 
-void MakeStateMsg(unsigned char **buf, MPI_Aint padding, MPI_Aint *size);
+void MakeStateMsg(Annealer *an, unsigned char **buf, MPI_Aint padding,
+                  MPI_Aint *size);
 
-void MakeGlobalLamMsg(unsigned char **sendbuf, MPI_Aint size);
+void MakeGlobalLamMsg(Annealer *an, unsigned char **sendbuf, MPI_Aint size);
 /*** AcceptMsg: communicates a message about move stats received via MPI ***
  *              to move(s).c; see the comment for MakeStateMsg for the ra- *
  *              tionale behind the two arrays that are passed              *
  ***************************************************************************/
 
-void AcceptStateMsg(unsigned char **buf);
+void AcceptStateMsg(Annealer *an, unsigned char **buf);
 
-void AcceptGlobalLamMsg(unsigned char **recvbuf, MPI_Aint size);
+void AcceptGlobalLamMsg(Annealer *an, unsigned char **recvbuf,
+                        MPI_Aint size);
 
 
 /*** WriteMixLog: writes a detailed log giving information about each      *
@@ -201,14 +208,14 @@ void AcceptGlobalLamMsg(unsigned char **recvbuf, MPI_Aint size);
  * restarted. This feature may be implemented at some point, but not for   *
  * now.                                                                    */
 
-void WriteMixLog(double *node_prob, int* dance_partner);
+void WriteMixLog(Annealer *an, double *node_prob, int* dance_partner);
 
 /* WriteMixLog added by Seb on 31 Jul 2023 for debugging purposes. For     *
  * more info, see comments under DoMix and WriteMixLog in lsa.c            */
 
 /*** AssignGroups: Writes array of ranks to put in each group.           ***/
 
-void AssignGroups();
+void AssignGroups(Annealer *an);
 
 /***Some utility functions for AssignGroups:                             ***/
 char** extract_string_set_from_char_list(char* list, int length_list, int *length_set, int *sizes, int *displacements, int *set_sizes);
@@ -0,0 +1,271 @@
+/*****************************************************************
+ *                                                               *
+ *   check_random.c                                              *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   written by SRV (2026-10-18)                                 *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   checks of the random number generator, which 'make check'   *
+ *   builds and runs: Philox4x32-10 must give the known answers  *
+ *   of Random123, and jumping ahead, filling arrays and saving  *
+ *   and restoring the state must give the draws that drawing    *
+ *   one by one gives; it takes random.c in whole, prints a line *
+ *   per check and exits with the number that failed             *
+ *                                                               *
+ *****************************************************************/
+
+#include "random.c"
+
+#include <stdio.h>
+
+
+/*** CONSTANTS *************************************************************/
+
+#define CHECK_SEED    0x243F6A8885A308D3ULL     /* any seed and stream */
+#define CHECK_STREAM  RAND_STREAM(3, 1)
+#define CHECK_DRAWS   600           /* compared after each way of getting */
+                                    /* somewhere, over two buffers' worth */
+#define CARRY_BLOCKS  200           /* so that ctr[0] wraps inside a fill */
+
+
+/*** STATIC VARIABLES ******************************************************/
+
+static int nfailed = 0;                          /* checks that went wrong */
+
+
+/*** Check: reports the check what, which passed if ok *********************
+ ***************************************************************************/
+
+static void Check(int ok, const char *what)
+{
+  printf("%s: %s\n", ok ? "ok    " : "FAILED", what);
+  if (!ok)
+    nfailed++;
+}
+
+
+/*** Draws: the next n draws of RandomReal, one by one, into u *************
+ ***************************************************************************/
+
+static void Draws(double *u, int n)
+{
+  int i;
+
+  for (i=0; i<n; i++)
+    u[i] = RandomReal();
+}
+
+
+/*** Same: 1 if the draws u and v are the same, bit for bit ****************
+ ***************************************************************************/
+
+static int Same(const double *u, const double *v, int n)
+{
+  return !memcmp(u, v, n * sizeof(double));
+}
+
+
+#ifndef USE_ERAND48
+
+/*** CheckKnownAnswers: the Philox4x32-10 blocks of the Random123 known ****
+ *                      answer tests (kat_vectors) must come out as the     *
+ *                      two draws of their block: the top 53 bits of words *
+ *                      0-1 and of words 2-3; the last one is reached by a *
+ *                      jump, and the one after block 2^32-1 by drawing on *
+ *                      past it, which must carry into ctr[1]              *
+ ***************************************************************************/
+
+static double KnownDraw(uint32_t hi, uint32_t lo)
+{
+  return (double)((((uint64_t)hi << 32) | lo) >> 11) * (1. / 9007199254740992.);
+}
+
+static void CheckKnownAnswers(void)
+{
+  RandState st;
+  double    u[2], v[2], w[2*CARRY_BLOCKS];
+  int       bad = 0;
+
+  InitRandom(0, 0);                          /* key 0, counter 0 */
+  Draws(u, 2);
+  bad += u[0] != KnownDraw(0x6627e8d5, 0xe169c58d);
+  bad += u[1] != KnownDraw(0xbc57ac4c, 0x9b00dbd8);
+
+  memset(&st, 0xff, sizeof(st));         /* key and counter all ones */
+  st.pos = 0;
+  SetRandomState(&st);
+  Draws(u, 2);
+  bad += u[0] != KnownDraw(0x408f276d, 0x41c83b0e);
+  bad += u[1] != KnownDraw(0xa20bc7c6, 0x6d5451fd);
+
+  st.key[0] = 0xa4093822;                  /* the digits of pi, 1000 */
+  st.key[1] = 0x299f31d0;                  /* blocks short of theirs */
+  st.ctr[0] = 0x243f6a88 - 1000;
+  st.ctr[1] = 0x85a308d3;
+  st.ctr[2] = 0x13198a2e;
+  st.ctr[3] = 0x03707344;
+  SetRandomState(&st);
+  RandomJump(2000);
+  Draws(u, 2);
+  bad += u[0] != KnownDraw(0xd16cfe09, 0x94fdcceb);
+  bad += u[1] != KnownDraw(0x5001e420, 0x24126ea1);
+  Check(!bad, "Philox4x32-10 gives the Random123 known answers");
+
+  st.ctr[0] = 0;                                      /* block 2^32 ... */
+  st.ctr[1] = 1;
+  SetRandomState(&st);
+  Draws(v, 2);
+  st.ctr[0] = (uint32_t)-CARRY_BLOCKS;     /* ... CARRY_BLOCKS after this, */
+  st.ctr[1] = 0;                           /* by a jump and one by one     */
+  SetRandomState(&st);
+  RandomJump(2 * CARRY_BLOCKS);
+  Draws(u, 2);
+  bad = !Same(u, v, 2);
+  SetRandomState(&st);
+  Draws(w, 1);
+  RandomFill(w+1, 2*CARRY_BLOCKS - 1);
+  Draws(u, 2);
+  Check(!bad && Same(u, v, 2), "the block counter carries into ctr[1]");
+}
+
+#endif
+
+
+/*** CheckJump: RandomJump(n) after p draws must land where p+n draws one **
+ *              by one do, for jumps to either half of a block, within the *
+ *              buffer and across buffers                                  *
+ ***************************************************************************/
+
+static void CheckJump(void)
+{
+  int    starts[] = { 0, 1, 255, 256, 257, 1000 };
+  int    jumps[]  = { 0, 1, 2, 3, 254, 255, 256, 257, 511, 512, 100001 };
+  double u[CHECK_DRAWS], v[CHECK_DRAWS];
+  int    s, j, k, bad = 0;
+
+  for (s=0; s<(int)(sizeof(starts)/sizeof(starts[0])); s++)
+    for (j=0; j<(int)(sizeof(jumps)/sizeof(jumps[0])); j++) {
+      InitRandom(CHECK_SEED, CHECK_STREAM);
+      for (k=0; k<starts[s]; k++)
+        RandomReal();
+      RandomJump(jumps[j]);
+      Draws(u, CHECK_DRAWS);
+
+      InitRandom(CHECK_SEED, CHECK_STREAM);
+      for (k=0; k<starts[s]+jumps[j]; k++)
+        RandomReal();
+      Draws(v, CHECK_DRAWS);
+      bad += !Same(u, v, CHECK_DRAWS);
+    }
+  Check(!bad, "RandomJump(n) gives the draws that n calls to RandomReal "
+        "skip to");
+}
+
+
+/*** CheckFill: RandomFill and RandomFillInt must give the draws that as ***
+ *              many calls to RandomReal and RandomInt give, and leave the *
+ *              generator where those leave it, wherever in the buffer     *
+ *              they start and end                                         *
+ ***************************************************************************/
+
+static void CheckFill(void)
+{
+  int    starts[] = { 0, 1, 255, 256 };
+  int    sizes[]  = { 1, 255, 256, 257, 1000 };
+  int    maxes[]  = { 1, 7, 1000 };
+  double u[1000+1], v[1000+1];
+  int    a[1000], b[1000];
+  int    s, n, m, k, bad = 0;
+
+  for (s=0; s<(int)(sizeof(starts)/sizeof(starts[0])); s++)
+    for (n=0; n<(int)(sizeof(sizes)/sizeof(sizes[0])); n++) {
+      InitRandom(CHECK_SEED, CHECK_STREAM);
+      for (k=0; k<starts[s]; k++)
+        RandomReal();
+      RandomFill(u, sizes[n]);
+      u[sizes[n]] = RandomReal();                     /* and then on */
+
+      InitRandom(CHECK_SEED, CHECK_STREAM);
+      for (k=0; k<starts[s]; k++)
+        RandomReal();
+      Draws(v, sizes[n] + 1);
+      bad += !Same(u, v, sizes[n] + 1);
+
+      for (m=0; m<(int)(sizeof(maxes)/sizeof(maxes[0])); m++) {
+        InitRandom(CHECK_SEED, CHECK_STREAM);
+        for (k=0; k<starts[s]; k++)
+          RandomReal();
+        RandomFillInt(a, sizes[n], maxes[m]);
+
+        InitRandom(CHECK_SEED, CHECK_STREAM);
+        for (k=0; k<starts[s]; k++)
+          RandomReal();
+        for (k=0; k<sizes[n]; k++)
+          b[k] = RandomInt(maxes[m]);
+        bad += memcmp(a, b, sizes[n] * sizeof(int)) != 0;
+      }
+    }
+  Check(!bad, "RandomFill and RandomFillInt give the draws of RandomReal "
+        "and RandomInt");
+}
+
+
+/*** CheckState: a state saved by GetRandomState after any number of ******
+ *               draws (or a jump) must give the same draws again once     *
+ *               SetRandomState has restored it, whatever the generator    *
+ *               did in between                                            *
+ ***************************************************************************/
+
+static void CheckState(void)
+{
+  int       starts[] = { 0, 1, 255, 256, 257, 5000 };
+  RandState st;
+  double    u[CHECK_DRAWS], v[CHECK_DRAWS];
+  int       s, k, bad = 0;
+
+  for (s=0; s<(int)(sizeof(starts)/sizeof(starts[0])); s++) {
+    InitRandom(CHECK_SEED, CHECK_STREAM);
+    for (k=0; k<starts[s]; k++)
+      RandomReal();
+    GetRandomState(&st);
+    Draws(u, CHECK_DRAWS);
+
+    InitRandom(CHECK_SEED + 1, RAND_STREAM(0, 0));  /* somewhere else */
+    Draws(v, 3);
+    SetRandomState(&st);
+    Draws(v, CHECK_DRAWS);
+    bad += !Same(u, v, CHECK_DRAWS);
+  }
+
+  InitRandom(CHECK_SEED, CHECK_STREAM);
+  RandomJump(12345);                             /* into a block's middle */
+  GetRandomState(&st);
+  Draws(u, CHECK_DRAWS);
+  RandomJump(77);
+  SetRandomState(&st);
+  Draws(v, CHECK_DRAWS);
+  bad += !Same(u, v, CHECK_DRAWS);
+
+  Check(!bad, "SetRandomState goes on with the draws of the state "
+        "GetRandomState saved");
+}
+
+
+/*** main: runs all the checks *********************************************
+ ***************************************************************************/
+
+int main(int argc, char **argv)
+{
+#ifndef USE_ERAND48
+  CheckKnownAnswers();
+#endif
+  CheckJump();
+  CheckFill();
+  CheckState();
+
+  printf("%d check(s) failed\n", nfailed);
+  return nfailed;
+}
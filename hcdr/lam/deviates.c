@@ -27,9 +27,7 @@
 #include "distributions.h"   /* problem independent distributions */ 
                              /* need qgt2_init and qlt2_init prototypes */
 #include "error.h"    /* use fly_team standard error routine */
-#include "random.h"   /* prototype for InitERand call */
-#define BYTESIZE 8
-#define LOWBITS 0x330E    /* for drand (32 bits) to erand (48 bits) compatibility */
+#include "random.h"   /* prototype for InitRandom call */
 
 /***************************************************
  * This is main for the deviate generation code    *
@@ -41,8 +39,6 @@ int main( int argc, char **argv)
 {  /* begin MAIN deviate*/
 
      double theta_deviate;
-     unsigned short xsubj [3]; /* used for InitERand call */
-   /* NOTE: xsubj gets changed with each call to RandomReal */
 
 /**************************************************
 * these are for the deviate distributions
@@ -55,23 +51,21 @@ int main( int argc, char **argv)
      int i;
      int number_of_trials = 1000000; 
      long seedval;
-     unsigned short left16, middle16;
-     int left;
 
 /*******************
 * initialization:  *
 *******************/
 
         if (argc != 5)
-        {error ("gen_deviates: <dist:1=exp,2=uni,3=absnor,4=abslor,5=lor2,6=poi,7=gen,8=stdnorm,9=pareto,10=nor> <1<qvalue<3> <theta_bar> <deviates outputfile>\n");
+        {error ("gen_deviates: <dist:1=exp,2=uni,3=absnor,4=abslor,5=lor2,6=poi,7=gen,8=stdnorm,9=pareto,10=nor,11=genrej> <1<qvalue<3> <theta_bar> <deviates outputfile>\n");
         exit (1);}
 
         /* distribution = argv[1]; */
 
 	DistP.distribution=atoi(argv[1]);
 	printf("distribution type is %d \n", DistP.distribution); 
-	if ((DistP.distribution > 10) || (DistP.distribution < 1))
-	  {error ("gen_deviates: distribution must be int from 1 to 10 \n");}
+	if ((DistP.distribution > 11) || (DistP.distribution < 1))
+	  {error ("gen_deviates: distribution must be int from 1 to 11 \n");}
 	else if 
 	  ((DistP.distribution == 5)||(DistP.distribution == 8)||(DistP.distribution == 10))
 	  {printf ("gen_deviates: distributions return negative values \n");
@@ -95,22 +89,15 @@ int main( int argc, char **argv)
                 exit (1); }
 
 
-  /* initialize the random number generator, now erand48() */
+  /* initialize the random number generator */
 
   seedval  = 514804963;
   
-  xsubj[0] = LOWBITS;
-  middle16 = (unsigned short) seedval ;
-  xsubj[1] = middle16;
-  left = seedval >> (BYTESIZE * sizeof(unsigned short));
-  left16 = (unsigned short) left;
-  xsubj[2] = left16;
-
-  InitERand(xsubj);          /* makes the xsubj array static to random.c */
+  InitRandom((uint64_t)seedval, 0);
 
   /* general visiting intialization */
 
-  if (DistP.distribution == 7)
+  if ((DistP.distribution == 7) || (DistP.distribution == 11))
    {
      if ((DistP.q >= 3.0) || (DistP.q <= 1.0))
        {error ("gen_deviates: q must be between 1 and 3 \n");}
@@ -2,7 +2,7 @@
 * distributions.c  Created 5-02 by: Lorraine Greenwald
 * used with deviates.c to generate only deviates
 * used with the SA applications for move generation
-* uses RandomReal  which uses and modifies xsubj 
+* uses RandomReal  whose generator is initialized
 * elsewhere i.e. move.c or deviates.c
 * takes distribution type q value theta_bar and output file on command line
 *************************************************************************
@@ -26,6 +26,20 @@
 #include "distributions.h"   /* problem independent distibutions need q_init prototype */
  
 static double pi=3.14159265;     /* pi used for several distributions */
+
+/* SRV 2026-10-17: the inverse-CDF table of tsallis_visit: level L holds   *
+ * the tail probabilities r in [2^-(L+1), 2^-L] in TSALLIS_CELLS cells of  *
+ * equal width, so the heavy tails get as many nodes as the middle; each   *
+ * node has the deviate at theta_bar = 1 and its slope across the cell     */
+
+#define TSALLIS_LEVELS  64           /* r down to 2^-64 (u has 53 bits) */
+#define TSALLIS_CELLS   64                         /* cells per level */
+#define TSALLIS_YMAX    1.e150      /* deviates beyond are not tabled */
+
+static double tsallis_y[TSALLIS_LEVELS][TSALLIS_CELLS+1];     /* deviates */
+static double tsallis_d[TSALLIS_LEVELS][TSALLIS_CELLS+1];  /* their slopes */
+static int    tsallis_levels = 0;             /* levels built, 0 = none */
+static double tsallis_rmin;       /* r below which the table ends */
 /************************************************************
 * print_qgt2_visit created for calculation debugging 
 * is OK to keep around. 1-23-03  LG 
@@ -460,6 +474,112 @@ double qlt2_visit( double theta_bar)
 } /*end  qlt2_visit*/      
 
 
+/********************************************************
+* tsallis_table builds the inverse-CDF table of the       
+* Tsallis GSA q-distribution for theta_bar = 1 (SRV 2026).
+* theta_bar only scales the distribution: the deviate for 
+* theta_bar is fact1 times the one for 1, so the table is 
+* built once per q and tsallis_visit just scales it.      
+* At theta_bar = 1 the distribution is a Student t with   
+* nu = (3-q)/(q-1) degrees of freedom, y = t/sqrt(3-q), so
+* the tail probability P(|y| > Y) is the incomplete beta  
+* function I_x(nu/2, 1/2) with x = 1/(1+(q-1)Y^2), which  
+* is inverted by bisection (in log x) for every node.     
+********************************************************/ 
+static void tsallis_table(void)
+{  /* begin tsallis_table */
+   double nu;             /* degrees of freedom of the t distribution */
+   double lo, hi, mid;    /* bisection bracket for log x               */
+   double r, x, y;        /* tail probability, beta argument, deviate  */
+   double width;          /* width of a cell of the level in r         */
+   int    level, k, iter;
+
+   nu = (3.-DistP.q)/(DistP.q-1.);
+   hi = 0.;                                        /* x = 1 at r = 1 */
+
+   for (level=0; level<TSALLIS_LEVELS; level++) {
+     width = ldexp(1., -level) / (2*TSALLIS_CELLS);
+     for (k=0; k<=TSALLIS_CELLS; k++) {
+       r = ldexp(1., -level) - k*width;
+       if ( r >= 1. )
+	 y = 0.;
+       else {
+	 lo = log(DBL_MIN);        /* r only goes down, and so does x */
+	 for (iter=0; iter<100 && hi-lo > 1.e-15*fabs(lo); iter++) {
+	   mid = .5*(lo+hi);
+	   if ( betai(.5*nu, .5, exp(mid)) > r )
+	     hi = mid;
+	   else
+	     lo = mid;
+	 }
+	 x = exp(.5*(lo+hi));
+	 y = sqrt((1.-x)/((DistP.q-1.)*x));
+       }
+       if ( y > TSALLIS_YMAX )
+	 return;             /* the levels built so far will have to do */
+       tsallis_y[level][k] = y;
+       tsallis_d[level][k] = width / (2.*DistP.alpha) *
+	 exp(DistP.c*log1p((DistP.q-1.)*y*y));          /* dy/dr = 1/(2g) */
+     }
+     tsallis_levels = level+1;
+     tsallis_rmin   = ldexp(1., -tsallis_levels);
+   }
+}  /* end tsallis_table */
+
+
+/********************************************************
+* tsallis_visit generates random deviates for 1 < q < 3  
+* for the Tsallis GSA q-distribution from the table made 
+* by tsallis_table, in O(1): a uniform r picks the level 
+* by its binary exponent and the cell by its mantissa,   
+* and the deviate is the cubic Hermite interpolation of  
+* the nodes.  For q > 2 deviates beyond trunc are drawn  
+* again, which leaves those of qgt2_visit on [-trunc,    
+* trunc]; fact1 is kept until theta_bar changes.         
+* the rejection methods below are distribution 11.       
+********************************************************/ 
+double tsallis_visit(double theta_bar)
+{  /* begin tsallis_visit */
+   static __thread double fact1, oldtheta=(-1.0);  /* per chain (SRV) */
+   double u, r, s, y;
+   int    level, k, e;
+
+   if ( tsallis_levels == 0 )
+     tsallis_table();
+
+   if (theta_bar != oldtheta) {
+     oldtheta = theta_bar;
+     fact1 = exp(log(theta_bar)/(3.-DistP.q));
+   }
+
+   do {
+     u = RandomReal();               /* the sign and r from one draw */
+     r = (u < .5) ? 2.*u : 2.*(1.-u);
+
+     if ( r >= 1. )
+       y = 0.;
+     else if ( r < tsallis_rmin )        /* beyond the table (rarely) */
+       y = tsallis_y[tsallis_levels-1][TSALLIS_CELLS];
+     else {
+       r     = frexp(r, &e);           /* r = m 2^e with .5 <= m < 1 */
+       level = -e;
+       s     = (1.-r)*(2*TSALLIS_CELLS);
+       k     = (int)s;
+       if ( k == TSALLIS_CELLS )
+	 k--;
+       s    -= k;
+       y     = (1.+2.*s)*(1.-s)*(1.-s) * tsallis_y[level][k]
+	     + s*(1.-s)*(1.-s)         * tsallis_d[level][k]
+	     + s*s*(3.-2.*s)           * tsallis_y[level][k+1]
+	     + s*s*(s-1.)              * tsallis_d[level][k+1];
+     }
+     y *= fact1;
+   } while (DistP.q > 2. && y > DistP.trunc);
+
+   return (u < .5) ? -y : y;
+}  /* end tsallis_visit */
+
+
 /**********************************************************
 * qgt2_init initializes the factors used for the  general *
 * visiting distribution for q between 2 and 3, but are    *
@@ -479,6 +599,7 @@ void qgt2_init() /* this routine in distributions.c */
   DistP.rejects = 0;          
   DistP.alpha = sqrt((DistP.q-1.)/ pi)* DistP.fact2; /* NOT dependent on theta_bar */       
   DistP.alpha2 = (sqrt(2.)/ 2.)* DistP.alpha; /* NOT dependent on theta_bar */       
+  tsallis_levels = 0;     /* tsallis_visit rebuilds its table for this q */
   /* printf ("DistP.alpha   = %16.8f \n", DistP.alpha ); /* debug 1-13-03 */
   /* printf ("DistP.alpha2  = %16.8f \n", DistP.alpha2 ); /* debug 1-13-03 */
   /* printf ("q = %lf factor2= %lf gam1= %lf gam2= %lf \n",DistP.q, DistP.fact2, DistP.gam1, DistP.gam2 ); */
@@ -564,6 +685,7 @@ void qlt2_init() /* this routine in distributions.c */
   DistP.c = 1./( DistP.q-1.);          
   DistP.alpha = sqrt((DistP.q-1.)/ pi)* DistP.fact2; /* NOT dependent on theta_bar */       
   DistP.alpha2 = (sqrt(2.)/ 2.)* DistP.alpha; /* NOT dependent on theta_bar */       
+  tsallis_levels = 0;     /* tsallis_visit rebuilds its table for this q */
 
   /* printf ("DistP.alpha   = %16.8f \n", DistP.alpha ); /* debug 1-13-03 */
   /* printf ("DistP.alpha2  = %16.8f \n", DistP.alpha2 ); /* debug 1-13-03 */
@@ -574,30 +696,32 @@ void qlt2_init() /* this routine in distributions.c */
 /*******************************************
 * gasdev returns a normally distributed 
 * deviate with zero mean and unit variance
-* use RandomReal() rather than ran1
-* taken from Numerical Recipes in C p.289
+* SRV 2026-10-17: from the ziggurat of  
+* RandomNormal (random.c) rather than the 
+* polar method of Numerical Recipes, whose
+* static iset/gset kept every other one   
 *******************************************/
  double gasdev(void)
 { /* begin gasdev */  
-     static int iset=0;
-     static double gset;
-     double fac,rsq,v1,v2;
-      if (iset == 0) {
-       do {
-         v1 = 2.0*RandomReal()-1.0;
-         v2 = 2.0*RandomReal()-1.0;
-         rsq = v1*v1 + v2*v2;
-       } while (rsq >= 1.0 || rsq == 0.0);
-       fac=sqrt(-2.0*log(rsq)/rsq);
-       gset = v1 * fac;
-       iset=1;
-       return v2*fac;
-     } else {
-       iset = 0;
-       return gset;
-     }
+     return RandomNormal();
 }  /* end gasdev */
 
+/*********************************************
+* factln returns ln(n!) for n >= 0; the first 
+* FACTLN_CACHE of them are kept once computed 
+* taken from Numerical Recipes in C p.215
+**********************************************/
+#define FACTLN_CACHE 1024
+static double factln(int n)
+{  /* begin factln */
+   static __thread double a[FACTLN_CACHE];
+   if (n <= 1) return 0.0;
+   if (n < FACTLN_CACHE)
+      return a[n] ? a[n] : (a[n]=gammln(n+1.0));
+   else
+      return gammln(n+1.0);
+}  /* end factln */
+
 /******************************************************
 * poidev returns as a float an integer value 
 * that is a random deviate from a Poisson distribution
@@ -607,7 +731,7 @@ void qlt2_init() /* this routine in distributions.c */
 *******************************************************/
  double poidev(double xm)
 {  /* begin poidev */
-   static double sq,alxm,g,oldm=(-1.0);
+   static __thread double sq,alxm,g,oldm=(-1.0);
    double em,t,y;
     if (xm < 12.0) {
      if (xm != oldm) {
@@ -633,7 +757,7 @@ void qlt2_init() /* this routine in distributions.c */
             em = sq*y+xm;
          } while (em < 0.0);
          em = floor(em);
-         t = 0.9*(1.0+y*y)*exp(em*alxm-gammln(em+1.0)-g);
+         t = 0.9*(1.0+y*y)*exp(em*alxm-factln((int)em)-g);
       } while (RandomReal() > t);
    }
    return em;
@@ -659,18 +783,63 @@ double gammln(double xx)
    return -tmp+log(2.5066282746310005*ser/x);
 }  /* end gammln */
 
+/*********************************************
+* betacf evaluates the continued fraction for
+* the incomplete beta function (modified Lentz)
+* taken from Numerical Recipes in C p.227
+**********************************************/
+static double betacf(double a, double b, double x)
+{  /* begin betacf */
+   double aa,c,d,del,h,qab,qam,qap;
+   int m,m2;
+   qab=a+b;
+   qap=a+1.0;
+   qam=a-1.0;
+   c=1.0;
+   d=1.0-qab*x/qap;
+   if (fabs(d) < DBL_MIN) d=DBL_MIN;
+   d=1.0/d;
+   h=d;
+   for (m=1; m<=200; m++) {
+      m2=2*m;
+      aa=m*(b-m)*x/((qam+m2)*(a+m2));
+      d=1.0+aa*d;
+      if (fabs(d) < DBL_MIN) d=DBL_MIN;
+      c=1.0+aa/c;
+      if (fabs(c) < DBL_MIN) c=DBL_MIN;
+      d=1.0/d;
+      h *= d*c;
+      aa = -(a+m)*(qab+m)*x/((a+m2)*(qap+m2));
+      d=1.0+aa*d;
+      if (fabs(d) < DBL_MIN) d=DBL_MIN;
+      c=1.0+aa/c;
+      if (fabs(c) < DBL_MIN) c=DBL_MIN;
+      d=1.0/d;
+      del=d*c;
+      h *= del;
+      if (fabs(del-1.0) < 3.0e-16) break;
+   }
+   return h;
+}  /* end betacf */
+
+/*********************************************
+* betai returns the incomplete beta function 
+* I_x(a,b) for 0 <= x <= 1
+* taken from Numerical Recipes in C p.227
+**********************************************/
+double betai(double a, double b, double x)
+{  /* begin betai */
+   double bt;
+   if (x <= 0.0) return 0.0;
+   if (x >= 1.0) return 1.0;
+   bt=exp(gammln(a+b)-gammln(a)-gammln(b)+a*log(x)+b*log(1.0-x));
+   if (x < (a+1.0)/(a+b+2.0))
+      return bt*betacf(a,b,x)/a;
+   else
+      return 1.0-bt*betacf(b,a,1.0-x)/b;
+}  /* end betai */
 
-/**************************************************************
-* generate_dev generates basic deviates for any distribution  *
-* The distribution type and theta_bar are input as parameters *
-* deviate is the value returned.                              *
-***************************************************************/
-double generate_dev( double theta_bar, int distribution, double q)
-{  /* begin generate_dev*/
 
-  double xi;  /* uniform random variable for deviates */
-  double theta; /* resulting deviate */
-  
 /***************************************************************************
 ****************************************************************************
 * 1  = exponential        exp(-x/mu)    ORIGINAL lam's WAY       
@@ -682,116 +851,224 @@ double generate_dev( double theta_bar, int distribution, double q)
 * 6  = poisson
       poisson deviates are all positive, and can get very large 
 * 7  = generalized visiting distribution stariolo and tsallis '96
+*      from a table (tsallis_visit), 11 by the rejection method
 * 8  = standard normal returns negative values
 * 9  =  pareto deviates are all positive, and can get very large 
        pareto(x)= {(a*b)**a}/(x**(a+1)) a=value and b=value (a=theta_bar)
 *      deviate = b / [xi **(1/a)] 
 * 10 = normal returns negative values w/mean theta_bar     
 *****************************************************************************
+* SRV 2026-10-17: each distribution has a sampler of its own below, and  
+* dev_init picks the one for the run once; generate_dev makes a deviate 
+* with it, generate_devs n deviates at a time (with RandomFill where the 
+* distribution allows it); the exponential and normal ones come from the
+* ziggurats of random.c (RandomExp, RandomNormal)                         
 *****************************************************************************/
 
+static double (*dev_one)(double theta_bar) = NULL;         /* the samplers */
+static void   (*dev_many)(double theta_bar, double *dev, int n) = NULL;
+static int    dev_distribution = 0;               /* what they are for */
+static double dev_q = 0.;
+
+
+static double exp_dev(double theta_bar)
+{  /*****exponential distribution, exp(-x/mu) (ziggurat) */ 
+   return theta_bar * RandomExp(); /* exp dist */
+}
+
+static void exp_devs(double theta_bar, double *dev, int n)
+{
+   int i;
+   RandomFillExp(dev, n);
+   for (i=0; i<n; i++)
+     dev[i] *= theta_bar;
+}
+
+static double uni_dev(double theta_bar)
+{  /* controlled uniform distribution interval =[0, theta_bar] */
+   return theta_bar * RandomReal();
+}
+
+static void uni_devs(double theta_bar, double *dev, int n)
+{
+   int i;
+   RandomFill(dev, n);
+   for (i=0; i<n; i++)
+     dev[i] *= theta_bar;
+}
+
+static double absnor_dev(double theta_bar)
+{  /* absolute values of normal dist */
+   return fabs (theta_bar * gasdev());
+}
+
+static void absnor_devs(double theta_bar, double *dev, int n)
+{
+   int i;
+   RandomFillNormal(dev, n);
+   for (i=0; i<n; i++)
+     dev[i] = fabs (theta_bar * dev[i]);
+}
+
+static double lor_dev(double theta_bar)
+{  /* lorentzian distribution:(sigma) / [(x*x)+(sigma*sigma/4)]/pi */ 
+   double xi;
+   /* tan of 0.5*pi is not good */
+   do
+     xi= RandomReal();
+   while (xi == 0.5);
+   /* king's extra /2  theta = (theta_bar/2 * tan(xi*pi) );  */
+   return theta_bar * tan(xi*pi); /* corrected 5-02 lorentz dist */
+}
+
+static void lor_devs(double theta_bar, double *dev, int n)
+{
+   int i;
+   RandomFill(dev, n);
+   for (i=0; i<n; i++) {
+     while (dev[i] == 0.5)
+       dev[i] = RandomReal();
+     dev[i] = theta_bar * tan(dev[i]*pi);
+   }
+}
+
+static double abslor_dev(double theta_bar)
+{  /* lorentz use absolute value */
+   return fabs (lor_dev(theta_bar));
+}
+
+static void abslor_devs(double theta_bar, double *dev, int n)
+{
+   int i;
+   lor_devs(theta_bar, dev, n);
+   for (i=0; i<n; i++)
+     dev[i] = fabs(dev[i]);
+}
+
+static double stdnor_dev(double theta_bar)
+{  /* just try standard normal */
+   return gasdev();
+}
+
+static void stdnor_devs(double theta_bar, double *dev, int n)
+{
+   RandomFillNormal(dev, n);
+}
+
+static double nor_dev(double theta_bar)
+{  /* normal dist returning negative values */
+   return theta_bar * gasdev();
+}
+
+static void nor_devs(double theta_bar, double *dev, int n)
+{
+   int i;
+   RandomFillNormal(dev, n);
+   for (i=0; i<n; i++)
+     dev[i] *= theta_bar;
+}
+
+static double pareto_dev(double theta_bar)
+{  /* pareto with b=1, theta_bar=a: deviate = b / [xi **(1/a)] */
+   return 1/(pow(RandomReal(),(1/theta_bar)));
+}
+
+static void pareto_devs(double theta_bar, double *dev, int n)
+{
+   int i;
+   RandomFill(dev, n);
+   for (i=0; i<n; i++)
+     dev[i] = 1/(pow(dev[i],(1/theta_bar)));
+}
+
+static void one_devs(double theta_bar, double *dev, int n)
+{  /* the distributions without a sampler of their own for n */
+   int i;
+   for (i=0; i<n; i++)
+     dev[i] = dev_one(theta_bar);
+}
 
- if (distribution == 1) 
-/*****************************************************************/
-    {  /*****exponential distribution, exp(-x/mu) */ 
-      xi= RandomReal();
-      theta = (-1) * theta_bar * log(xi); /* exp dist */
-    }   /* end exponential distribution, exp(-x/mu) */ 
-/*****************************************************************/
-/********************************************************************/
-   else if ( distribution == 2 ) 
-/*******************************************************************/
-  { /* controlled uniform distribution*/ 
-      xi= RandomReal();  /* uniform dist interval =[0, theta_bar] */
-      theta = theta_bar * xi; /* controlled uniform */
-    } /* end controlled uniform distribution  */ 
-/*****************************************************************/
-/*****************************************************************/
-    else if ( distribution == 3 ) 
-/*****************************************************************/
-   { /* normal distribution */ 
-    theta = fabs (theta_bar * gasdev()); /* absolute values of normal dist */
-    }  /*end normal distribution */
-/*****************************************************************/
-   else if ( distribution == 4 ) 
-/*****************************************************************/
-   { /* lorentzian distribution:(sigma) / [(x*x)+(sigma*sigma/4)]/pi */ 
-     /* tan of 0.5*pi is not good */
-     do
-         xi= RandomReal();
-     while (xi == 0.5);
-     /* king's extra /2  theta = fabs (theta_bar/2 * tan(xi*pi) );  */
-     theta = fabs (theta_bar * tan(xi*pi) ); /* corrected 5-02 lorentz dist */
-    }  /* end lorentzian distribution:(sigma)/[(x*x)+(sigma*sigma/4)]/pi */
-/*****************************************************************/
-   else if ( distribution == 5 ) 
-/***********************************************/
-   { /* lorentz2 distribution   */ 
-     /* tan of 0.5*pi is not good */
-     do
-        xi= RandomReal();
-     while (xi == 0.5);  /* do not want tan (0) */
-   /* true lorentzian not abs value or round robin index modulo */
-     /*  theta = (theta_bar/2 * tan(xi*pi) ); king's extra /2 */
-     theta = (theta_bar * tan(xi*pi) ); /* corrected 5-02 lorentz dist */
-
-     } /* end lorentz 2 */ 
-/********************************************************/
-/************************************************************/
-   else if (distribution == 6 ) 
-/************************************************************/
-     {  /* begin poisson ---needs work still */
-  /* poisson deviates are all positive, and can get very large */
-        theta = poidev(theta_bar);
-} /* end poisson */  
-/************************************************************/
-/*******************************************************************/
-   else if (distribution == 7 ) 
-   {   /* generalized visiting distribution */ 
-     if (q <  2.0) /* when q = 2 should use lorentz */
-       {theta = qlt2_visit(theta_bar); /* gsa q between 1 and 2 */
-       }
-     else /* less than or equal to 2.6 */
-       if (q <  2.6) /* do not use binomial */
-	 {theta = qgt2_visit(theta_bar); /* gsa q between 2 and 2.6 */}
-       else /* q = 2.6 or more, OK to use binomial */
-	 {theta = binom_qgt2_visit(theta_bar); /* gsa 2.6 <= q < 3 */ }
-   } /* end  generalized visiting distribution */ 
-
-/*******************************************************************/
- else if (distribution == 8) 
-    {   /* gasdev */ 
-      theta = gasdev(); /* just try standard normal */
-    }   /* end gasdev returns pos and neg values*/  
-/*******************************************************************/
-/*******************************************************************/
-
- else if (distribution == 9) 
-    {   /* pareto */ 
-  /* pareto deviates are all positive, and can get very large */
-  /*  pareto(x)= {(a*b)**a}/(x**(a+1))  */
-
-       xi= RandomReal(); /*uniform*/
-      theta = 1/(pow(xi,(1/theta_bar))); /* pareto with b=1, theta_bar=a */
-      /* deviate = b / [xi **(1/a)] */
-   }   /* end pareto */  
-/*******************************************************************/
-
- else if (distribution == 10) 
-    {   /* normal returning negative values  */ 
-      theta = theta_bar * gasdev(); /****  normal dist */
-    }   /* end normal returning negative values */ 
-
-   else 
-/*******************************************************************/
-      { /* unknown distribution, exit */
-        printf ("unknown distribution type=%d\n",distribution);
-        exit (1); 
-      } /* unknown distribution */
-
- return theta; 
-
-/*******************************************************************/
- }  /* end generate_dev*/
+
+/**************************************************************
+* dev_init picks the samplers of generate_dev and             *
+* generate_devs for a distribution (and q for 11); called by  *
+* InitDistribution once the q factors are set, and by         *
+* generate_dev itself when it is asked for another one        *
+***************************************************************/
+void dev_init(int distribution, double q)
+{  /* begin dev_init */
+   dev_many = one_devs;
+   switch (distribution) {
+   case 1:  dev_one = exp_dev;    dev_many = exp_devs;    break;
+   case 2:  dev_one = uni_dev;    dev_many = uni_devs;    break;
+   case 3:  dev_one = absnor_dev; dev_many = absnor_devs; break;
+   case 4:  dev_one = abslor_dev; dev_many = abslor_devs; break;
+   case 5:  dev_one = lor_dev;    dev_many = lor_devs;    break;
+   case 6:  dev_one = poidev;                             break;
+   case 7:  dev_one = tsallis_visit;         /* the table now, before */
+            if ( tsallis_levels == 0 )      /* the chains share it   */
+              tsallis_table();
+            break;
+   case 8:  dev_one = stdnor_dev; dev_many = stdnor_devs; break;
+   case 9:  dev_one = pareto_dev; dev_many = pareto_devs; break;
+   case 10: dev_one = nor_dev;    dev_many = nor_devs;    break;
+   case 11:                          /* when q = 2 should use lorentz */
+     if (q < 2.0)
+       dev_one = qlt2_visit;                  /* gsa q between 1 and 2 */
+     else if (q < 2.6)                             /* do not use binomial */
+       dev_one = qgt2_visit;                 /* gsa q between 2 and 2.6 */
+     else                             /* q = 2.6 or more, OK to use binomial */
+       dev_one = binom_qgt2_visit;                      /* gsa 2.6 <= q < 3 */
+     break;
+   default: /* unknown distribution, exit */
+     printf ("unknown distribution type=%d\n",distribution);
+     exit (1); 
+   }
+   dev_distribution = distribution;
+   dev_q = q;
+}  /* end dev_init */
+
+
+/**************************************************************
+* generate_dev generates basic deviates for any distribution  *
+* The distribution type and theta_bar are input as parameters *
+* deviate is the value returned.                              *
+***************************************************************/
+double generate_dev( double theta_bar, int distribution, double q)
+{  /* begin generate_dev*/
+  if (distribution != dev_distribution || q != dev_q)
+    dev_init(distribution, q);
+  return dev_one(theta_bar);
+}  /* end generate_dev*/
+
+
+/**************************************************************
+* dev_scale returns the factor that turns deviates made for   *
+* theta_bar 1 into ones for theta_bar, or 0 if the deviates   *
+* of the distribution do not just scale with theta_bar (SRV)  *
+***************************************************************/
+double dev_scale(double theta_bar)
+{  /* begin dev_scale */
+  switch (dev_distribution) {
+  case 1: case 2: case 3: case 4: case 5: case 10:
+    return theta_bar;
+  case 7:                        /* fact1; but trunc does not scale */
+    return (dev_q < 2.) ? exp(log(theta_bar)/(3.-dev_q)) : 0.;
+  case 8:
+    return 1.;
+  default:                                /* poisson, pareto, 11 */
+    return 0.;
+  }
+}  /* end dev_scale */
+
+
+/**************************************************************
+* generate_devs puts n deviates of the distribution dev_init  *
+* picked into dev (SRV 2026)                                  *
+***************************************************************/
+void generate_devs(double theta_bar, double *dev, int n)
+{  /* begin generate_devs */
+  dev_many(theta_bar, dev, n);
+}  /* end generate_devs */
 
 
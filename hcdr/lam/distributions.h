@@ -16,6 +16,8 @@ typedef struct my_distrib {
                          /*  1   <  q < 2   uses qlt2_visit       */
                          /*  2   <  q < 2.6 uses qgt2_visit       */
                          /*  2.6 <= q < 3   uses binom_qgt2_visit */
+                         /*  those are distribution 11; 7 uses the */
+                         /*  table of tsallis_visit for all q      */
 
   /*****variables that depend on q ********/
   double gam1;           /* gammaln of 1/(q-1)       */           
@@ -39,18 +41,31 @@ typedef struct my_distrib {
 
 /* prototype functions for distributions */
 
-double gasdev(void);  /* normal distribution */
+double gasdev(void);  /* normal distribution (RandomNormal) */
 double gammln(double xx);  /* gamma ln distribution */
 double poidev(double xm);/* poisson distribution */
+double betai(double a, double b, double x);  /* incomplete beta function */
 
 double binom_qgt2_visit(double theta_bar); /* 2.6 <= q < 3 */
 double qgt2_visit(double theta_bar);       /* 2 < q < 2.6 */
 double qlt2_visit(double theta_bar);       /* q between 1 and 2 */
+double tsallis_visit(double theta_bar);    /* 1 < q < 3 from a table */
 
 void print_qgt2_visit( double theta_bar); /* debug 1-13-03 */
 
 double generate_dev(double theta_bar, int distribution, double q);
 
+/**********************************************************
+* dev_init picks the sampler of the distribution (and q)  *
+* once, so generate_dev and generate_devs need not look   *
+* at the distribution type for every deviate; generate_   *
+* devs puts n deviates for theta_bar into dev (SRV 2026)  *
+***********************************************************/
+
+void dev_init(int distribution, double q);
+void generate_devs(double theta_bar, double *dev, int n);
+double dev_scale(double theta_bar);  /* 0 unless theta_bar just scales */
+
 /**********************************************************
 * qgt2_init initializes the factors used for the  general *
 * visiting distribution for q between 2 and 3, but are    *
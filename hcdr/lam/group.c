@@ -0,0 +1,225 @@
+/*****************************************************************
+ *                                                               *
+ *   group.c                                                     *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   written by SRV (2026-10-17)                                 *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   a team of threads that anneal as one Lam group: starting    *
+ *   them, and the few collectives the group needs (barrier,     *
+ *   allgather, broadcast), done through shared memory           *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ * Copyright (C) 1989-2003 John Reinitz                          *
+ * the full GPL copyright notice can be found in lsa.c           *
+ *                                                               *
+ *****************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <error.h>
+#include <group.h>
+
+
+/* STRUCTS *****************************************************************/
+
+/* what each member keeps to itself, on a cache line of its own: the sense *
+ * of the barrier it is at and how many collectives it has done            */
+
+typedef struct {
+  int sense;
+  unsigned int gen;
+} __attribute__((aligned(64))) Member;
+
+/* the barrier is the sense reversing kind: the last one to arrive resets  *
+ * count and flips sense, which lets the others go; it takes no locks      */
+
+struct Team {
+  int           size;
+  atomic_int    count __attribute__((aligned(64)));  /* still to arrive */
+  atomic_int    sense;                 /* flips each time all have arrived */
+  Member        *member;
+  unsigned char *slot;                    /* 2 sets of size * TEAM_SLOT */
+};
+
+
+
+/*** TEAMS *****************************************************************/
+
+Team *NewTeam(int size)
+{
+  Team *t;
+
+  if ( size < 1 || size > TEAM_MAX )
+    error("NewTeam: can't make a team of %d threads", size);
+
+  t = (Team *)aligned_alloc(64, sizeof(Team));
+  if ( !t )
+    error("NewTeam: could not allocate the team");
+  t->size   = size;
+  t->member = (Member *)aligned_alloc(64, size * sizeof(Member));
+  t->slot   = (unsigned char *)aligned_alloc(64, 2 * size * TEAM_SLOT);
+  if ( !t->member || !t->slot )
+    error("NewTeam: could not allocate the team");
+  memset(t->member, 0, size * sizeof(Member));
+  atomic_init(&t->count, size);
+  atomic_init(&t->sense, 0);
+
+  return t;
+}
+
+void FreeTeam(Team *t)
+{
+  free(t->slot);
+  free(t->member);
+  free(t);
+}
+
+
+
+/*** TeamRun: runs body(0) .. body(n-1) on n threads, body(0) on the one ***
+ *            that calls, and returns when they are all done               *
+ ***************************************************************************/
+
+typedef struct {
+  void (*body)(int thread);
+  int  thread;
+} TeamJob;
+
+static void *TeamStart(void *arg)
+{
+  TeamJob *job = (TeamJob *)arg;
+
+  job->body(job->thread);
+  return NULL;
+}
+
+void TeamRun(int n, void (*body)(int thread))
+{
+  pthread_t *tid;
+  TeamJob   *job;
+  int       i;
+
+  tid = (pthread_t *)calloc(n, sizeof(pthread_t));
+  job = (TeamJob *)calloc(n, sizeof(TeamJob));
+  if ( !tid || !job )
+    error("TeamRun: could not allocate %d threads", n);
+
+  for (i=1; i<n; i++) {
+    job[i].body   = body;
+    job[i].thread = i;
+    if ( pthread_create(&tid[i], NULL, TeamStart, &job[i]) )
+      error("TeamRun: could not start thread %d", i);
+  }
+  body(0);
+  for (i=1; i<n; i++)
+    pthread_join(tid[i], NULL);
+
+  free(job);
+  free(tid);
+}
+
+
+
+/*** COLLECTIVES ***********************************************************/
+
+/*** TeamBarrier: returns once all members of t have called it; spins for **
+ *                a while first, then yields, since there may be more      *
+ *                threads than cores                                       *
+ ***************************************************************************/
+
+void TeamBarrier(Team *t, int rank)
+{
+  int sense = !t->member[rank].sense;
+  int spins = 0;
+
+  t->member[rank].sense = sense;
+
+  if ( atomic_fetch_sub_explicit(&t->count, 1, memory_order_acq_rel) == 1 ) {
+    atomic_store_explicit(&t->count, t->size, memory_order_relaxed);
+    atomic_store_explicit(&t->sense, sense, memory_order_release);
+  } else {
+    while ( atomic_load_explicit(&t->sense, memory_order_acquire) != sense )
+      if ( ++spins > TEAM_SPIN )
+        sched_yield();
+  }
+}
+
+/* the slot of member rank in the set this member's next collective uses */
+
+static unsigned char *TeamSlot(Team *t, int me, int rank)
+{
+  return t->slot + ((t->member[me].gen & 1) * t->size + rank) * TEAM_SLOT;
+}
+
+void TeamAllgather(Team *t, int rank, const void *mine, void *all,
+                   size_t bytes)
+{
+  int i;
+
+  if ( bytes > TEAM_SLOT )
+    error("TeamAllgather: can't hand over more than %d bytes", TEAM_SLOT);
+
+  memcpy(TeamSlot(t, rank, rank), mine, bytes);
+  TeamBarrier(t, rank);
+  for (i=0; i<t->size; i++)
+    memcpy((unsigned char *)all + i*bytes, TeamSlot(t, rank, i), bytes);
+  t->member[rank].gen++;
+}
+
+void TeamBcast(Team *t, int rank, void *buf, size_t bytes, int root)
+{
+  if ( bytes > TEAM_SLOT )
+    error("TeamBcast: can't hand over more than %d bytes", TEAM_SLOT);
+
+  if ( rank == root )
+    memcpy(TeamSlot(t, rank, root), buf, bytes);
+  TeamBarrier(t, rank);
+  if ( rank != root )
+    memcpy(buf, TeamSlot(t, rank, root), bytes);
+  t->member[rank].gen++;
+}
+
+void TeamSum(Team *t, int rank, double *x, int n)
+{
+  double all[TEAM_MAX * (TEAM_SLOT / sizeof(double))];
+  int    m = TEAM_SLOT / sizeof(double);                 /* per collective */
+  int    i, j, k;
+
+  for (k=0; k<n; k+=m) {
+    if ( m > n-k )
+      m = n-k;
+    TeamAllgather(t, rank, x+k, all, m * sizeof(double));
+    for (j=0; j<m; j++) {
+      x[k+j] = 0.;
+      for (i=0; i<t->size; i++)
+        x[k+j] += all[i*m + j];
+    }
+  }
+}
+
+void TeamSumLong(Team *t, int rank, unsigned long *x, int n)
+{
+  unsigned long all[TEAM_MAX * (TEAM_SLOT / sizeof(unsigned long))];
+  int           m = TEAM_SLOT / sizeof(unsigned long);
+  int           i, j, k;
+
+  for (k=0; k<n; k+=m) {
+    if ( m > n-k )
+      m = n-k;
+    TeamAllgather(t, rank, x+k, all, m * sizeof(unsigned long));
+    for (j=0; j<m; j++) {
+      x[k+j] = 0;
+      for (i=0; i<t->size; i++)
+        x[k+j] += all[i*m + j];
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/*****************************************************************
+ *                                                               *
+ *   group.h                                                     *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   written by SRV (2026-10-17)                                 *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   a team of threads that anneal as one Lam group: starting    *
+ *   them, and the few collectives the group needs (barrier,     *
+ *   allgather, broadcast), done through shared memory           *
+ *                                                               *
+ *****************************************************************/
+
+#ifndef GROUP_INCLUDED
+#define GROUP_INCLUDED
+
+#include <stddef.h>
+
+/*** CONSTANTS *************************************************************/
+
+/* a collective hands each member's bytes over in a slot of TEAM_SLOT; the *
+ * slots come in two sets which consecutive collectives take turns with,   *
+ * so that one barrier per collective is enough: nobody can be writing a   *
+ * set again before everybody has passed the barrier of the collective in  *
+ * between, i.e. is done reading it                                        */
+
+#define TEAM_MAX       256                  /* max number of threads/team */
+#define TEAM_SLOT       64               /* bytes per member and collective */
+#define TEAM_SPIN     1024         /* spins at a barrier before we yield */
+
+/*** STRUCTS ***************************************************************/
+
+typedef struct Team Team;
+
+/*** FUNCTION PROTOTYPES ***************************************************/
+
+/*** NewTeam: makes a team of size members (ranks 0 .. size-1); FreeTeam ***
+ *            gets rid of it again                                         *
+ ***************************************************************************/
+
+Team *NewTeam(int size);
+
+void FreeTeam(Team *t);
+
+/*** TeamRun: runs body(0) .. body(n-1) on n threads, body(0) on the one ***
+ *            that calls (which is the one MPI knows about), and returns   *
+ *            when they are all done                                       *
+ ***************************************************************************/
+
+void TeamRun(int n, void (*body)(int thread));
+
+/*** TeamBarrier: returns once all members of t have called it *************
+ ***************************************************************************/
+
+void TeamBarrier(Team *t, int rank);
+
+/*** TeamAllgather: the bytes (at most TEAM_SLOT) of every member end up ***
+ *                  in all, in rank order, for all members                 *
+ ***************************************************************************/
+
+void TeamAllgather(Team *t, int rank, const void *mine, void *all,
+                   size_t bytes);
+
+/*** TeamBcast: the bytes (at most TEAM_SLOT) of member root end up in ****
+ *              buf for all members                                        *
+ ***************************************************************************/
+
+void TeamBcast(Team *t, int rank, void *buf, size_t bytes, int root);
+
+/*** TeamSum, TeamSumLong: sum n numbers over the team, in rank order so ***
+ *                         that every member gets the same sum             *
+ ***************************************************************************/
+
+void TeamSum(Team *t, int rank, double *x, int n);
+
+void TeamSumLong(Team *t, int rank, unsigned long *x, int n);
+
+#endif
@@ -69,6 +69,7 @@
 #include <error.h>
 #include <random.h>
 #include <mix.h>
+#include <group.h>
 
 #include <MPI.h>
 #include <mpi.h>
@@ -91,47 +92,23 @@ static char   *lbfile;               /* name of .lb file (for lower_bound) */
 static char   *ubfile;               /* name of .ub file (for upper_bound) */
 static char   *mbfile;                 /* name of .mb file (for mix_bound) */
 
-/* some energy-related variables *******************************************/
-
-static double energy;                                    /* current energy */
-
-static double S;                                 /* current inverse energy */
-static double dS;                      /* delta S: change in S during move */
-static double S_0;                      /* the initial inverse temperature */
-
-static double exp_arg; /* the exponent of the Metropolis criterion (-dE/T) */
-
-/* Lam stats stuff: estimators, stats and acceptance ratios ****************/
-
-static double mean;          /* mean energy, collected from tau last steps */
-static double vari;      /* energy variance, collected from tau last steps */
-
-static double estimate_mean;              /* Lam estimator for mean energy */
-static double estimate_sd;  /* Lam estimator for energy standard deviation */
-
-static uint8_t    success=0;                 /* number of successful moves */
-#ifdef MPI
-static int    l_success;               /* local number of successful moves */
-#endif
-
-static double alpha;         /* the third term of the Lam schedule formula */
-static double acc_ratio;    /* average acceptance ratio for all parameters */
-
-static unsigned int g_mixes=0;
-#ifdef MPI
-/* parallel code: variables for local Lam stats for tuning */
-
-/* local weights: there are two sets of local estimators for the mean ******
- * energy, since we require a local Lam estimator of the mean energy with  *
- * a small weight for the calculation of cross-correlation of processors   *
- * (for estimating the lower bound of M), whereas we need a local Lam esti-*
- * mator for the mean energy with a large weight for the calculation of    *
- * the variance of local means; these two different weights for local Lam  *
- * stats have been determined experimentally by King-Wai Chu (although     *
- * it's not mentioned in his thesis); it works for all practical purposes, *
- * but in the future, a better way of sampling local statistics will be    *
- * needed (probably as part of a general theory of parallel Lam simulated  *
- * annealing)                                                              *
+/* the state of an annealing chain: energy, S, Lam stats and such *********/
+/* SRV 2026-10-17: these used to be static variables in here; they now    */
+/* live in the Annealer (see sa.h) that gets passed to Loop and all the    */
+/* functions it calls, so that there can be more than one chain; what is   */
+/* still static below is the same for all chains                           */
+
+/* local weights (parallel code): there are two sets of local estimators  **
+ * for the mean energy in the Annealer (l_*), since we require a local Lam *
+ * estimator of the mean energy with a small weight for the calculation of *
+ * cross-correlation of processors (for estimating the lower bound of M),  *
+ * whereas we need a local Lam estimator for the mean energy with a large  *
+ * weight for the calculation of the variance of local means; these two    *
+ * different weights for local Lam stats have been determined experimen-   *
+ * tally by King-Wai Chu (although it's not mentioned in his thesis); it   *
+ * works for all practical purposes, but in the future, a better way of    *
+ * sampling local statistics will be needed (probably as part of a general *
+ * theory of parallel Lam simulated annealing)                             *
  *                                                                         *
  * variables for estimators for the lower bound of M end with _l           *
  * variables for estimators for the upper bound of M end with _u           *
@@ -144,128 +121,21 @@ static unsigned int g_mixes=0;
  * only thing we do with the local sd estimators is writing them to local  * 
  * .llog files (only the upper bound estimators get written there)         */
 
-static double l_mean;       /* local mean energy, from proc_tau last steps */
-static double l_vari;   /* local energy variance, from proc_tau last steps */
-                             
-static double l_estimate_mean_l;     /* estimator for mean for lower bound */
-static double l_estimate_mean_u;     /* estimator for mean for upper bound */
-static double l_estimate_sd;       /* Lam estimator for sd for upper bound */
-
-static double l_alpha;       /* the third term of the Lam schedule formula */
-static double l_acc_ratio;  /* average acceptance ratio for all parameters */
-/* For Faster Mean and Variance computations */
-
-#endif
-/* Lam stats stuff: variables for calculating the estimators  **************/
-
-/* mean estimator */
-
-static double w_a;                       /* w_a is the weight for the mean */
-
-static double usyy;         /* these parameters store intermediate results */
-static double usxy;               /* for the updating formulas for A and B */
-static double usxx;                       /* see Lam & Delosme, 1988b, p10 */
-static double usx;
-static double usy;
-static double usum;
-
-static double A;            /* A and B are the parameters for the rational */
-static double B;                /* function for the estimation of the mean */
-
-#ifdef MPI
-
-/* parallel code: variables for calculating local mean estimator for lower *
- *                bound of M (see also comment on local weights above)     */
-
-static double l_w_a_l; /* l_w_a_l: weight for the mean for the lower bound */
-
-static double l_usyy_l;     /* these parameters store intermediate results */
-static double l_usxy_l;   /* for the updating formulas for l_A_l and l_B_l */
-static double l_usxx_l;            
-static double l_usx_l;
-static double l_usy_l;
-static double l_usum_l;
-
-static double l_A_l;  /* l_A_l and l_B_l: parameters for the rational func */
-static double l_B_l; /* for the estimation of the mean for the lower bound */
-
-/* parallel code: variables for calculating local mean estimator for upper *
- *                bound of M (see also comment on local weights above)     */
-
-static double l_w_a_u; /* l_w_a_u: weight for the mean for the upper bound */
-
-static double l_usyy_u;     /* these parameters store intermediate results */
-static double l_usxy_u;   /* for the updating formulas for l_A_u and l_B_u */
-static double l_usxx_u;                
-static double l_usx_u;
-static double l_usy_u;
-static double l_usum_u;
-
-static double l_A_u;        /* A and B are the parameters for the rational */
-static double l_B_u;            /* function for the estimation of the mean */
-
-#endif
-
-/* sd estimator */
-
-static double w_b;         /* w_b is the weight for the standard deviation */
-
-static double vsyy;         /* these parameters store intermediate results */
-static double vsxy;               /* for the updating formulas for D and E */
-static double vsxx;                       /* see Lam & Delosme, 1988b, p10 */
-static double vsx;
-static double vsy;
-static double vsum;
-
-static double D;            /* D and E are the parameters for the rational */
-static double E;  /* function for the estimation of the standard deviation */
-
-#ifdef MPI
-
-/* parallel code: variables for local sd estimator (see also comment on    *
- *                local weights above)                                     */
-
-static double l_w_b;                         /* l_w_b: local weight for sd */
-
-static double l_vsyy;       /* these parameters store intermediate results */
-static double l_vsxy;         /* for the updating formulas for l_D and l_E */
-static double l_vsxx;              
-static double l_vsx;
-static double l_vsy;
-static double l_vsum;
-
-static double l_D;    /* l_D_l and l_E_l: parameters for the rational func */
-static double l_E;     /* for the estimation of the sd for the lower bound */
-
-#endif
+static unsigned int g_mixes=0;
 
 /* Lam stats stuff: variables related to tau *******************************/
 
 static double Tau;     /* double version of tau to calculate mean and vari */
 static int    proc_tau;  /* proc_tau = tau                     in serial   */
                          /* proc_tau = tau / (# of processors) in parallel */
-static long   count_tau;  /* how many times we did tau (or proc_tau) moves */
 
 /* the actual number of moves for collecting initial statistics ************/
 
 static int    proc_init;                        /* number of initial moves */
 
-#ifdef MPI
-/* an array needed for mixing in parallel code *****************************/
-
-static int    *dance_partner;       /* stores dance partners for each node */
-#endif
-
-/* stuff used by Frozen ****************************************************/
-
-static double old_mean;                    /* old mean as stored by Frozen */
-static int    counter;                           /* counter used by Frozen */
+/* restarting from a state file: no initial moves then *********************/
 
-/* skip tells the annealer how often it should update S ********************
- * implemented by Lam for increasing performance, i.e. currently we only   *
- * update the temperature every 10 moves (possibly obsolete now)           */
-
-static int    skip = -1;
+static int    restart = 0;
 
 /* flag used by Landscape generation ****************************************/
 /*      Set by InitLandscape called from xxx_sa.c****************************/
@@ -277,13 +147,7 @@ static int    landscape = 0;
 
 static ChuParam equil_param;             /* equilibration parameter struct */
 
-static double fix_T_avg   = 0.0;   /* overall energy average at fixed temp */
-static double fix_T_var   = 0.0;   /* energy variance at fixed temperature */
-  
 #ifdef MPI
-static double pfix_T_avg  = 0.0;    /* global energy average at fixed temp */
-static double pfix_T_var  = 0.0;   /* global energy variance at fixed temp */
-
 /* vars used for tuning runs ***********************************************/
 
 /* general variables that determine tune- and sub_tune_interval */
@@ -293,31 +157,8 @@ static int    sample_size;                /* so many samples per processor */
 static int    tune_interval;  /* total # of moves to be sampled for tuning */
 static int    sub_tune_interval;     /* at end of this we write tune stats */
 
-/* various counter variables and an array to save counts */
-
-static int    count_sample = 0;        /* how many samples did we collect? */
-static int    count_tune   = 0;      /* how many times did we do sub_tune? */
-static int    count_mix    = 0;      /* counts the times we've been mixing */
-
-static int    moves_tune = 0;   /* move counter: reset every tune_interval */
-
 static int    *tau_count; /* # of tau's we've done for whole tune_interval */
 
-/* arrays for sampling stats for the lower bound */
-
-static double *dev;         /* standard deviations for a sub_tune_interval */
-static double *tot_dev;           /* gathers all local standard deviations */
-static double *coll_dev;             /* collects local standard deviations */
-static double *cross_correl;         /* cross-correlations for lower bound */
-
-/* arrays for sampling stats for the upper bound */
- 
-static double *means;          /* used to save local means for upper bound */
-static double *tot_means;                       /* gathers all local means */
-static double *coll_means;                         /* collects local means */
-static double *var_means;       /* variance of local means for lower bound */
-static int    *midpoints;           /* midpoints of groups for upper bound */
-
 /* a variable for the tuning stop criterion */
 
 static int    stop_tune_count = STOP_TUNE_CNT;          /* stop tune count */
@@ -333,34 +174,150 @@ static double      finish;                     /* wallclock time after run */
 static struct tms *cpu_start;                      /* user time before run */
 static struct tms *cpu_finish;                      /* user time after run */
 
-static uint16_t *m_success;  /* Move Success needed in move.h */
 #ifdef MPI
 /* Parallel Globals only needed in lsa.c */
-int my_group_id;
-int local_frozen = 0; /* As all groups do not communicate, each processor must 
-                      communicate that they are frozen */
-int tot_frozen=0;       /* this will check if all groups are frozen*/
-
 char machine[MPI_MAX_PROCESSOR_NAME];                  /* For machine name */
 
 MPI_Datatype MPI_Meanvarisucc;
 MPI_Op MPI_Meanvarisucc_sum;
 
+/* hybrid mode (SRV 2026-10-17): each rank runs nthreads chains (its      *
+ * team), which are its Lam group; chain 0 is the one main() starts with   *
+ * and the only one that talks MPI; nchains is the number of chains in the *
+ * run, which is what nnodes used to be (as far as the schedule is con-    *
+ * cerned); a run of one process (tsp_sa.threads) may split its team into  *
+ * thread_groups groups, whose first chains (the roots) do the global mix  */
+
+static int      nchains;
+static Team     *team = NULL;
+static Annealer *chain0;
+static int      thread_groups = 1;
+static Team     **groups;
+static Team     *roots = NULL;
+
+#endif
+
+/* STATIC FUNCTION PROTOTYPES **********************************************/
+
+static void Anneal(Annealer *an);
+#ifdef MPI
+static void AnnealChain(int thread);
+static void InitTeam(Annealer *an);
+static void DoTeamLocalMix(Annealer *an);
+static void DoTeamGlobalMix(Annealer *an);
+static void DoThreadGlobalMix(Annealer *an);
 #endif
 
+/* METROPOLIS KERNEL *******************************************************/
+/* SRV 2026-10-17: exp(-S*dE) > u is tested as -log(u) > S*dE, so no exp() */
+/* is needed per move; the -log(u) are drawn METRO_BLOCK at a time with a  */
+/* log the compiler can vectorize, and get scaled by the S of the moment   */
+/* only in the comparison, so UpdateS changing S every step costs nothing; */
+/* the draws still in the block are not part of the generator state that  */
+/* is saved in .state files, a restarted run continues with fresh ones;    */
+/* GenerateMove may ask for the threshold of its move up front (Move-      */
+/* Threshold), to stop weighing a move as soon as it cannot pass; S =      */
+/* DBL_MAX (quenchit) accepts downhill moves only                          */
+
+/*** MetropolisFill: draws METRO_BLOCK new thresholds -log(u) into metro_e *
+ *                   log(u) = ex*log(2) + log(x), with u = x*2^ex and x in *
+ *                   [sqrt(1/2), sqrt(2)); log(x) = 2*atanh(s), s = (x-1)/ *
+ *                   (x+1), |s| < 0.172, whose series to s^17 is good to   *
+ *                   about 1e-15; x and ex come from the bits instead of   *
+ *                   frexp() so that the second loop has no calls          *
+ ***************************************************************************/
+
+static void MetropolisFill(Annealer *an)
+{
+  int      k;
+  uint64_t ix;                                          /* the bits of u */
+  uint64_t w;                  /* bits of u shifted to put x in range */
+  double   u, x, ex;
+  double   s, z, p;                   /* for the series of log(x) (see above) */
+
+/* u == 0 (rare, but it can happen) becomes DBL_MIN, whose -log(u) is     *
+ * beyond -MIN_DELTA and thus accepts any move, like exp(MIN_DELTA) > 0    */
+
+  RandomFill(an->metro_e, METRO_BLOCK);
+
+  for (k=0; k<METRO_BLOCK; k++) {
+    u = ( an->metro_e[k] > 0. ) ? an->metro_e[k] : DBL_MIN;
+    memcpy(&ix, &u, sizeof(ix));
+    w  = ix + (0x3ff0000000000000ULL - 0x3fe6a09e667f3bcdULL);
+    ix = ix - (w & 0xfff0000000000000ULL) + 0x3ff0000000000000ULL;
+    memcpy(&x, &ix, sizeof(x));
+    ix = 0x4330000000000000ULL | (w >> 52);        /* 2^52 + biased ex */
+    memcpy(&ex, &ix, sizeof(ex));
+    ex = ex - 4503599627370496. - 1023.;
+
+    s = (x - 1.) / (x + 1.);
+    z = s * s;
+    p = 1./17.;
+    p = p*z + 1./15.;
+    p = p*z + 1./13.;
+    p = p*z + 1./11.;
+    p = p*z + 1./9.;
+    p = p*z + 1./7.;
+    p = p*z + 1./5.;
+    p = p*z + 1./3.;
+    p = p*z + 1.;
+
+    an->metro_e[k] = -(ex * 0.69314718055994530942 + 2. * s * p);    /* log(2) */
+  }
+
+  an->metro_next = 0;
+}
+
+
+
+/*** Metropolis: the Metropolis criterion at inverse temperature *metro_S; *
+ *               returns 1 if a move with energy change energy_change is   *
+ *               to be accepted, 0 if not (always for FORBIDDEN_MOVE);     *
+ *               MIN_DELTA provides a min. probability with which any move *
+ *               is accepted; draws a threshold for uphill moves only      *
+ ***************************************************************************/
+
+static int Metropolis(Annealer *an, double energy_change)
+{
+  double x;                               /* S*dE, capped by -MIN_DELTA */
+
+  if ( energy_change == FORBIDDEN_MOVE )
+    return 0;
+  if ( energy_change <= 0.0 )
+    return 1;
+  if ( *an->metro_S == DBL_MAX )
+    return 0;
+
+  if ( an->metro_next == METRO_BLOCK )
+    MetropolisFill(an);
+
+  x = *an->metro_S * energy_change;
+  if ( x > -MIN_DELTA )
+    x = -MIN_DELTA;
+
+  return ( an->metro_e[an->metro_next++] > x );
+}
+
+
+
 /* MAIN HERE ***************************************************************/
 /* This should be pretty self-explanatory.                                 */
 
 int main(int argc, char **argv )
 {
   double *delta;                            /* used to store elapsed times */
-
+  Annealer *an;                                     /* the annealing chain */
 #ifdef MPI
-/* MPI initialization steps */
+  int    provided;              /* thread support we got (checked in InitTeam) */
+  int    i;
+
+/* MPI initialization steps; in hybrid mode, only the main thread calls MPI */
 
-  MPI_Init(&argc, &argv);     /* initializes the MPI execution environment */
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
   MPI_Comm_size(MPI_COMM_WORLD, &nnodes);         /* number of processors? */
   MPI_Comm_rank(MPI_COMM_WORLD, &myid);          /* ID of local processor? */
+  nthreads = 1;                               /* InitialMove may change it */
+  nchains  = nnodes;
 #endif
   Meanvarisucc_MPI_Init();
 /* code for timing: wallclock and user times */
@@ -379,19 +336,18 @@ int main(int argc, char **argv )
 /* initialize cost function and move state, do initial moves (or restore   */
 /* annealing state if restart                                              */
 
-  Initialize( argc, argv ); 
+  an = NewAnnealer();
+  Initialize(an, argc, argv); 
 
-/* the following is for non-equlibration runs and equilibration runs that  */
-/* have not yet settled to their equilibrium temperature                   */
-
-
-  if ( (bench != 1) && ((equil != 1) || (1.0/S > equil_param.end_T)) )
-    Loop();
-
-/* there's an alternative Loop for equlibration runs at stable temperature */
+/* anneal: one chain, or one per thread in hybrid mode */
 
-  if ( equil == 1 )
-    FixTLoop();
+#ifdef MPI
+  if ( nthreads > 1 ) {
+    chain0 = an;
+    TeamRun(nthreads, AnnealChain);
+  } else
+#endif
+    Anneal(an);
 
 /* code for timing */
 
@@ -409,9 +365,19 @@ int main(int argc, char **argv )
 #ifdef MPI
   free(root_ids);
   MPI_Group_free(my_group);
-  MPI_Comm_free(my_comm);
+  MPI_Comm_free(an->my_comm);
   Meanvarisucc_MPI_Free();
-  free(m_success);
+  if ( team ) {
+    for (i=0; i<thread_groups; i++)
+      FreeTeam(groups[i]);
+    free(groups);
+    if ( roots )
+      FreeTeam(roots);
+    FreeTeam(team);
+  }
+#endif
+  FreeAnnealer(an);
+#ifdef MPI
 
   MPI_Finalize();                  /* terminates MPI execution environment */
 #endif
@@ -422,6 +388,61 @@ int main(int argc, char **argv )
 
 
 
+/*** Anneal: runs a chain from after the initial moves (which it does un- **
+ *           less we restart) to the end of the run                        *
+ ***************************************************************************/
+
+static void Anneal(Annealer *an)
+{
+  if ( !restart )
+    InitialLoop(an);
+
+/* the following is for non-equlibration runs and equilibration runs that  */
+/* have not yet settled to their equilibrium temperature                   */
+
+  if ( (bench != 1) && ((equil != 1) || (1.0/an->S > equil_param.end_T)) )
+    Loop(an);
+
+/* there's an alternative Loop for equlibration runs at stable temperature */
+
+  if ( equil == 1 )
+    FixTLoop(an);
+}
+
+#ifdef MPI
+/*** AnnealChain: what each thread does in hybrid mode; thread 0 anneals ***
+ *                the chain that main() has set up, the others set up one  *
+ *                of their own, from the same problem, at the same S_0     *
+ ***************************************************************************/
+
+static void AnnealChain(int thread)
+{
+  Annealer *an;
+
+  if ( thread == 0 )
+    an = chain0;
+  else {
+    an = NewAnnealer();
+    an->S_0           = chain0->S_0;
+    an->my_comm       = chain0->my_comm;
+    an->dance_partner = (int *)calloc(nnodes > nthreads ? nnodes : nthreads,
+                                       sizeof(int));
+    InitialChain(an, thread);
+  }
+  an->thread      = thread;
+  an->my_group_id = thread % lam_group_size;
+  an->team        = team;
+  an->group       = groups[thread / lam_group_size];
+
+  Anneal(an);
+
+  if ( thread != 0 )
+    FreeAnnealer(an);
+}
+#endif
+
+
+
 
 
 
@@ -432,7 +453,7 @@ int main(int argc, char **argv )
  *               of the annealer as saved in the state file.               *
  ***************************************************************************/
 
-void Initialize(int argc, char **argv)
+void Initialize(Annealer *an, int argc, char **argv)
 {
   int    opt_index;         /* pointer to current argument of command line */
   int    stateflag = 0;                              /* state file or not? */
@@ -450,7 +471,7 @@ void Initialize(int argc, char **argv)
 /* allocate memory for static Lam parameters and dance partners */
   state = (NucStateType *)malloc(sizeof(NucStateType));
 #ifdef MPI
-  dance_partner = (int *)calloc(nnodes, sizeof(int)); 
+  an->dance_partner = (int *)calloc(nnodes, sizeof(int)); 
 #endif
                         
 /* parse the command line and return index to input file name; then we     *
@@ -502,12 +523,17 @@ void Initialize(int argc, char **argv)
 /* Seb, 12/12/2023, fixed a bug where else was missing { causing the */
 /* program to attempt to restore state even if stateflag = 0. */
   if ( !stateflag ) {
-    initial_temp = InitialMove(argc, argv, opt_index, state, &energy );
+    initial_temp = InitialMove(argc, argv, opt_index, state, an);
    
-    S_0 = 1./initial_temp;
+    an->S_0 = 1./initial_temp;
   } else{
-    RestoreState(statefile, state, &energy);
+    RestoreState(statefile, state, an);
   }
+  restart = stateflag;
+#ifdef MPI
+  if ( nthreads > 1 )
+    InitTeam(an);
+#endif
 /* initialize those static file names that depend on the output file name */
 
   InitFilenames();
@@ -531,14 +557,9 @@ void Initialize(int argc, char **argv)
   Tau = (double)state->tune.tau;                  /* double version to tau */
                                              /* for calculating estimators */
 
-/* if we're not restarting: do the initial moves for randomizing and ga-   *
- * thering initial statistics                                              */
-  m_success=malloc(sizeof(*m_success));
-  *m_success=0;
-  if ( !stateflag ){
-    InitialLoop();
-                    
-  }    
+/* if we're not restarting, Anneal() starts with the initial moves for    *
+ * randomizing and gathering initial statistics                            */
+
 /* write first .log entry and write first statefile right after init; note *
  * that equilibration runs are short and therefore don't need state files  *
  * which would be rather complicated because of all the stats collected    * 
@@ -565,6 +586,83 @@ void Initialize(int argc, char **argv)
 
 
 
+#ifdef MPI
+/*** InitTeam: sets up hybrid mode: the threads of a rank are its Lam ******
+ *             group, so each rank needs to be a group of its own; or, in  *
+ *             a run of one process, its threads make up all the groups;   *
+ *             tuning and equilibration runs compare ranks and stay MPI    *
+ *             only                                                        *
+ ***************************************************************************/
+
+static void InitTeam(Annealer *an)
+{
+  int provided;
+  int i;
+
+  MPI_Query_thread(&provided);
+  if ( provided < MPI_THREAD_FUNNELED )
+    error("fly_sa: this MPI can't run %d threads per process", nthreads);
+  if ( nthreads > TEAM_MAX )
+    error("fly_sa: can't run more than %d threads per process", TEAM_MAX);
+  if ( ngroups == nnodes )
+    thread_groups = 1;
+  else if ( nnodes == 1 && ngroups <= nthreads && nthreads % ngroups == 0 )
+    thread_groups = ngroups;
+  else
+    error("fly_sa: with threads, ngroups must be the number of processes (%d)",
+          nnodes);
+  if ( tuning || equil || landscape )
+    error("fly_sa: tuning, equilibration and landscape runs need one thread");
+  if ( logging_mix && thread_groups > 1 )
+    error("fly_sa: can't log the mixes of groups of threads");
+
+  lam_group_size = nthreads / thread_groups;   /* groups are made of chains */
+  nchains        = nnodes * nthreads;
+  team           = NewTeam(nthreads);
+  groups         = (Team **)calloc(thread_groups, sizeof(Team *));
+  for (i=0; i<thread_groups; i++)
+    groups[i] = NewTeam(lam_group_size);
+  if ( thread_groups > 1 )
+    roots = NewTeam(thread_groups);
+
+  free(an->dance_partner);
+  an->dance_partner = (int *)calloc(nnodes > nthreads ? nnodes : nthreads,
+                                    sizeof(int));
+}
+#endif
+
+
+
+/*** NewAnnealer: allocates a chain (aligned, all zero) and sets up what ***
+ *                does not depend on the run; FreeAnnealer frees it again  *
+ ***************************************************************************/
+
+Annealer *NewAnnealer(void)
+{
+  Annealer *an;
+
+  an = (Annealer *)aligned_alloc(ANNEALER_ALIGN, sizeof(Annealer));
+  if ( !an )
+    error("NewAnnealer: could not allocate the annealer");
+  memset(an, 0, sizeof(Annealer));
+
+  an->metro_S    = &an->S;
+  an->metro_next = METRO_BLOCK;       /* no -log(u) drawn yet: fill first */
+  an->skip       = -1;
+
+  return an;
+}
+
+void FreeAnnealer(Annealer *an)
+{
+#ifdef MPI
+  free(an->dance_partner);
+#endif
+  free(an);
+}
+
+
+
 /*** InitFilenames: initializes static file names that depend on the out- **
  *                  put file name (i.e. this *must* be called after we     *
  *                  have called RestoreState())                            *
@@ -650,7 +748,7 @@ void InitFilenames(void)
 /*** AssignGroups: Assigns each processor to a group based on what machine *
  *                 its on                                                  *
  ***************************************************************************/
-void AssignGroups(){
+void AssignGroups(Annealer *an){
   int name_len, i;
   int *ids;
   char *machines;
@@ -670,6 +768,13 @@ void AssignGroups(){
   int max_size = 0;
 
   MPI_Group world;
+
+/* a single process whose threads make up the groups (see InitTeam) is a   *
+ * single group as far as MPI is concerned                                 */
+  int groups_asked = ngroups;
+  if ( nnodes == 1 && nthreads > 1 )
+    ngroups = 1;
+
   local_comms =(MPI_Comm*)malloc(ngroups*sizeof(MPI_Comm));
   local_groups=(MPI_Group*)malloc(ngroups*sizeof(MPI_Group));
 
@@ -774,9 +879,9 @@ void AssignGroups(){
     MPI_Group_incl(world, lam_group_size, local_ranks, &local_groups[i]);
     MPI_Comm_create_group(MPI_COMM_WORLD, local_groups[i], i, &local_comms[i]);
     if (MPI_COMM_NULL != local_comms[i]) {
-      my_comm  = &local_comms[i];
+      an->my_comm  = &local_comms[i];
       my_group = &local_groups[i];
-      MPI_Comm_rank(local_comms[i], &my_group_id);
+      MPI_Comm_rank(local_comms[i], &an->my_group_id);
       }
   }
   copy_dyn_int_array_to_const_int_array(root_ranks, root_ids, ngroups);
@@ -803,6 +908,60 @@ void AssignGroups(){
   }
   free(machines_set);
 
+  ngroups = groups_asked;
+}
+#endif
+
+
+
+#ifdef MPI
+/*** PoolSuccess, PoolStats, TeamSumInt: sum over the Lam group of a *****
+ *                                      chain: its MPI group, or in hybrid *
+ *                                      mode its team of threads (summed   *
+ *                                      in thread order, so that all       *
+ *                                      chains get the same sums); Team-   *
+ *                                      SumInt sums over team t, of which  *
+ *                                      the chain is member 'rank'         *
+ ***************************************************************************/
+
+static int TeamSumInt(Team *t, int rank, int size, int x)
+{
+  int all[TEAM_MAX];
+  int i;
+
+  TeamAllgather(t, rank, &x, all, sizeof(int));
+  for (x=0, i=0; i<size; i++)
+    x += all[i];
+  return x;
+}
+
+static void PoolSuccess(Annealer *an)
+{
+  if ( nthreads > 1 )
+    an->m_success = (uint16_t)TeamSumInt(an->group, an->my_group_id,
+                                         lam_group_size, an->m_success);
+  else
+    MPI_Allreduce(MPI_IN_PLACE,&an->m_success,1,MPI_UINT16_T, MPI_SUM, *an->my_comm);
+}
+
+static void PoolStats(Annealer *an, mean_vari_succ *mvs)
+{
+  mean_vari_succ all[TEAM_MAX];
+  int            i;
+
+  if ( nthreads > 1 ) {
+    TeamAllgather(an->group, an->my_group_id, mvs, all, sizeof(mean_vari_succ));
+    mvs->mean    = 0.;
+    mvs->vari    = 0.;
+    mvs->success = 0;
+    for (i=0; i<lam_group_size; i++) {
+      mvs->mean    += all[i].mean;
+      mvs->vari    += all[i].vari;
+      mvs->success += all[i].success;
+    }
+  } else
+    MPI_Allreduce(MPI_IN_PLACE, mvs, 1, MPI_Meanvarisucc, MPI_Meanvarisucc_sum, 
+		  *an->my_comm);
 }
 #endif
 
@@ -813,7 +972,7 @@ void AssignGroups(){
  *                   2. loop for initial collection of statistics          *
  ***************************************************************************/
 
-void InitialLoop(void)
+void InitialLoop(Annealer *an)
 {
   int         i;                                     /* local loop counter */
 
@@ -823,82 +982,60 @@ void InitialLoop(void)
   /* will hold mean, vari, and succ when pooling stats */
   mean_vari_succ mvs;
   
-
+  an->metro_S = &an->S_0;             /* the initial moves are all made at S_0 */
 
 /* randomize initial state; throw out results; DO NOT PARALLELIZE! */
   for (i=0; i<state->tune.initial_moves; i++) {
 	/* make a move: will either return the energy change or FORBIDDEN_MOVE */
-    energy_change = GenerateMove();
-/* Metropolis stuff here; we usually want FORBIDDEN_MOVE to be very large  *
- * that's why we want to prevent overflows here (hence the 'if')           */
+    energy_change = GenerateMove(an);
 
-    if ( energy_change != FORBIDDEN_MOVE )
-      exp_arg = -S_0 * energy_change;  
-
-    /* MIN_DELTA provides a min. probability with which any move is accepted */
-
-    if ( exp_arg <= MIN_DELTA )
-      exp_arg = MIN_DELTA;  
-      
     /* below, we apply the Metropolis criterion to accept or reject a move */
 
-    if ( energy_change == FORBIDDEN_MOVE )
-      RejectMove();
-    else if ( (energy_change <= 0.0) || (exp(exp_arg) > RandomReal()) ) {
-      energy += energy_change;
-      AcceptMove();
-      (*m_success)++;
+    if ( Metropolis(an, energy_change) ) {
+      an->energy += energy_change;
+      AcceptMove(an);
+      an->m_success++;
     } else
-      RejectMove();
+      RejectMove(an);
 #ifdef MPI
     if (i % proc_tau == proc_tau-1){
-      MPI_Allreduce(MPI_IN_PLACE,m_success,1,MPI_UINT16_T, MPI_SUM, *my_comm);
-      UpdateControl(m_success);
+      PoolSuccess(an);
+      UpdateControl(an, &an->m_success);
     }
 #endif
   }   /* end randomize initial state */
   
 /* set all stats to zero, collection starts below */
 
-  mean      = 0.0;
-  vari      = 0.0;
+  an->mean      = 0.0;
+  an->vari      = 0.0;
   success_initial   = 0;
 
 /* loop to collect initial statistics; this one is parallelized */
   for ( i=0; i<proc_init; i++ ) {
   /* make a move: will either return the energy change or FORBIDDEN_MOVE */
-    energy_change = GenerateMove();
-
-/* Metropolis stuff here; we usually want FORBIDDEN_MOVE to be very large  *
- * that's why we want to prevent overflows here (hence the 'if')           */
-    if ( energy_change != FORBIDDEN_MOVE )
-      exp_arg = -S_0 * energy_change; 
-
-    /* MIN_DELTA provides a min. probability with which any move is accepted */
-
-    if( exp_arg <= MIN_DELTA )
-      exp_arg = MIN_DELTA;
+    energy_change = GenerateMove(an);
 
     /* below, we apply the Metropolis criterion to accept or reject a move */
 
-    if ( energy_change == FORBIDDEN_MOVE )  
-      RejectMove();
-    else if ( (energy_change <= 0.0) || (exp(exp_arg) > RandomReal()) ) {
-      energy += energy_change;
-      AcceptMove();
-      (*m_success)++;
+    if ( Metropolis(an, energy_change) ) {
+      an->energy += energy_change;
+      AcceptMove(an);
+      an->m_success++;
       success_initial++;
     } else
-      RejectMove();
+      RejectMove(an);
 
 /* collect stats */
 
-    mean += energy;        
-    vari += energy * energy;
+    an->mean += an->energy;        
+    an->vari += an->energy * an->energy;
+#ifdef MPI
     if (i % proc_tau == proc_tau-1){
-      MPI_Allreduce(MPI_IN_PLACE,m_success,1,MPI_UINT16_T, MPI_SUM, *my_comm);
-      UpdateControl(m_success);
+      PoolSuccess(an);
+      UpdateControl(an, &an->m_success);
     }
+#endif
   }
 /************************************************************************
  * Yes these MPI_Allreduces are annoying but we have to do it this      *
@@ -916,19 +1053,26 @@ void InitialLoop(void)
  ************************************************************************/
     
 /* global stats are calculated here */
-  mvs.mean=mean;
-  mvs.vari=vari;
-  MPI_Allreduce(MPI_IN_PLACE, &mvs, 1, MPI_Meanvarisucc, MPI_Meanvarisucc_sum, 
-		*my_comm);
-  MPI_Allreduce(MPI_IN_PLACE, &success_initial, 1, MPI_INT, MPI_SUM, *my_comm);
+  mvs.mean=an->mean;
+  mvs.vari=an->vari;
+#ifdef MPI
+  PoolStats(an, &mvs);
+  if ( nthreads > 1 )
+    success_initial = TeamSumInt(an->group, an->my_group_id, lam_group_size,
+                                 success_initial);
+  else
+    MPI_Allreduce(MPI_IN_PLACE, &success_initial, 1, MPI_INT, MPI_SUM,
+                  *an->my_comm);
+#endif
 
-  mean     /= (double)state->tune.initial_moves;
-  vari      = vari / ((double)state->tune.initial_moves) - mean * mean;
-  acc_ratio = ((double)success_initial) / ((double)state->tune.initial_moves); 
+  an->mean     /= (double)state->tune.initial_moves;
+  an->vari      = an->vari / ((double)state->tune.initial_moves) - an->mean * an->mean;
+  an->acc_ratio = ((double)success_initial) / ((double)state->tune.initial_moves); 
+  an->metro_S   = &an->S;
 
 /* initialize Lam parameters used for calculating Lam estimators */
   
-  InitializeParameter();
+  InitializeParameter(an);
 }
 
 
@@ -939,7 +1083,7 @@ void InitialLoop(void)
  *                        ning code                                        *
  ***************************************************************************/
 
-void InitializeParameter(void)
+void InitializeParameter(Annealer *an)
 {
   double   d;             /* d is used to store intermediate results below */
 
@@ -952,35 +1096,35 @@ void InitializeParameter(void)
 
 /* set estimators to stats collected during initializing phase of run */
 
-  estimate_sd   = sqrt(vari);
-  estimate_mean = mean;
+  an->estimate_sd   = sqrt(an->vari);
+  an->estimate_mean = an->mean;
 
 /* initialize A,B,D,E according to Lam & Delosme, 1988b, p10 */
 
-  A = estimate_sd * estimate_sd / (estimate_mean * estimate_mean);
-  B = (1.0 / estimate_mean) - (A * S_0);
-  D = estimate_sd / estimate_mean;
-  E = (1.0 / estimate_sd) - (D * S_0); 
+  an->A = an->estimate_sd * an->estimate_sd / (an->estimate_mean * an->estimate_mean);
+  an->B = (1.0 / an->estimate_mean) - (an->A * an->S_0);
+  an->D = an->estimate_sd / an->estimate_mean;
+  an->E = (1.0 / an->estimate_sd) - (an->D * an->S_0); 
 
 /* initialize these intermediate variables for updating funcs for A,B,D,E */
 
-  usum = vsum = 1.0;
-  usxy = usxx = usx = 0.0;
-  usy  = 1.0 / estimate_mean;
-  usyy = usy * usy;
-  vsxy = vsxx = vsx = 0.0;
-  vsy  = 1.0 / estimate_sd;
-  vsyy = vsy * vsy;
+  an->usum = an->vsum = 1.0;
+  an->usxy = an->usxx = an->usx = 0.0;
+  an->usy  = 1.0 / an->estimate_mean;
+  an->usyy = an->usy * an->usy;
+  an->vsxy = an->vsxx = an->vsx = 0.0;
+  an->vsy  = 1.0 / an->estimate_sd;
+  an->vsyy = an->vsy * an->vsy;
 
 /* set the initial temperature and the initial delta S */
 
-  S  = S_0; 
-  dS = 0.5 / estimate_sd;            /* keep--may not need--based on s_0=0 */
+  an->S  = an->S_0; 
+  an->dS = 0.5 / an->estimate_sd;            /* keep--may not need--based on s_0=0 */
 
 /* alpha is the third term of the main Lam schedule formula */
 
-  d     = (1.0 - acc_ratio) / (2.0 - acc_ratio);
-  alpha = 4.0 * acc_ratio * d * d;
+  d     = (1.0 - an->acc_ratio) / (2.0 - an->acc_ratio);
+  an->alpha = 4.0 * an->acc_ratio * d * d;
 
 #ifdef MPI 
 /* 2. set local parameters *************************************************
@@ -992,34 +1136,34 @@ void InitializeParameter(void)
 
 /* set estimators to stats collected during initializing phase of run */
 
-    l_estimate_sd                         = sqrt(l_vari);
-    l_estimate_mean_l = l_estimate_mean_u = l_mean;
+    an->l_estimate_sd                         = sqrt(an->l_vari);
+    an->l_estimate_mean_l = an->l_estimate_mean_u = an->l_mean;
 
 /* initialize local A,B,D,E */
 
-    l_A_l = l_A_u = l_estimate_sd * l_estimate_sd / 
-      (l_estimate_mean_u * l_estimate_mean_u);
-    l_B_l = l_B_u = (1.0 / l_estimate_mean_u) - (l_A_u * S_0);
+    an->l_A_l = an->l_A_u = an->l_estimate_sd * an->l_estimate_sd / 
+      (an->l_estimate_mean_u * an->l_estimate_mean_u);
+    an->l_B_l = an->l_B_u = (1.0 / an->l_estimate_mean_u) - (an->l_A_u * an->S_0);
 
-    l_D           = l_estimate_sd / l_estimate_mean_u;
-    l_E           = (1.0 / l_estimate_sd) - (l_D * S_0);
+    an->l_D           = an->l_estimate_sd / an->l_estimate_mean_u;
+    an->l_E           = (1.0 / an->l_estimate_sd) - (an->l_D * an->S_0);
 
 /* initialize these intermediate variables for updating funcs for A,B,D,E */
 
-    l_usum_l = l_usum_u = l_vsum = 1.0;
+    an->l_usum_l = an->l_usum_u = an->l_vsum = 1.0;
 
-    l_usxy_l = l_usxy_u = l_usxx_l = l_usxx_u = l_usx_l = l_usx_u = 0.0;
-    l_usy_l  = l_usy_u  = 1.0 / l_estimate_mean_u;
-    l_usyy_l = l_usyy_u = l_usy_u * l_usy_u;
+    an->l_usxy_l = an->l_usxy_u = an->l_usxx_l = an->l_usxx_u = an->l_usx_l = an->l_usx_u = 0.0;
+    an->l_usy_l  = an->l_usy_u  = 1.0 / an->l_estimate_mean_u;
+    an->l_usyy_l = an->l_usyy_u = an->l_usy_u * an->l_usy_u;
 
-    l_vsxy              = l_vsxx              = l_vsx             = 0.0;
-    l_vsy               = 1.0 / l_estimate_sd;
-    l_vsyy              = l_vsy * l_vsy;
+    an->l_vsxy              = an->l_vsxx              = an->l_vsx             = 0.0;
+    an->l_vsy               = 1.0 / an->l_estimate_sd;
+    an->l_vsyy              = an->l_vsy * an->l_vsy;
 
 /* alpha is the third term of the main Lam schedule formula */
     
-    l_d     = (1.0 - l_acc_ratio) / (2.0 - l_acc_ratio);
-    l_alpha = 4.0 * l_acc_ratio * l_d * l_d;
+    l_d     = (1.0 - an->l_acc_ratio) / (2.0 - an->l_acc_ratio);
+    an->l_alpha = 4.0 * an->l_acc_ratio * l_d * l_d;
 
   }
 
@@ -1027,7 +1171,7 @@ void InitializeParameter(void)
 
 /* weights determine how the estimators are sampled for times before tau */
 
-  InitializeWeights();
+  InitializeWeights(an);
 
 }
 
@@ -1038,7 +1182,7 @@ void InitializeParameter(void)
  *                      lambda memory length products                      *
  ***************************************************************************/
 
-void InitializeWeights(void)
+void InitializeWeights(Annealer *an)
 {
   FILE  *logptr;
 #ifdef MPI
@@ -1047,17 +1191,17 @@ void InitializeWeights(void)
 
 /* w_a is the weight for the mean */
 
-  w_a = state->tune.lambda_mem_length_u / state->tune.lambda;
-  w_a = 1.0 - state->tune.tau / w_a;
-  if (w_a < 0.0) 
-    w_a = 0.0;          
+  an->w_a = state->tune.lambda_mem_length_u / state->tune.lambda;
+  an->w_a = 1.0 - state->tune.tau / an->w_a;
+  if (an->w_a < 0.0) 
+    an->w_a = 0.0;          
 
 /* w_b is the weight for the standard deviation */
 
-  w_b = state->tune.lambda_mem_length_v / state->tune.lambda;
-  w_b = 1.0 - state->tune.tau / w_b;
-  if (w_b < 0.0) 
-    w_b = 0.0;            
+  an->w_b = state->tune.lambda_mem_length_v / state->tune.lambda;
+  an->w_b = 1.0 - state->tune.tau / an->w_b;
+  if (an->w_b < 0.0) 
+    an->w_b = 0.0;            
 
 #ifdef MPI
 /* local weights: there are two sets of local statistics, since we require *
@@ -1075,12 +1219,12 @@ void InitializeWeights(void)
 
 /* l_w_a_{l|u} are the local weights for the mean */
 
-    l_w_a_l = w_a / (double)nnodes;
-    l_w_a_u = w_a;
+    an->l_w_a_l = an->w_a / (double)nnodes;
+    an->l_w_a_u = an->w_a;
 
 /* l_w_b is the local weight for the standard deviation */ 
 
-    l_w_b   = w_b;
+    an->l_w_b   = an->w_b;
 
   }
 
@@ -1088,12 +1232,12 @@ void InitializeWeights(void)
 
   if ( !equil && !bench && !nofile_flag ) {
 #ifdef MPI
-    if ( myid == 0 ) {
+    if ( myid == 0 && an->thread == 0 ) {
 #endif
       logptr = fopen(logfile, "w");
       if ( !logptr )
 	file_error("InitializeWeights");
-      fprintf(logptr, "InitializeWeights:  w_a = %g w_b = %g\n", w_a, w_b );
+      fprintf(logptr, "InitializeWeights:  w_a = %g w_b = %g\n", an->w_a, an->w_b );
       fclose(logptr);
 #ifdef MPI
     }
@@ -1104,14 +1248,14 @@ void InitializeWeights(void)
 	file_error("InitializeWeights");
       fprintf(l_logptr, 
 	      "InitializeWeights:  l_w_a = %g l_w_b = %g\n", 
-	      l_w_a_u, l_w_b );
+	      an->l_w_a_u, an->l_w_b );
       fclose(l_logptr);
     }
 
     if ( myid == 0 )
 #endif
       if ( log_flag )
-	printf("InitializeWeights:  w_a = %g w_b = %g\n", w_a, w_b );
+	printf("InitializeWeights:  w_a = %g w_b = %g\n", an->w_a, an->w_b );
   }
 }
 
@@ -1121,7 +1265,7 @@ void InitializeWeights(void)
 /*** InitTuning: sets up/restores structs and variables for tuning runs ****
  ***************************************************************************/
 
-void InitTuning(void)
+void InitTuning(Annealer *an)
 {
   int     i;                                               /* loop counter */
   FILE    *mbptr;                            /* pointer for mix_bound file */
@@ -1169,28 +1313,28 @@ void InitTuning(void)
 
 /* allocate memory for various tuning-specific arrays */
 
-  dev = (double *)calloc(sub_tune_interval*sample_size, sizeof(double));
-  tot_dev = 
+  an->dev = (double *)calloc(sub_tune_interval*sample_size, sizeof(double));
+  an->tot_dev = 
     (double *)calloc(sub_tune_interval*covar_sample, sizeof(double));
-  coll_dev = (double *)calloc(covar_sample, sizeof(double));
+  an->coll_dev = (double *)calloc(covar_sample, sizeof(double));
 
-  means = (double *)calloc(sub_tune_interval*sample_size, sizeof(double));
-  tot_means = 
+  an->means = (double *)calloc(sub_tune_interval*sample_size, sizeof(double));
+  an->tot_means = 
    (double *)calloc(sub_tune_interval*covar_sample, sizeof(double));
-  coll_means = (double *)calloc(covar_sample, sizeof(double));
+  an->coll_means = (double *)calloc(covar_sample, sizeof(double));
 
   tau_count    =    (int *)calloc(tune_interval, sizeof(int));
-  cross_correl = (double *)calloc(tune_interval, sizeof(double));
-  var_means    = (double *)calloc(tune_interval, sizeof(double));
+  an->cross_correl = (double *)calloc(tune_interval, sizeof(double));
+  an->var_means    = (double *)calloc(tune_interval, sizeof(double));
 
-  midpoints    =    (int *)calloc(MAX_MIX, sizeof(int));
+  an->midpoints    =    (int *)calloc(MAX_MIX, sizeof(int));
   
 /* initialize the arrays used to collect tuning information */
 
   for (i=0; i<tune_interval; i++) {
     tau_count[i]    = (i+1)*covar_index;
-    cross_correl[i] = 0.;
-    var_means[i]    = 0.;
+    an->cross_correl[i] = 0.;
+    an->var_means[i]    = 0.;
   }
 
 /* initialize the mb file */
@@ -1213,16 +1357,19 @@ void InitTuning(void)
  *         considered frozen according to the stop criterion               *
  ***************************************************************************/
 
-void Loop(void)
+void Loop(Annealer *an)
 {
   int    i;                                          /* local loop counter */
   double energy_change;                                   /* local Delta E */
   double d;                /* difference between energy and estimated mean */
+  int    nfold;     /* 1 if these proc_tau steps are rejection-free (SRV) */
+  int    wait;              /* steps left before the next accepted move */
+  int    nskip;                        /* steps spent waiting (n-fold) */
   
 /* quenchit mode: set temperature to (approximately) zero immediately */
 
   if ( quenchit )
-    S = DBL_MAX;
+    an->S = DBL_MAX;
 
 /* loop till the end of the universe (or till the stop criterion applies) */
 
@@ -1230,69 +1377,85 @@ void Loop(void)
      
 /* reset statistics */
 
-    mean    = 0.0;  
-    vari    = 0.0;
-    success = 0;
+    an->mean    = 0.0;  
+    an->vari    = 0.0;
+    an->success = 0;
     
 #ifdef MPI
-    l_mean     = 0.0;
-    l_vari     = 0.0;
-    l_success  = 0;   
+    an->l_mean     = 0.0;
+    an->l_vari     = 0.0;
+    an->l_success  = 0;   
 #endif
+
+/* SRV 2026-10-17: at the cold end, the problem may take over the Metro-   *
+ * polis part (n-fold way): it tells how many steps go by until a move is  *
+ * accepted, and which one; the steps in between still get their stats    *
+ * and UpdateS below, only no moves are made for them; not when tuning,   *
+ * which samples every move                                                */
+
+    nfold = !quenchit && !tuning && NFoldSwitch(an, an->acc_ratio, an->S);
+    wait  = -1;
+    nskip = 0;
     
 /* do proc_tau moves here */
 
     for (i=0; i<proc_tau; i++) {    
+
+      if ( nfold ) {
+        if ( wait < 0 )
+          wait = NFoldWait(an);
+        if ( wait > 0 ) {                       /* a step that rejects */
+          wait--;
+          nskip++;
+        } else {                         /* the step that accepts (maybe) */
+          wait = -1;
+          energy_change = NFoldMove(an, an->S);
+          if ( energy_change == FORBIDDEN_MOVE ) {
+            RejectMove(an);
+          } else {
+            an->energy += energy_change;
+            AcceptMove(an);
+            an->success++;
+          }
+        }
+      } else {
       
 /* make a move: will either return the energy change or FORBIDDEN_MOVE */
-          energy_change = GenerateMove();
-      if (energy+energy_change<0)
-        printf("%f %f\n",energy_change,energy);    
-/* Metropolis stuff here; we usually want FORBIDDEN_MOVE to be very large  *
- * that's why we want to prevent overflows here (hence the 'if'); we also  *
- * need to avoid overflows with quenchit (where S is (almost) infinite!)   */
+          energy_change = GenerateMove(an);
+      if (an->energy+energy_change<0)
+        printf("%f %f\n",energy_change,an->energy);    
 
-      if ( !quenchit && (energy_change != FORBIDDEN_MOVE ) )
-	exp_arg = -S * energy_change;
-
-/* MIN_DELTA provides a min. probability with which any move is accepted */
-
-      if ( (exp_arg <= MIN_DELTA) )
-	exp_arg = MIN_DELTA;         
-      
 /* below, we apply the Metropolis criterion to accept or reject a move; in *
  * quenchit mode, only lower energies are accepted                         */
-            if ( energy_change == FORBIDDEN_MOVE ) {
-	RejectMove();
-      } else if ( (energy_change <= 0.0) || 
-		  ( (!quenchit) && (exp(exp_arg) > RandomReal()) ) ) {	
-	energy += energy_change;
-#ifdef MPI
-  if(energy<0){
-    printf("%d,%f,%d\n",state->tune.initial_moves+proc_init+count_tau*proc_tau+i,energy,myid);
-    printf("%d\n", (count_tau % state->tune.mix_interval));
+      if ( Metropolis(an, energy_change) ) {
+	an->energy += energy_change;
+#ifdef MPI
+  if(an->energy<0){
+    printf("%d,%f,%d\n",state->tune.initial_moves+proc_init+an->count_tau*proc_tau+i,an->energy,myid);
+    printf("%d\n", (an->count_tau % state->tune.mix_interval));
       }
 #endif
-	AcceptMove();
-	success++;
+	AcceptMove(an);
+	an->success++;
 
       } else {
-	RejectMove();
+	RejectMove(an);
       }
+      }                                         /* end of the one-by-one step */
 
 /* update statistics */
 
-      mean    += energy;
-      d        = energy - estimate_mean;
-      vari    += d * d;
+      an->mean    += an->energy;
+      d        = an->energy - an->estimate_mean;
+      an->vari    += d * d;
 #ifdef MPI
 /* if tuning: calculate the local mean and variance */
 
       if ( tuning && nnodes>1 ) {
 
-	l_mean  += energy;
-	d        = energy - l_estimate_mean_u;
-	l_vari  += d * d;
+	an->l_mean  += an->energy;
+	d        = an->energy - an->l_estimate_mean_u;
+	an->l_vari  += d * d;
       
 /* Collect samples for tuning: local estimated deviations (for calculating *
  * cross-correlation between processors for the lower bound of M) and lo-  *
@@ -1301,11 +1464,11 @@ void Loop(void)
  * keep track of the moves we've done in the current sub_tune_interval and *
  * of the number of samples we've collected in the tune_interval           */
 
-        dev[moves_tune]   = energy - l_estimate_mean_l;
-        means[moves_tune] = l_estimate_mean_u;
-        moves_tune++;   
-	if ( (moves_tune % sample_size) == 0 )
-	  count_sample++; 
+        an->dev[an->moves_tune]   = an->energy - an->l_estimate_mean_l;
+        an->means[an->moves_tune] = an->l_estimate_mean_u;
+        an->moves_tune++;   
+	if ( (an->moves_tune % sample_size) == 0 )
+	  an->count_sample++; 
       }
 #endif
 
@@ -1314,22 +1477,25 @@ void Loop(void)
  * lete by now, but since it doesn't seem to do any harm and saves us some *
  * time, we left it in here                */
         if ( !quenchit ) 
-	  UpdateS();      
+	  UpdateS(an);      
     }                 /* this is the end of the proc_tau loop */            
+
+    if ( nskip )
+      NFoldSkip(an, nskip);
     
 /* have done tau moves here: update the 'tau' counter */
   /* apparently not. Fuck. */
-    count_tau++;  
+    an->count_tau++;  
 /* calculate mean, variance and acc_ratio for the last tau steps; i is     *
  * passed as an argument for checking if all local moves add up to Tau     */
-    UpdateStats();
+    UpdateStats(an);
 /* check if the stop criterion applies: annealing and tuning runs (that    *
  * aren't stopped by the tuning stop criterion) leave the loop here; equi- *
  * libration runs exit below                                               */
 
 #ifdef MPI
-    if ( Frozen() && !equil ) {
-      local_frozen=1; /* Marks this group as frozen. Do not want to halt 
+    if ( Frozen(an) && !equil ) {
+      an->local_frozen=1; /* Marks this group as frozen. Do not want to halt 
                          if it freezes, as other groups will not have 
                          frozen necessarily (want to avoid premature 
                          freezing) */
@@ -1342,22 +1508,22 @@ void Loop(void)
 /* update Lam stats: estimators for mean, sd and alpha from acc_ratio (we  *
  * don't need this in quenchit mode since the temperature is fixed to 0)   */
     if ( !quenchit ) {
-      UpdateParameter(); 
+      UpdateParameter(an); 
     }
 #ifdef MPI
 /* tuning code: first update local Lam estimators */
 
     if ( tuning && nnodes>1 ) {
-      UpdateLParameter();         
+      UpdateLParameter(an);         
       
 /* Do tuning every sub_tune_interval, only after first mix */
 
-      if ( (count_sample % sub_tune_interval) == 0 && count_sample > 0 ) 
-	if (count_mix > 0) {
-	  DoTuning();
+      if ( (an->count_sample % sub_tune_interval) == 0 && an->count_sample > 0 ) 
+	if (an->count_mix > 0) {
+	  DoTuning(an);
 	}
 	else
-	  moves_tune = 0;
+	  an->moves_tune = 0;
       
 /* At the end of each tune interval: ***************************************
  * 1. Root process writes tuning every tune_interval, only after first mix *
@@ -1367,24 +1533,24 @@ void Loop(void)
  *    stop tuning run (runs can be forced to continue using the -S option) *
  ***************************************************************************/
 
-      if ( (count_sample % tune_interval) == 0 && count_sample > 0 ) {
+      if ( (an->count_sample % tune_interval) == 0 && an->count_sample > 0 ) {
 
-	if ( count_mix > 0 ) 
-	  WriteTuning();
+	if ( an->count_mix > 0 ) 
+	  WriteTuning(an);
 
-	if ( (count_mix >= stop_tune_count) && auto_stop_tune ) 
-	  if ( StopTuning() ) { 
-	    free(dev);
-	    free(tot_dev);
-	    free(coll_dev);
-	    free(means);
-	    free(tot_means);
-	    free(coll_means);
+	if ( (an->count_mix >= stop_tune_count) && auto_stop_tune ) 
+	  if ( StopTuning(an) ) { 
+	    free(an->dev);
+	    free(an->tot_dev);
+	    free(an->coll_dev);
+	    free(an->means);
+	    free(an->tot_means);
+	    free(an->coll_means);
 	    free(tau_count);
-	    free(cross_correl);
-	    free(var_means);
-	    free(midpoints);
-	    FinalMove();
+	    free(an->cross_correl);
+	    free(an->var_means);
+	    free(an->midpoints);
+	    FinalMove(an);
 	    return;               /* exit the loop here if finished tuning */
 	  }
       }
@@ -1392,11 +1558,11 @@ void Loop(void)
 	   
 /* at each mix_interval: do some mixing */
 
-    if ( count_tau % state->tune.mix_interval == 0 )  {
+    if ( an->count_tau % state->tune.mix_interval == 0 )  {
 
-      DoMix();
-            if (tot_frozen > 0){
-        FinalMove();
+      DoMix(an);
+            if (an->tot_frozen > 0){
+        FinalMove(an);
         return;
       }
 
@@ -1406,8 +1572,8 @@ void Loop(void)
  * group exiting early due to variable temperature in between mixes. This  *
  * breaks equilibration for serial runs, however for serial runs you       *
  * should use fly_seb_edition.                                             */
-      if ( (equil == 1) && (1.0/S <= equil_param.end_T) ) {
-                if (count_mix % glob_interval == 0){
+      if ( (equil == 1) && (1.0/an->S <= equil_param.end_T) ) {
+                if (an->count_mix % glob_interval == 0){
          /* S = 1./equil_param.end_T; * We want equilibration to measure
           * the time needed after a global mix to stabilise theta, don't
           * want to confound it by changing the temperature after a 
@@ -1421,11 +1587,11 @@ void Loop(void)
 /* write the log every print_freq * tau (not proc_tau!) */
 
 #ifdef MPI
-    if ( (count_tau % (print_freq*nnodes) == 0) && !equil && !nofile_flag )
+    if ( (an->count_tau % (print_freq*nchains) == 0) && !equil && !nofile_flag )
 #else
-    if ( (count_tau % print_freq == 0) && !equil && !nofile_flag )
+    if ( (an->count_tau % print_freq == 0) && !equil && !nofile_flag )
 #endif
-      WriteLog();                     
+      WriteLog(an);                     
 
 /* the state file gets written here every state_write * tau */
 /* Currently StateWrite Not Working */
@@ -1448,43 +1614,43 @@ void Loop(void)
 /*** UpdateS: update inverse temperature S at every Sskip step *************
  ***************************************************************************/
 
-void UpdateS(void)
+void UpdateS(Annealer *an)
 {
   register double    d;              /* used to store intermediate results */
 
-  S += dS;                   /* here, inverse temperature is updated by dS */
+  an->S += an->dS;                   /* here, inverse temperature is updated by dS */
 
 /* we need to update Lam parameters here, since S has changed; A, B, C and */
 /* D get updated in UpdateParameters                                       */
 
-  estimate_mean = 1.0 / (A*S + B);    /* for temperature updating formulas */
-  estimate_sd   = 1.0 / (D*S + E);        /* see Lam & Delosme, 1988b, p10 */
+  an->estimate_mean = 1.0 / (an->A*an->S + an->B);    /* for temperature updating formulas */
+  an->estimate_sd   = 1.0 / (an->D*an->S + an->E);        /* see Lam & Delosme, 1988b, p10 */
 
 #ifdef MPI
 
 /* do the same for local Lam parameters (for both lower and upper bounds) */
 
   if ( tuning && nnodes>1 ) {
-    l_estimate_mean_l = 1.0 / (l_A_l*S + l_B_l);
-    l_estimate_mean_u = 1.0 / (l_A_u*S + l_B_u);
-    l_estimate_sd     = 1.0 / (l_D  *S + l_E);
+    an->l_estimate_mean_l = 1.0 / (an->l_A_l*an->S + an->l_B_l);
+    an->l_estimate_mean_u = 1.0 / (an->l_A_u*an->S + an->l_B_u);
+    an->l_estimate_sd     = 1.0 / (an->l_D  *an->S + an->l_E);
   }
 #endif  
 
-  d   = S * estimate_sd;             /* intermediate for the specific heat */
+  d   = an->S * an->estimate_sd;             /* intermediate for the specific heat */
 
 /* following lines implement the main Lam schedule formula */
 
-  dS  = state->tune.lambda * alpha / (d*d * estimate_sd);
-  dS *= state->tune.update_S_skip;       /* ... we have to muliply by skip */
+  an->dS  = state->tune.lambda * an->alpha / (d*d * an->estimate_sd);
+  an->dS *= state->tune.update_S_skip;       /* ... we have to muliply by skip */
 
 #ifdef MPI
-  dS *= nnodes;
+  an->dS *= nchains;
 #endif
 
 /* reset skip */
 
-  skip = state->tune.update_S_skip;
+  an->skip = state->tune.update_S_skip;
 
 }
 
@@ -1493,7 +1659,7 @@ void UpdateS(void)
 /*** UpdateStats: updates mean, variance and acc_ratio after tau moves *****
  ***************************************************************************/
 
-void UpdateStats()
+void UpdateStats(Annealer *an)
 {
 #ifdef MPI
 
@@ -1501,30 +1667,28 @@ void UpdateStats()
 
 
 /* parallel code: pool statistics from all nodes */
-  mvs.mean    = mean;
-  mvs.vari    = vari;
-  mvs.success = success;
+  mvs.mean    = an->mean;
+  mvs.vari    = an->vari;
+  mvs.success = an->success;
 
+  PoolStats(an, &mvs);
+   an->success = mvs.success;  /* success is now global success! */
   
-    MPI_Allreduce(MPI_IN_PLACE, &mvs, 1, MPI_Meanvarisucc, MPI_Meanvarisucc_sum, 
-		*my_comm);
-   success = mvs.success;  /* success is now global success! */
-  
-  mean = mvs.mean/Tau;  /* mean and variance are now summed over all nodes */
-  vari = mvs.vari/Tau;
+  an->mean = mvs.mean/Tau;  /* mean and variance are now summed over all nodes */
+  an->vari = mvs.vari/Tau;
 
 /* local stats are updated below */
 
 #else
 
-  mean /= Tau;                                  /* collect some statistics */
-  vari /= Tau;
+  an->mean /= Tau;                                  /* collect some statistics */
+  an->vari /= Tau;
 
 #endif
 
-  acc_ratio = ((double)success) / Tau ;         /* update acceptance ratio */
-  *m_success+= (uint16_t)success;
-  UpdateControl(m_success); /* Here we access UpdateControl if we need it. */
+  an->acc_ratio = ((double)an->success) / Tau ;         /* update acceptance ratio */
+  an->m_success+= (uint16_t)an->success;
+  UpdateControl(an, &an->m_success); /* Here we access UpdateControl if we need it. */
   }
 
 
@@ -1532,87 +1696,90 @@ void UpdateStats()
  *                    for mean and standard deviation for the current S    *
  ***************************************************************************/
 
-void UpdateParameter(void)
+void UpdateParameter(Annealer *an)
 {
   register double   d;    /* d is used to store intermediate results below */
 
 
 /* this part of the code updates the estimator for the mean */
 
-  d     = 1.0 / mean; 
+  d     = 1.0 / an->mean; 
 
 /* first: multiply all intermediate vars by weights */
 
-  usyy *= w_a;
-  usxy *= w_a;
-  usy  *= w_a;
-  usx  *= w_a;
-  usxx *= w_a;
-  usum *= w_a;
+  an->usyy *= an->w_a;
+  an->usxy *= an->w_a;
+  an->usy  *= an->w_a;
+  an->usx  *= an->w_a;
+  an->usxx *= an->w_a;
+  an->usum *= an->w_a;
 
 /* then: update all intermediate vars */
 
-  usyy += d*d;                      
-  usxy += S*d;
-  usy  += d;
-  usx  += S;
-  usxx += S*S;
-  usum += 1.0;
+  an->usyy += d*d;                      
+  an->usxy += an->S*d;
+  an->usy  += d;
+  an->usx  += an->S;
+  an->usxx += an->S*an->S;
+  an->usum += 1.0;
                         
 /* ... and use intermediate vars to update A and B ... */
 /* Seb: Added a statement to check for division by 0. */
-  if (usum*usxx-usx*usx)
-    A = (usum * usxy - usx * usy) / (usum * usxx - usx * usx);
+  if (an->usum*an->usxx-an->usx*an->usx)
+    an->A = (an->usum * an->usxy - an->usx * an->usy) / (an->usum * an->usxx - an->usx * an->usx);
   else
-    A = (usum * usxy - usx * usy) / DBL_MIN;
+    an->A = (an->usum * an->usxy - an->usx * an->usy) / DBL_MIN;
 
-  B = (usy - A * usx)/usum;
+  an->B = (an->usy - an->A * an->usx)/an->usum;
 
 /* ... which are then used to update the estimator for the mean */
 
-  estimate_mean = 1.0 / (A * S + B);
+  an->estimate_mean = 1.0 / (an->A * an->S + an->B);
 
 
-/* this part of the code updates the estimator for the standard deviation */
+/* this part of the code updates the estimator for the standard deviation; *
+ * a chain that has frozen (nothing accepted, or only moves that leave E as *
+ * it is) has a variance of rounding noise only, which would send the sd    *
+ * estimator to 0 and dS, and so S, to inf (SRV 2026-10-18)                 */
 
-  if (vari > 0.0) {
+  if (an->vari > VARI_NOISE * an->mean * an->mean) {
 
-    d     = 1.0 / sqrt(vari);
+    d     = 1.0 / sqrt(an->vari);
 
 /* first: multiply all intermediate vars by weights */
 
-    vsyy *= w_b;       
-    vsxy *= w_b;
-    vsy  *= w_b;
-    vsx  *= w_b;
-    vsxx *= w_b;
-    vsum *= w_b;
+    an->vsyy *= an->w_b;       
+    an->vsxy *= an->w_b;
+    an->vsy  *= an->w_b;
+    an->vsx  *= an->w_b;
+    an->vsxx *= an->w_b;
+    an->vsum *= an->w_b;
 
 /* then: update all intermediate vars */
 
-    vsyy += d*d;                     
-    vsxy += S*d;
-    vsy  += d;
-    vsx  += S;
-    vsxx += S*S;
-    vsum += 1.0;
+    an->vsyy += d*d;                     
+    an->vsxy += an->S*d;
+    an->vsy  += d;
+    an->vsx  += an->S;
+    an->vsxx += an->S*an->S;
+    an->vsum += 1.0;
                         
 /* ... and use intermediate vars to update D and E ... */
 
-    D = (vsum * vsxy - vsx * vsy) / (vsum * vsxx - vsx * vsx);
-    E = (vsy - D * vsx) / vsum;
+    an->D = (an->vsum * an->vsxy - an->vsx * an->vsy) / (an->vsum * an->vsxx - an->vsx * an->vsx);
+    an->E = (an->vsy - an->D * an->vsx) / an->vsum;
   }
 
 /* ... which are then used to update the estimator for the std dev */
 
-  estimate_sd = 1.0 / (D*S + E);
+  an->estimate_sd = 1.0 / (an->D*an->S + an->E);
 
 /* alpha corresponds to the third term in the main Lam schedule formula,   *
  * which is a measure of how efficiently the space state is samples; this  *
  * term is at a maximum for acc_ratio = 0.44, see Lam & Delosme, 1988b, p1 */
 
-  d = (1.0 - acc_ratio) / (2.0 - acc_ratio);   
-  alpha = 4.0 * acc_ratio * d * d;
+  d = (1.0 - an->acc_ratio) / (2.0 - an->acc_ratio);   
+  an->alpha = 4.0 * an->acc_ratio * d * d;
 
 }                                 
 
@@ -1625,111 +1792,111 @@ void UpdateParameter(void)
  *                     when tuning                                         *
  ***************************************************************************/
 
-void UpdateLParameter(void)
+void UpdateLParameter(Annealer *an)
 {
   register double d;      /* d is used to store intermediate results below */
 
 /* update the estimator for the local mean */
 
-  d = 1.0 / l_mean;
+  d = 1.0 / an->l_mean;
 
 /* first: multiply all intermediate vars by weights */
 /* lower bound variables: */
 
-  l_usyy_l *= l_w_a_l;     
-  l_usxy_l *= l_w_a_l;
-  l_usy_l  *= l_w_a_l;
-  l_usx_l  *= l_w_a_l;
-  l_usxx_l *= l_w_a_l;
-  l_usum_l *= l_w_a_l;
+  an->l_usyy_l *= an->l_w_a_l;     
+  an->l_usxy_l *= an->l_w_a_l;
+  an->l_usy_l  *= an->l_w_a_l;
+  an->l_usx_l  *= an->l_w_a_l;
+  an->l_usxx_l *= an->l_w_a_l;
+  an->l_usum_l *= an->l_w_a_l;
 
 /* upper bound variables: */
 
-  l_usyy_u *= l_w_a_u;     
-  l_usxy_u *= l_w_a_u;
-  l_usy_u  *= l_w_a_u;
-  l_usx_u  *= l_w_a_u;
-  l_usxx_u *= l_w_a_u;
-  l_usum_u *= l_w_a_u;
+  an->l_usyy_u *= an->l_w_a_u;     
+  an->l_usxy_u *= an->l_w_a_u;
+  an->l_usy_u  *= an->l_w_a_u;
+  an->l_usx_u  *= an->l_w_a_u;
+  an->l_usxx_u *= an->l_w_a_u;
+  an->l_usum_u *= an->l_w_a_u;
 
 /* then: update all intermediate vars */
 /* lower bound variables: */
 
-  l_usyy_l += d*d;                     
-  l_usxy_l += S*d;
-  l_usy_l  += d;
-  l_usx_l  += S;
-  l_usxx_l += S*S;
-  l_usum_l += 1.0;
+  an->l_usyy_l += d*d;                     
+  an->l_usxy_l += an->S*d;
+  an->l_usy_l  += d;
+  an->l_usx_l  += an->S;
+  an->l_usxx_l += an->S*an->S;
+  an->l_usum_l += 1.0;
 
 /* upper bound variables: */
 
-  l_usyy_u += d*d;                     
-  l_usxy_u += S*d;
-  l_usy_u  += d;
-  l_usx_u  += S;
-  l_usxx_u += S*S;
-  l_usum_u += 1.0;
+  an->l_usyy_u += d*d;                     
+  an->l_usxy_u += an->S*d;
+  an->l_usy_u  += d;
+  an->l_usx_u  += an->S;
+  an->l_usxx_u += an->S*an->S;
+  an->l_usum_u += 1.0;
 
 /* ... and use intermediate vars to update l_A_{l|u} and l_B_{l|u} ... */
 
 /* lower bound variables: */
 
-  l_A_l = (l_usum_l * l_usxy_l - l_usx_l * l_usy_l) / 
-    (l_usum_l * l_usxx_l - l_usx_l * l_usx_l);
-  l_B_l = (l_usy_l - l_A_l * l_usx_l) / l_usum_l;
+  an->l_A_l = (an->l_usum_l * an->l_usxy_l - an->l_usx_l * an->l_usy_l) / 
+    (an->l_usum_l * an->l_usxx_l - an->l_usx_l * an->l_usx_l);
+  an->l_B_l = (an->l_usy_l - an->l_A_l * an->l_usx_l) / an->l_usum_l;
 
 /* upper bound variables: */
 
-  l_A_u = (l_usum_u * l_usxy_u - l_usx_u * l_usy_u) / 
-    (l_usum_u * l_usxx_u - l_usx_u * l_usx_u);
-  l_B_u = (l_usy_u - l_A_u * l_usx_u) / l_usum_u;
+  an->l_A_u = (an->l_usum_u * an->l_usxy_u - an->l_usx_u * an->l_usy_u) / 
+    (an->l_usum_u * an->l_usxx_u - an->l_usx_u * an->l_usx_u);
+  an->l_B_u = (an->l_usy_u - an->l_A_u * an->l_usx_u) / an->l_usum_u;
 
 /* ... which are then used to update the local estimators for the mean */
 
-  l_estimate_mean_l = 1.0 / (l_A_l * S + l_B_l);
-  l_estimate_mean_u = 1.0 / (l_A_u * S + l_B_u);
+  an->l_estimate_mean_l = 1.0 / (an->l_A_l * an->S + an->l_B_l);
+  an->l_estimate_mean_u = 1.0 / (an->l_A_u * an->S + an->l_B_u);
 
 /* update the local estimator for the standard deviation */
 
-  if ( l_vari > 0.0 ) {
+  if ( an->l_vari > 0.0 ) {
 
-      d = 1.0 / sqrt(l_vari);
+      d = 1.0 / sqrt(an->l_vari);
 
 /* first: multiply all intermediate vars by weights */
 
-      l_vsyy *= l_w_b; 
-      l_vsxy *= l_w_b;
-      l_vsy  *= l_w_b;
-      l_vsx  *= l_w_b;
-      l_vsxx *= l_w_b;
-      l_vsum *= l_w_b;
+      an->l_vsyy *= an->l_w_b; 
+      an->l_vsxy *= an->l_w_b;
+      an->l_vsy  *= an->l_w_b;
+      an->l_vsx  *= an->l_w_b;
+      an->l_vsxx *= an->l_w_b;
+      an->l_vsum *= an->l_w_b;
 
 /* then: update all intermediate vars */
 
-      l_vsyy += d*d;                 
-      l_vsxy += S*d;
-      l_vsy  += d;
-      l_vsx  += S;
-      l_vsxx += S*S;
-      l_vsum += 1.0;
+      an->l_vsyy += d*d;                 
+      an->l_vsxy += an->S*d;
+      an->l_vsy  += d;
+      an->l_vsx  += an->S;
+      an->l_vsxx += an->S*an->S;
+      an->l_vsum += 1.0;
 
 /* ... and use intermediate vars to update l_D and l_E ... */
 
-      l_D = (l_vsum*l_vsxy - l_vsx*l_vsy) / (l_vsum*l_vsxx - l_vsx*l_vsx);
-      l_E = (l_vsy - l_D*l_vsx) / l_vsum;
+      an->l_D = (an->l_vsum*an->l_vsxy - an->l_vsx*an->l_vsy) / (an->l_vsum*an->l_vsxx - an->l_vsx*an->l_vsx);
+      an->l_E = (an->l_vsy - an->l_D*an->l_vsx) / an->l_vsum;
   }
 
 /* ... which are then used to update the local estimator for the std dev */
 
-  l_estimate_sd = 1.0 / (l_D*S + l_E);
+  an->l_estimate_sd = 1.0 / (an->l_D*an->S + an->l_E);
 
 /* alpha corresponds to the third term in the main Lam schedule formula,   *
  * which is a measure of how efficiently the space state is samples; this  *
  * term is at a maximum for acc_ratio = 0.44, see Lam & Delosme, 1988b, p1 */
 
-  d = (1.0 - l_acc_ratio) / (2.0 - l_acc_ratio);
-  l_alpha = 4.0 * l_acc_ratio * d * d;
+  d = (1.0 - an->l_acc_ratio) / (2.0 - an->l_acc_ratio);
+  an->l_alpha = 4.0 * an->l_acc_ratio * d * d;
 
 }
 #endif
@@ -1741,28 +1908,28 @@ void UpdateLParameter(void)
  *           for a more extensive comment on this)                         *
  ***************************************************************************/
 
-int Frozen(void)
+int Frozen(Annealer *an)
 {
   double  delta;
   if(stop_flag == proportional_freeze)
-    delta = (mean - old_mean)/mean;
+    delta = (an->mean - an->old_mean)/an->mean;
 
   else if (stop_flag == absolute_freeze)
-    delta = mean - old_mean;
+    delta = an->mean - an->old_mean;
   else if (stop_flag == absolute_energy)
-    delta = mean;
+    delta = an->mean;
 
   if (delta <= 0.)
     delta = -delta;
 
   if (delta <= state->tune.criterion) {
-    counter++;
+    an->counter++;
   }
   else {
-    counter  = 0;
-    old_mean = mean;
+    an->counter  = 0;
+    an->old_mean = an->mean;
   }
-  return(counter >= state->tune.freeze_count);
+  return(an->counter >= state->tune.freeze_count);
 }
 
 
@@ -1774,7 +1941,7 @@ int Frozen(void)
  *          dance partner(s)                                               *
  ***************************************************************************/
 
-void DoGlobalMix(void)
+void DoGlobalMix(Annealer *an)
 {
   unsigned char *sendbuf; 
   unsigned char *recvbuf; /* as per usual. */
@@ -1800,50 +1967,50 @@ void DoGlobalMix(void)
   MPI_Request msg_request;
   MPI_Status  msg_status;
   /* Preparation Phase */ 
-  MPI_Reduce(&energy, &score, 1, MPI_DOUBLE, MPI_SUM, 0, *my_comm); /* score based on average energy */
+  MPI_Reduce(&an->energy, &score, 1, MPI_DOUBLE, MPI_SUM, 0, *an->my_comm); /* score based on average energy */
   score=ngroups*score/nnodes;
   if (root_comm != MPI_COMM_NULL){
     MPI_Allreduce(&score, &min_score, 1, MPI_DOUBLE, MPI_MIN, root_comm);
-    score = exp((min_score-score)*S); 
+    score = exp((min_score-score)*an->S); 
     /* score=exp((min(energy of group) - min(min of all groups))*(S of group)) */
-    AssignDancePartner(ngroups, root_comm, score);
+    AssignDancePartner(an, ngroups, root_comm, score);
         MPI_Comm_rank(root_comm, &root_id);
     root_and_dance[0]=root_id;
-    root_and_dance[1]=dance_partner[root_id];
+    root_and_dance[1]=an->dance_partner[root_id];
   }
   else{
     if(logging_mix){
       double *node_prob=calloc(ngroups, sizeof(double));
       int *dance_partner=calloc(ngroups, sizeof(int));
-      WriteMixLog(node_prob,dance_partner); /* dummy variables needed */
+      WriteMixLog(an, node_prob,dance_partner); /* dummy variables needed */
       free(node_prob);
       free(dance_partner);
   } 
   }
-  MakeStateMsg(&sendbuf, padding, &size);
-  MakeGlobalLamMsg(&sendbuf, size);
-  MakeLamMsg(&sendbuf, size);
+  MakeStateMsg(an, &sendbuf, padding, &size);
+  MakeGlobalLamMsg(an, &sendbuf, size);
+  MakeLamMsg(an, &sendbuf, size);
 
-  MPI_Bcast(root_and_dance, 2, MPI_INT, 0, *my_comm);
+  MPI_Bcast(root_and_dance, 2, MPI_INT, 0, *an->my_comm);
   root_id=root_and_dance[0];
   dance_id=root_and_dance[1];
  
     
   MPI_Alloc_mem((MPI_Aint)(sizeof(int)*lam_group_size), MPI_INFO_NULL, &local_ids);
 
-  MPI_Gather(&myid, 1, MPI_INT, local_ids, 1, MPI_INT, 0, *my_comm);
+  MPI_Gather(&myid, 1, MPI_INT, local_ids, 1, MPI_INT, 0, *an->my_comm);
   if (MPI_COMM_NULL != root_comm){
     MPI_Alloc_mem((MPI_Aint)(sizeof(MPI_Request)*ngroups), MPI_INFO_NULL, &follow_requests);
     MPI_Alloc_mem((MPI_Aint)(sizeof(MPI_Status)*ngroups),  MPI_INFO_NULL, &follow_statuses);
     MPI_Alloc_mem((MPI_Aint)(sizeof(int*)*ngroups), MPI_INFO_NULL, &follow_partner_ids);
     lead_partner_ids=(int*)malloc(sizeof(int)*lam_group_size);
     if (dance_id!=root_id){
-      MPI_Irecv(lead_partner_ids, lam_group_size, MPI_INT, dance_partner[root_id], 3*dance_partner[root_id], root_comm, &root_request);
-      MPI_Send(local_ids, lam_group_size, MPI_INT, dance_partner[root_id], 3*dance_partner[root_id]+2, root_comm);
+      MPI_Irecv(lead_partner_ids, lam_group_size, MPI_INT, an->dance_partner[root_id], 3*an->dance_partner[root_id], root_comm, &root_request);
+      MPI_Send(local_ids, lam_group_size, MPI_INT, an->dance_partner[root_id], 3*an->dance_partner[root_id]+2, root_comm);
     }
 
     for (i=0; i<ngroups; i++)
-      if (i != root_id && dance_partner[i] == root_id){
+      if (i != root_id && an->dance_partner[i] == root_id){
         MPI_Alloc_mem((MPI_Aint)(sizeof(int)*lam_group_size), MPI_INFO_NULL, &follow_partner_ids[followers]);
         MPI_Send(local_ids, lam_group_size, MPI_INT,i, 3*root_id, root_comm);
         MPI_Irecv(follow_partner_ids[followers], lam_group_size, MPI_INT, i, 3*root_id+2, root_comm, &follow_requests[followers]);
@@ -1866,11 +2033,11 @@ void DoGlobalMix(void)
       MPI_Alloc_mem((MPI_Aint)(sizeof(int)*lam_group_size), MPI_INFO_NULL, &follow_partner_ids[i]);
     }
   }
-    MPI_Bcast(&followers, 1, MPI_INT, 0, *my_comm);
+    MPI_Bcast(&followers, 1, MPI_INT, 0, *an->my_comm);
   MPI_Alloc_mem((MPI_Aint)(sizeof(int)*followers), MPI_INFO_NULL, &follow_partners);
-  MPI_Scatter(lead_partner_ids, 1, MPI_INT, &lead_partner, 1, MPI_INT, 0, *my_comm);
+  MPI_Scatter(lead_partner_ids, 1, MPI_INT, &lead_partner, 1, MPI_INT, 0, *an->my_comm);
   for (i=0; i<followers; i++)
-     MPI_Scatter(follow_partner_ids[i], 1, MPI_INT, &follow_partners[i], 1, MPI_INT, 0, *my_comm);
+     MPI_Scatter(follow_partner_ids[i], 1, MPI_INT, &follow_partners[i], 1, MPI_INT, 0, *an->my_comm);
   /* The reason we do it this way is because MPI_Scatter(&follow_partner_ids[0][0], followers,...)
    * would assign followers sequentially. That is, proc 1 gets [0][0]->[0][followers] as its 
    * followers, proc 2 gets [0][followers]->that address+followers (may go into [1][0]) and so on.
@@ -1891,9 +2058,9 @@ void DoGlobalMix(void)
       follow_partners[i], MPI_COMM_WORLD);
     }
         MPI_Wait(&msg_request, &msg_status);
-        AcceptGlobalLamMsg(&recvbuf, size);
-        AcceptLamMsg(&recvbuf, size);
-        AcceptStateMsg(&recvbuf);
+        AcceptGlobalLamMsg(an, &recvbuf, size);
+        AcceptLamMsg(an, &recvbuf, size);
+        AcceptStateMsg(an, &recvbuf);
         MPI_Free_mem(recvbuf);
       }  
   else{
@@ -1912,10 +2079,10 @@ void DoGlobalMix(void)
   
   MPI_Free_mem(follow_partner_ids);
   /* We need all processes to have finished reading from windows */
-  MPI_Free_mem(sendbuf);
+  free(sendbuf);
     }
 
-void DoLocalMix(void)
+void DoLocalMix(Annealer *an)
 {
   int    i;                                                /* loop counter */
 
@@ -1946,14 +2113,14 @@ void DoLocalMix(void)
   MPI_Request   request;           /* handle array for receiving messages */
 
    
-    AssignDancePartner(lam_group_size, *my_comm, exp((estimate_mean-energy)*S));
+    AssignDancePartner(an, lam_group_size, *an->my_comm, exp((an->estimate_mean-an->energy)*an->S));
 /* get move state from move(s).c and collect local Lam stats for sending */
-  MakeStateMsg(&sendbuf, padding, &size);
-  MakeLamMsg(&sendbuf, size);
+  MakeStateMsg(an, &sendbuf, padding, &size);
+  MakeLamMsg(an, &sendbuf, size);
 
 /* if I'm not dancing with myself: receive new state and Lam stats         */
   
-  if (dance_partner[my_group_id] != my_group_id) {
+  if (an->dance_partner[an->my_group_id] != an->my_group_id) {
 
 /* allocate receive buffers for message; receive buffers need to be of the *
  * same length as the sending buffers                                        */
@@ -1964,16 +2131,16 @@ void DoLocalMix(void)
  * waiting to receive to send out its message while waiting i.e. we post   *
  * the receive now, check for reception after send (using MPI_Waitall)     */
 
-      MPI_Irecv(recvbuf, size+sizeof(double), MPI_BYTE, dance_partner[my_group_id],
-		dance_partner[my_group_id], *my_comm, &request);
+      MPI_Irecv(recvbuf, size+sizeof(double), MPI_BYTE, an->dance_partner[an->my_group_id],
+		an->dance_partner[an->my_group_id], *an->my_comm, &request);
   } 
 
 /* send messages to dance partners, if requested */
 
   
   for (i=0; i<lam_group_size; i++) 
-    if ( (dance_partner[i] == my_group_id) && (i != my_group_id) ) {
-      MPI_Send(sendbuf, (size+sizeof(double)),MPI_BYTE, i, my_group_id, *my_comm);
+    if ( (an->dance_partner[i] == an->my_group_id) && (i != an->my_group_id) ) {
+      MPI_Send(sendbuf, (size+sizeof(double)),MPI_BYTE, i, an->my_group_id, *an->my_comm);
     } 
      
   
@@ -1981,38 +2148,269 @@ void DoLocalMix(void)
  * collect the three messages we need to receive; then we install the move *
  * state in move(s).c and the Lam stats in lsa.c                           */
 
-  if (dance_partner[my_group_id] != my_group_id) { 
+  if (an->dance_partner[an->my_group_id] != an->my_group_id) { 
     MPI_Wait(&request,&status);
-    AcceptStateMsg(&recvbuf);
-    AcceptLamMsg(&recvbuf, size);            
+    AcceptStateMsg(an, &recvbuf);
+    AcceptLamMsg(an, &recvbuf, size);            
     MPI_Free_mem(recvbuf);
   }
 
   
 /* clean up message buffers and MPI arrays ... */
 
-  MPI_Free_mem(sendbuf);
+  free(sendbuf);
 /* ... and the probability array */
 
     }
 
-void DoMix(void){
-  count_mix++;
+/*** TeamDancePartner: AssignDancePartner for the chains of team t (of ***
+ *                     size members, the chain being member 'rank'): the  *
+ *                     same roulette (or pick of the lowest score on over- *
+ *                     flow), with the scores gathered in shared memory;   *
+ *                     returns the member that 'rank' is to follow         *
+ ***************************************************************************/
 
-  if (count_mix % glob_interval){
-    DoLocalMix();
+static int TeamDancePartner(Annealer *an, Team *t, int rank, int size,
+                            double score)
+{
+  double scores[TEAM_MAX];
+  double norm = 0.;
+  double min  = DBL_MAX;
+  double theirprob, psum;
+  int    overflow;
+  int    i, k;
+
+  TeamAllgather(t, rank, &score, scores, sizeof(double));
+  for (k=0; k<size; k++)
+    norm += scores[k];
+
+/* each chain decides on overflow for itself, like in AssignDancePartner() */
+
+  overflow = (score >= DBL_MIN) && (norm >= DBL_MAX || norm <= 1e-300);
+  for (k=0; k<size; k++)
+    if ( scores[k] < DBL_MIN )
+      scores[k] = DBL_MIN;
+
+  i = size;
+  if ( !overflow ) {
+    theirprob = size > 1 ? RandomReal() : 0.;  /* as in the serial case */
+    psum = 0.;
+    for (i=0; i<size; i++) {
+      psum += scores[i] / norm;
+      if ( psum > theirprob )
+        break;
+    }
+  } else {
+    for (k=0; k<size; k++)
+      if ( scores[k] < min ) {
+        i   = k;
+        min = scores[k];
+      }
+  }
+  if ( i < 0 || i >= size )
+    i = 0;
+
+  TeamAllgather(t, rank, &i, an->dance_partner, sizeof(int));
+  return an->dance_partner[rank];
+}
+
+/*** DoTeamLocalMix: DoLocalMix for a group of threads: they all pack ****
+ *                   their messages, and those who dance with someone else *
+ *                   read that one's message straight from its buffer      *
+ ***************************************************************************/
+
+static void DoTeamLocalMix(Annealer *an)
+{
+  unsigned char *sendbuf;
+  unsigned char *bufs[TEAM_MAX];          /* the send buffers of the team */
+  unsigned char *recvbuf;
+  MPI_Aint      padding = LSTAT_LENGTH*sizeof(double);
+  MPI_Aint      size;
+  int           partner;
+
+  partner = TeamDancePartner(an, an->group, an->my_group_id, lam_group_size,
+                             exp((an->estimate_mean-an->energy)*an->S));
+  MakeStateMsg(an, &sendbuf, padding, &size);
+  MakeLamMsg(an, &sendbuf, size);
+  TeamAllgather(an->group, an->my_group_id, &sendbuf, bufs,
+                sizeof(unsigned char *));
+
+  if ( partner != an->my_group_id ) {
+    recvbuf = bufs[partner];
+    AcceptStateMsg(an, &recvbuf);
+    AcceptLamMsg(an, &recvbuf, size);
+  }
+
+  TeamBarrier(an->group, an->my_group_id); /* nobody reads sendbuf any more */
+  free(sendbuf);
+}
+
+/*** DoTeamGlobalMix: DoGlobalMix for hybrid mode, where each rank is a ****
+ *                    group: thread 0 picks the rank to follow as in Do-   *
+ *                    GlobalMix, then sends the messages of all its chains *
+ *                    in one go to the ranks that follow it, and gets      *
+ *                    those of its lead; chain t takes over the state of   *
+ *                    chain t of the lead                                  *
+ ***************************************************************************/
+
+static void DoTeamGlobalMix(Annealer *an)
+{
+  unsigned char *sendbuf;
+  unsigned char *bufs[TEAM_MAX];          /* the send buffers of the team */
+  unsigned char *pack;               /* ... copied into one for sending */
+  unsigned char *recvbuf = NULL;        /* the lead's, if it isn't us */
+  unsigned char *mine;
+  double        energies[TEAM_MAX];
+  double        score = 0.;
+  double        min_score;
+  MPI_Aint      padding = (LSTAT_LENGTH + GSTAT_LENGTH)*sizeof(double);
+  MPI_Aint      size;
+  MPI_Aint      msg_size;
+  int           root_id;
+  int           lead;
+  int           i;
+  MPI_Request   request;
+  MPI_Status    status;
+
+/* score based on average energy, as in DoGlobalMix */
+
+  TeamAllgather(an->team, an->thread, &an->energy, energies, sizeof(double));
+  for (i=0; i<nthreads; i++)
+    score += energies[i];
+  score /= nthreads;
+
+  MakeStateMsg(an, &sendbuf, padding, &size);
+  MakeGlobalLamMsg(an, &sendbuf, size);
+  MakeLamMsg(an, &sendbuf, size);
+  msg_size = size + padding;
+  TeamAllgather(an->team, an->thread, &sendbuf, bufs, sizeof(unsigned char *));
+
+  if ( an->thread == 0 ) {
+    MPI_Allreduce(&score, &min_score, 1, MPI_DOUBLE, MPI_MIN, root_comm);
+    AssignDancePartner(an, ngroups, root_comm, exp((min_score-score)*an->S));
+    MPI_Comm_rank(root_comm, &root_id);
+    lead = an->dance_partner[root_id];
+
+    pack = (unsigned char *)malloc(nthreads*msg_size);
+    if ( !pack )
+      error("DoTeamGlobalMix: could not allocate the mix messages");
+    for (i=0; i<nthreads; i++)
+      memcpy(pack + i*msg_size, bufs[i], msg_size);
+
+    if ( lead != root_id ) {
+      MPI_Alloc_mem(nthreads*msg_size, MPI_INFO_NULL, &recvbuf);
+      MPI_Irecv(recvbuf, nthreads*msg_size, MPI_BYTE, lead, root_id,
+                root_comm, &request);
+    }
+    for (i=0; i<ngroups; i++)
+      if ( i != root_id && an->dance_partner[i] == root_id )
+        MPI_Send(pack, nthreads*msg_size, MPI_BYTE, i, i, root_comm);
+    if ( lead != root_id )
+      MPI_Wait(&request, &status);
+    free(pack);
+  }
+  TeamBcast(an->team, an->thread, &recvbuf, sizeof(unsigned char *), 0);
+
+  if ( recvbuf ) {
+    mine = recvbuf + an->thread*msg_size;
+    AcceptGlobalLamMsg(an, &mine, size);
+    AcceptLamMsg(an, &mine, size);
+    AcceptStateMsg(an, &mine);
+  }
+
+  TeamBarrier(an->team, an->thread);    /* all done reading the buffers */
+  if ( an->thread == 0 && recvbuf )
+    MPI_Free_mem(recvbuf);
+  free(sendbuf);
+}
+
+/*** DoThreadGlobalMix: DoGlobalMix for the groups of threads of a run of *
+ *                      one process: the roots pick the group to follow as *
+ *                      in DoGlobalMix, then chain t of each group takes   *
+ *                      over the state of chain t of the group it follows  *
+ ***************************************************************************/
+
+static void DoThreadGlobalMix(Annealer *an)
+{
+  unsigned char *sendbuf;
+  unsigned char *bufs[TEAM_MAX];       /* the send buffers of all chains */
+  unsigned char *recvbuf;
+  double        energies[TEAM_MAX];
+  double        means[TEAM_MAX];               /* of each group's chains */
+  double        min_score = DBL_MAX;
+  MPI_Aint      padding = (LSTAT_LENGTH + GSTAT_LENGTH)*sizeof(double);
+  MPI_Aint      size;
+  int           group = an->thread / lam_group_size;
+  int           lead;
+  int           g, i;
+
+/* score based on average energy, as in DoGlobalMix; all chains work out   *
+ * the means of all groups, in the same order, so they agree on min_score */
+
+  TeamAllgather(an->team, an->thread, &an->energy, energies, sizeof(double));
+  for (g=0; g<thread_groups; g++) {
+    means[g] = 0.;
+    for (i=0; i<lam_group_size; i++)
+      means[g] += energies[g*lam_group_size + i];
+    means[g] /= lam_group_size;
+    if ( means[g] < min_score )
+      min_score = means[g];
+  }
+
+  if ( an->my_group_id == 0 )
+    lead = TeamDancePartner(an, roots, group, thread_groups,
+                            exp((min_score-means[group])*an->S));
+  TeamBcast(an->group, an->my_group_id, &lead, sizeof(int), 0);
+
+  MakeStateMsg(an, &sendbuf, padding, &size);
+  MakeGlobalLamMsg(an, &sendbuf, size);
+  MakeLamMsg(an, &sendbuf, size);
+  TeamAllgather(an->team, an->thread, &sendbuf, bufs, sizeof(unsigned char *));
+
+  if ( lead != group ) {
+    recvbuf = bufs[lead*lam_group_size + an->my_group_id];
+    AcceptGlobalLamMsg(an, &recvbuf, size);
+    AcceptLamMsg(an, &recvbuf, size);
+    AcceptStateMsg(an, &recvbuf);
+  }
+
+  TeamBarrier(an->team, an->thread);    /* all done reading the buffers */
+  free(sendbuf);
+}
+
+void DoMix(Annealer *an){
+  an->count_mix++;
+
+  if (an->count_mix % glob_interval){
+    if ( nthreads > 1 )
+      DoTeamLocalMix(an);
+    else
+      DoLocalMix(an);
   }
   else{
     /* checks if some group is frozen, and if so returns. */
-    MPI_Allreduce(&local_frozen, &tot_frozen, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-    if (tot_frozen >0 ){
+    if ( nthreads > 1 ) {
+      an->tot_frozen = TeamSumInt(an->team, an->thread, nthreads,
+                                  an->local_frozen);
+      if ( an->thread == 0 )
+        MPI_Allreduce(MPI_IN_PLACE, &an->tot_frozen, 1, MPI_INT, MPI_SUM,
+                      MPI_COMM_WORLD);
+      TeamBcast(an->team, an->thread, &an->tot_frozen, sizeof(int), 0);
+    } else
+      MPI_Allreduce(&an->local_frozen, &an->tot_frozen, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (an->tot_frozen >0 ){
       return;
     }
-    DoGlobalMix();
+    if ( thread_groups > 1 )
+      DoThreadGlobalMix(an);
+    else if ( nthreads > 1 )
+      DoTeamGlobalMix(an);
+    else
+      DoGlobalMix(an);
   }
 }
 
-void AssignDancePartner(int nodesInMix, MPI_Comm comm, double score){
+void AssignDancePartner(Annealer *an, int nodesInMix, MPI_Comm comm, double score){
 
   int    i;                                                /* loop counter */
 
@@ -2035,7 +2433,7 @@ void AssignDancePartner(int nodesInMix, MPI_Comm comm, double score){
 /* initialize probability & dance partner arrays */
 
   for (i=0; i<nodesInMix; i++) {
-    dance_partner[i] = 0;       /* static to lsa.c since needed for tuning */
+    an->dance_partner[i] = 0;       /* static to lsa.c since needed for tuning */
     node_prob[i]     = 0.;
   }
 
@@ -2108,74 +2506,74 @@ void AssignDancePartner(int nodesInMix, MPI_Comm comm, double score){
   if (i<0|| i >= nodesInMix){
     i=0;
   }
-  MPI_Allgather(&i, 1, MPI_INT, dance_partner, 1, MPI_INT, comm);
+  MPI_Allgather(&i, 1, MPI_INT, an->dance_partner, 1, MPI_INT, comm);
   if ( logging_mix )
-    WriteMixLog(node_prob, dance_partner);
+    WriteMixLog(an, node_prob, an->dance_partner);
   free(node_prob);
 }
 
 /*** MakeLamMsg: packages local Lam stats into send buffer *****************
  ***************************************************************************/
 
-void MakeLamMsg(unsigned char **sendbuf, MPI_Aint size)
+void MakeLamMsg(Annealer *an, unsigned char **sendbuf, MPI_Aint size)
 {
   /* See message under MakeGlobalLamMsg - SRV 2025-11-15 */
-  memcpy(*sendbuf+size, &energy, sizeof(double));
+  memcpy(*sendbuf+size, &an->energy, sizeof(double));
 }
 
-void MakeGlobalLamMsg(unsigned char **sendbuf, MPI_Aint size){
+void MakeGlobalLamMsg(Annealer *an, unsigned char **sendbuf, MPI_Aint size){
   /* All of this is neccessary to reduce number * 
    * of messages being sent. Method before did  *
    * not work for heterogenous arrays so now we *
    * get to do some caveman memory shit.        *
    * SRV 2025-11-15                             */
     unsigned char *globbuf = *sendbuf + size + LSTAT_LENGTH * sizeof(double);
-    memcpy(globbuf   , &S, sizeof(double));
+    memcpy(globbuf   , &an->S, sizeof(double));
     globbuf+=sizeof(double);
 
-    memcpy(globbuf, &estimate_mean, sizeof(double));
+    memcpy(globbuf, &an->estimate_mean, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &estimate_sd, sizeof(double));
+    memcpy(globbuf, &an->estimate_sd, sizeof(double));
     globbuf+=sizeof(double);
 
-    memcpy(globbuf, &usyy, sizeof(double));
+    memcpy(globbuf, &an->usyy, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &usxy, sizeof(double));
+    memcpy(globbuf, &an->usxy, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &usy, sizeof(double));
+    memcpy(globbuf, &an->usy, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &usx, sizeof(double));
+    memcpy(globbuf, &an->usx, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &usxx, sizeof(double));
+    memcpy(globbuf, &an->usxx, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &usum, sizeof(double));
+    memcpy(globbuf, &an->usum, sizeof(double));
     globbuf+=sizeof(double);
 
-    memcpy(globbuf, &A, sizeof(double));
+    memcpy(globbuf, &an->A, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &B, sizeof(double));
+    memcpy(globbuf, &an->B, sizeof(double));
     globbuf+=sizeof(double);
 
 
-    memcpy(globbuf, &vsyy, sizeof(double));
+    memcpy(globbuf, &an->vsyy, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &vsxy, sizeof(double));
+    memcpy(globbuf, &an->vsxy, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &vsy, sizeof(double));
+    memcpy(globbuf, &an->vsy, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &vsx, sizeof(double));
+    memcpy(globbuf, &an->vsx, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &vsxx, sizeof(double));
+    memcpy(globbuf, &an->vsxx, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &vsum, sizeof(double));
+    memcpy(globbuf, &an->vsum, sizeof(double));
     globbuf+=sizeof(double);
 
-    memcpy(globbuf, &D, sizeof(double));
+    memcpy(globbuf, &an->D, sizeof(double));
     globbuf+=sizeof(double);
-    memcpy(globbuf, &E, sizeof(double));
+    memcpy(globbuf, &an->E, sizeof(double));
     globbuf+=sizeof(double);
 
-    memcpy(globbuf, &acc_ratio, sizeof(double));
+    memcpy(globbuf, &an->acc_ratio, sizeof(double));
     globbuf+=sizeof(double);
   }
 
@@ -2183,61 +2581,61 @@ void MakeGlobalLamMsg(unsigned char **sendbuf, MPI_Aint size){
 /*** AcceptLamMsg: receives new energy and Lam stats upon mixing ***********
  ***************************************************************************/
 
-void AcceptLamMsg(unsigned char **recvbuf, MPI_Aint size)
+void AcceptLamMsg(Annealer *an, unsigned char **recvbuf, MPI_Aint size)
 {
-  memcpy(&energy, *recvbuf+size, sizeof(double));
+  memcpy(&an->energy, *recvbuf+size, sizeof(double));
 
 }
 #ifdef MPI
-void AcceptGlobalLamMsg(unsigned char**recvbuf, MPI_Aint size){
+void AcceptGlobalLamMsg(Annealer *an, unsigned char**recvbuf, MPI_Aint size){
   unsigned char *globbuf=*recvbuf + size + LSTAT_LENGTH*sizeof(double);
 
-  memcpy(&S, globbuf, sizeof(double));
+  memcpy(&an->S, globbuf, sizeof(double));
   globbuf += sizeof(double);
 
-  memcpy(&estimate_mean, globbuf, sizeof(double));
+  memcpy(&an->estimate_mean, globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&estimate_sd  , globbuf, sizeof(double));
+  memcpy(&an->estimate_sd  , globbuf, sizeof(double));
   globbuf += sizeof(double);
 
-  memcpy(&usyy, globbuf, sizeof(double));
+  memcpy(&an->usyy, globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&usxy, globbuf, sizeof(double));
+  memcpy(&an->usxy, globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&usy , globbuf, sizeof(double));
+  memcpy(&an->usy , globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&usx , globbuf, sizeof(double));
+  memcpy(&an->usx , globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&usxx, globbuf, sizeof(double));
+  memcpy(&an->usxx, globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&usum, globbuf, sizeof(double));
+  memcpy(&an->usum, globbuf, sizeof(double));
   globbuf += sizeof(double);
   
-  memcpy(&A   , globbuf, sizeof(double));
+  memcpy(&an->A   , globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&B   , globbuf, sizeof(double));
+  memcpy(&an->B   , globbuf, sizeof(double));
   globbuf += sizeof(double);
     
   
-  memcpy(&vsyy, globbuf, sizeof(double));
+  memcpy(&an->vsyy, globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&vsxy, globbuf, sizeof(double));
+  memcpy(&an->vsxy, globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&vsy , globbuf, sizeof(double));
+  memcpy(&an->vsy , globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&vsx , globbuf, sizeof(double));
+  memcpy(&an->vsx , globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&vsxx, globbuf, sizeof(double));
+  memcpy(&an->vsxx, globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&vsum, globbuf, sizeof(double));
+  memcpy(&an->vsum, globbuf, sizeof(double));
   globbuf += sizeof(double);
   
-  memcpy(&D   , globbuf, sizeof(double));
+  memcpy(&an->D   , globbuf, sizeof(double));
   globbuf += sizeof(double);
-  memcpy(&E   , globbuf, sizeof(double));
+  memcpy(&an->E   , globbuf, sizeof(double));
   globbuf += sizeof(double);
 
-  memcpy(&acc_ratio , globbuf, sizeof(double));
+  memcpy(&an->acc_ratio , globbuf, sizeof(double));
   globbuf += sizeof(double);
   }
 
@@ -2254,7 +2652,7 @@ void AcceptGlobalLamMsg(unsigned char**recvbuf, MPI_Aint size){
  *             Chu's thesis, p. 63)                                        *
  ***************************************************************************/
 
-void DoTuning(void)
+void DoTuning(Annealer *an)
 {
   int    i,j,k,l;                                         /* loop counters */
 
@@ -2282,13 +2680,13 @@ void DoTuning(void)
   for (j=0; j<sub_tune_interval; j++) {
     var = 0.;
     for (k=0; k<sample_size; k++)
-      var += dev[j*sample_size+k]*dev[j*sample_size+k];
+      var += an->dev[j*sample_size+k]*an->dev[j*sample_size+k];
     var /= sample_size;
     for (k=0; k<sample_size; k++) 
       if ( var > 0.0 ) 
-	dev[j*sample_size+k] /= sqrt(var);
+	an->dev[j*sample_size+k] /= sqrt(var);
       else 
-	dev[j*sample_size+k] /= DBL_MIN;     /* not quite right, but close */
+	an->dev[j*sample_size+k] /= DBL_MIN;     /* not quite right, but close */
   }
 
 /***************************************************************************
@@ -2296,12 +2694,12 @@ void DoTuning(void)
  * processors                                                              *
  ***************************************************************************/
 	
-  MPI_Allgather(dev, sample_size*sub_tune_interval, MPI_DOUBLE, 
-		tot_dev, sample_size*sub_tune_interval, MPI_DOUBLE,
+  MPI_Allgather(an->dev, sample_size*sub_tune_interval, MPI_DOUBLE, 
+		an->tot_dev, sample_size*sub_tune_interval, MPI_DOUBLE,
 		MPI_COMM_WORLD);
   
-  MPI_Allgather(means, sample_size*sub_tune_interval, MPI_DOUBLE, 
-		tot_means, sample_size*sub_tune_interval, MPI_DOUBLE, 
+  MPI_Allgather(an->means, sample_size*sub_tune_interval, MPI_DOUBLE, 
+		an->tot_means, sample_size*sub_tune_interval, MPI_DOUBLE, 
 		MPI_COMM_WORLD);
 
 /* the following stuff is done for each sample over the sub_tune_inteval */
@@ -2317,10 +2715,10 @@ void DoTuning(void)
 
     for (j=0; j<nnodes; j++) 
       for (k=0; k<sample_size; k++) {
-	coll_dev[j*sample_size+k] =
-	  tot_dev[j*sub_tune_interval*sample_size + i*sample_size + k];
-	coll_means[j*sample_size+k] =
-	  tot_means[j*sub_tune_interval*sample_size + i*sample_size + k];
+	an->coll_dev[j*sample_size+k] =
+	  an->tot_dev[j*sub_tune_interval*sample_size + i*sample_size + k];
+	an->coll_means[j*sample_size+k] =
+	  an->tot_means[j*sub_tune_interval*sample_size + i*sample_size + k];
       }
 
    
@@ -2337,18 +2735,18 @@ void DoTuning(void)
     ncorrel = 0;
     for (j=1; j<nnodes; j++)           /* loop through all combinations of */
       for (k=0; k<j; k++)                                    /* processors */
-	if (dance_partner[j] == dance_partner[k])
+	if (an->dance_partner[j] == an->dance_partner[k])
 	  for (l=0; l<sample_size; l++) { 
 	    correl += 
-	      coll_dev[j*sample_size+l] *
-	      coll_dev[k*sample_size+l];
+	      an->coll_dev[j*sample_size+l] *
+	      an->coll_dev[k*sample_size+l];
 	    ncorrel++;
 	  }	       
     
     if (ncorrel > 0)             /* only divide if anything was calculated */
       correl /= (double)ncorrel;
     
-    cross_correl[count_tune*sub_tune_interval+i] += correl;
+    an->cross_correl[an->count_tune*sub_tune_interval+i] += correl;
 	    
 /* For the upper bound of M: ***********************************************
  * here we calculate the variance of the local mean for the current sample *
@@ -2362,36 +2760,36 @@ void DoTuning(void)
     var_l_mean = 0.;
     
     for (j=0; j<covar_sample; j++) 
-      avg_l_mean += coll_means[j];
+      avg_l_mean += an->coll_means[j];
     avg_l_mean /= (double)covar_sample;
     
     for (j=0; j<covar_sample; j++) {
       if ( avg_l_mean == 0.0 )       
-	coll_means[j] = 
-	  (coll_means[j] - DBL_MIN) / DBL_MIN;
+	an->coll_means[j] = 
+	  (an->coll_means[j] - DBL_MIN) / DBL_MIN;
       else
-	coll_means[j] = 
-	  (coll_means[j] - avg_l_mean) / avg_l_mean;
-      var_l_mean += coll_means[j] * coll_means[j];
+	an->coll_means[j] = 
+	  (an->coll_means[j] - avg_l_mean) / avg_l_mean;
+      var_l_mean += an->coll_means[j] * an->coll_means[j];
     }
     var_l_mean /= (double)covar_sample;
     
-    var_means[count_tune*sub_tune_interval+i] += var_l_mean;
+    an->var_means[an->count_tune*sub_tune_interval+i] += var_l_mean;
 
   }
     
 /* we're done with this sub_tune_interval: on to the next one */
 
-  count_tune++;
+  an->count_tune++;
 
 /* if we're at a tune_interval: reset the count_tune counter */
 
-  if ( count_tune == write_tune_stat )
-    count_tune = 0;
+  if ( an->count_tune == write_tune_stat )
+    an->count_tune = 0;
 
 /* restart the moves counter */
 
-  moves_tune = 0;
+  an->moves_tune = 0;
 
 }
 
@@ -2413,7 +2811,7 @@ void DoTuning(void)
  *                M from tuning.                                           *
  ***************************************************************************/
 
-void WriteTuning(void)
+void WriteTuning(Annealer *an)
 {
   int    i,j;                                             /* loop counters */
 
@@ -2454,7 +2852,7 @@ void WriteTuning(void)
 
     for (i=0; i<tune_interval; i++)
       fprintf(lbptr, "   %6d   %11.8f\n", 
-	      tau_count[i], cross_correl[i]/(double)count_mix);
+	      tau_count[i], an->cross_correl[i]/(double)an->count_mix);
     
     fclose(lbptr);
   
@@ -2465,13 +2863,13 @@ void WriteTuning(void)
 
     long_avg = 0.;
     for (i=0; i<tune_interval; i++) 
-      long_avg += cross_correl[i];
+      long_avg += an->cross_correl[i];
     long_avg /= (double)tune_interval;
     
     for (i=0; i<tune_interval; i++) 
-      if (cross_correl[i] <= long_avg) {
+      if (an->cross_correl[i] <= long_avg) {
 	fprintf(mbptr, "       %4d   %6d   %11.8f", 
-		count_mix, tau_count[i], cross_correl[i]/(double)count_mix);
+		an->count_mix, tau_count[i], an->cross_correl[i]/(double)an->count_mix);
 	break;
       }
 
@@ -2486,14 +2884,14 @@ void WriteTuning(void)
 
 /* here we evaluate min and max value of var_means over the whole interval */
 
-  min = var_means[0]/(double)count_mix; 
+  min = an->var_means[0]/(double)an->count_mix; 
   max = -DBL_MIN;                  
   for (i=0; i<tune_interval; i++) {
-    if ( (var_means[i]/(double)count_mix) > max )
-      max = var_means[i]/(double)count_mix; 
+    if ( (an->var_means[i]/(double)an->count_mix) > max )
+      max = an->var_means[i]/(double)an->count_mix; 
     if ( myid == 0 )
       fprintf(ubptr, "   %6d   %11.8f\n", 
-	      tau_count[i], var_means[i]/(double)count_mix);
+	      tau_count[i], an->var_means[i]/(double)an->count_mix);
   }
 
   if ( myid == 0 )
@@ -2510,14 +2908,14 @@ void WriteTuning(void)
     midpoint = i + tuning_group_size/2;
     sum = 0.;
     for (j=0; j<tuning_group_size; j++)
-      sum += var_means[i+j];
-    avg = sum / ((double)tuning_group_size * (double)count_mix);
+      sum += an->var_means[i+j];
+    avg = sum / ((double)tuning_group_size * (double)an->count_mix);
       
     if ( fabs( (avg-min)/(max-min) ) >= 0.07 )
       break;
   }
 
-  midpoints[count_mix-1] = midpoint;
+  an->midpoints[an->count_mix-1] = midpoint;
 
   if ( myid == 0 ) {
     fprintf(mbptr, "   %6d   %11.8f\n", midpoint, avg);
@@ -2526,7 +2924,7 @@ void WriteTuning(void)
 
 /* reset the sample counter */
 
-  count_sample = 0;
+  an->count_sample = 0;
 
 }
 	    
@@ -2537,7 +2935,7 @@ void WriteTuning(void)
  *               applies and returns true if that's the case               *
  ***************************************************************************/
 
-int StopTuning(void)
+int StopTuning(Annealer *an)
 {
   int    i;                                                /* loop counter */
 
@@ -2549,8 +2947,8 @@ int StopTuning(void)
 /* calculate average upper bound for the last 'stop_tune_count' mixes */
 
   avg = 0.;
-  for (i=count_mix-stop_tune_count; i<count_mix; i++) 
-    avg += (double)midpoints[i];
+  for (i=an->count_mix-stop_tune_count; i<an->count_mix; i++) 
+    avg += (double)an->midpoints[i];
   avg /= (double)stop_tune_count; 
 
 /* check if any upper bound is further than tol_tune away from that avg */
@@ -2558,8 +2956,8 @@ int StopTuning(void)
   if ( avg == 0 )
     error("StopTuning: average midpoint was zero!!?!\n");
   else 
-    for (i=count_mix-stop_tune_count; i<count_mix; i++)
-      if ( (fabs((double)midpoints[i] - avg) / avg) >= tol_tune) 
+    for (i=an->count_mix-stop_tune_count; i<an->count_mix; i++)
+      if ( (fabs((double)an->midpoints[i] - avg) / avg) >= tol_tune) 
 	return 0;                             /* if yes, return 'false' */
 
 /* if we're done: write a message into the log file and quit */
@@ -2592,7 +2990,7 @@ int StopTuning(void)
  *             erature fixed for an equilibration run                      *
  ***************************************************************************/
 
-void FixTLoop(void)
+void FixTLoop(Annealer *an)
 {
   int    i;                                               /* loop counters */
 #ifndef MPI
@@ -2706,7 +3104,7 @@ void FixTLoop(void)
 
 #ifdef MPI
 
-  count_mix = 0; /* we need to reset this counter, since it's needed below */
+  an->count_mix = 0; /* we need to reset this counter, since it's needed below */
 
 #endif
 
@@ -2716,28 +3114,15 @@ void FixTLoop(void)
 
 /* randomize initial state; throw out results; DO NOT PARALLELIZE! */
 /* CURRENTLY NON-FUNCTIONAL: FIX THIS BEFORE USING EQUIL */
-    energy_change = GenerateMove();
-    
-/* Metropolis stuff here; we usually want FORBIDDEN_MOVE to be very large  *
- * that's why we want to prevent overflows here (hence the 'if')           */
-
-    if ( energy_change != FORBIDDEN_MOVE )
-      exp_arg = -S * energy_change; 
-
-/* MIN_DELTA provides a min. probability with which any move is accepted */
-
-    if( exp_arg <= MIN_DELTA )
-      exp_arg = MIN_DELTA;    
+    energy_change = GenerateMove(an);
     
 /* below, we apply the Metropolis criterion to accept or reject a move */
 
-    if ( energy_change == FORBIDDEN_MOVE ) { 
-      RejectMove();
-    } else if ((energy_change <= 0.0) || (exp(exp_arg) > RandomReal()) ) {
-      energy += energy_change;
-      AcceptMove();
+    if ( Metropolis(an, energy_change) ) {
+      an->energy += energy_change;
+      AcceptMove(an);
     } else {
-      RejectMove();
+      RejectMove(an);
     }
 
   }
@@ -2748,31 +3133,18 @@ void FixTLoop(void)
 
 /* make a move: will either return the energy change or FORBIDDEN_MOVE */
 
-    energy_change = GenerateMove();
-
-/* Metropolis stuff here; we usually want FORBIDDEN_MOVE to be very large  *
- * that's why we want to prevent overflows here (hence the 'if')           */
-
-     if ( energy_change != FORBIDDEN_MOVE )
-      exp_arg = -S * energy_change;      
-
-/* MIN_DELTA provides a min. probability with which any move is accepted */
-
-    if(exp_arg <= MIN_DELTA ) 
-      exp_arg = MIN_DELTA;    
+    energy_change = GenerateMove(an);
 
 /* below, we apply the Metropolis criterion to accept or reject a move */
 
-    if (energy_change == FORBIDDEN_MOVE)
-      RejectMove();
-    else if ((energy_change <= 0.0) || (exp(exp_arg) > RandomReal())) {
-      energy += energy_change;
-      AcceptMove();
+    if ( Metropolis(an, energy_change) ) {
+      an->energy += energy_change;
+      AcceptMove(an);
       if (landscape) {
-       WriteLandscape(landscapefile,i,energy_change);}
+       WriteLandscape(an, landscapefile,i,energy_change);}
     }
     else
-      RejectMove();
+      RejectMove(an);
 
 #ifdef MPI
 
@@ -2782,7 +3154,7 @@ void FixTLoop(void)
 
     if ( i % (state->tune.mix_interval*proc_tau) == 0 ) {
 
-      energy_storage[count_mix] = energy;
+      energy_storage[an->count_mix] = an->energy;
 
 /* here we mix; since temperature does not change, we don't need to mix    *
  * Lam stats but only current energies and move state                      */
@@ -2791,7 +3163,7 @@ void FixTLoop(void)
  * DoMix. This issue caused count_mix to go up in intervals of 2           *
  * instead of 1                                                            */
 
-      DoMix();
+      DoMix(an);
 
     }
 
@@ -2799,7 +3171,7 @@ void FixTLoop(void)
 
 /* serial code: collect energies at every step */
 
-    energy_storage[i] = energy;
+    energy_storage[i] = an->energy;
 
 #endif
 
@@ -2811,10 +3183,10 @@ void FixTLoop(void)
 /* parallel code: pool all energies from all nodes into tot_energy array   *
  * and average them                                                        */
 
-  MPI_Allreduce(energy_storage, tot_energy, (count_mix-1), MPI_DOUBLE, 
+  MPI_Allreduce(energy_storage, tot_energy, (an->count_mix-1), MPI_DOUBLE, 
 	        MPI_SUM, MPI_COMM_WORLD);
 
-  for ( i=0; i<(count_mix-1); i++ )
+  for ( i=0; i<(an->count_mix-1); i++ )
     tot_energy[i] /= nnodes;
 
 /* ... then calculate statistics and write them to files */
@@ -2848,17 +3220,17 @@ void FixTLoop(void)
 /* calculate overall energy average */
 
 #ifdef MPI
-  for (i=0; i < (count_mix-1); i++)
+  for (i=0; i < (an->count_mix-1); i++)
 #else
   for (i=0; i <= equil_param.fix_T_step; i++)
 #endif
-    fix_T_avg += energy_storage[i];
-  fix_T_avg /= equil_param.fix_T_step;
+    an->fix_T_avg += energy_storage[i];
+  an->fix_T_avg /= equil_param.fix_T_step;
 
 /* initialize variables */
 
-  tmp1 = (energy_storage[0]-fix_T_avg)*(energy_storage[0]-fix_T_avg);
-  tmp2 = energy_storage[0]-fix_T_avg;
+  tmp1 = (energy_storage[0]-an->fix_T_avg)*(energy_storage[0]-an->fix_T_avg);
+  tmp2 = energy_storage[0]-an->fix_T_avg;
   instant_avg = energy_storage[0];
 
 /* print captions */
@@ -2873,31 +3245,31 @@ void FixTLoop(void)
 /* calculate and print local variances here */
 
 #ifdef MPI
-  for(i=1; i < (count_mix-1); i++) {
+  for(i=1; i < (an->count_mix-1); i++) {
 #else
   for(i=1; i <= equil_param.fix_T_step; i++) {
 #endif
 
     instant_avg += energy_storage[i];
 
-    tmp1    += (energy_storage[i]-fix_T_avg)*(energy_storage[i]-fix_T_avg);
-    tmp2    += (energy_storage[i]-fix_T_avg);
+    tmp1    += (energy_storage[i]-an->fix_T_avg)*(energy_storage[i]-an->fix_T_avg);
+    tmp2    += (energy_storage[i]-an->fix_T_avg);
     var_sum += (tmp1 - tmp2*tmp2/(i+1)) / i;
 
-    fix_T_var = var_sum / (i+1);
+    an->fix_T_var = var_sum / (i+1);
 
 /* print variances and averages every 1000 steps or when finished */
 
 #ifdef MPI
     if ( !(i % 10) ) {
       fprintf(lvarptr,"%8d %12.5E   %12.5E   %12.5E\n",
-              i, fix_T_var, instant_avg/(i+1), fix_T_avg);
+              i, an->fix_T_var, instant_avg/(i+1), an->fix_T_avg);
       fflush(lvarptr);
     }
 #else
     if ( !(i % 1000) || (i == equil_param.fix_T_step) ) {
       fprintf(varptr,"%8d %12.5E   %12.5E   %12.5E\n",
-              i, fix_T_var, instant_avg/(i+1), fix_T_avg);
+              i, an->fix_T_var, instant_avg/(i+1), an->fix_T_avg);
       fflush(varptr);
     }
 #endif
@@ -2910,14 +3282,14 @@ void FixTLoop(void)
 /* calculate global overall energy average */
 
   var_sum = 0.0;
-  for (i=0; i < (count_mix-1); i++)
-    pfix_T_avg += tot_energy[i];
-  pfix_T_avg /= (count_mix-1);
+  for (i=0; i < (an->count_mix-1); i++)
+    an->pfix_T_avg += tot_energy[i];
+  an->pfix_T_avg /= (an->count_mix-1);
 
 /* initialize variables */
 
-  tmp1 = (tot_energy[0]-pfix_T_avg)*(tot_energy[0]-pfix_T_avg);
-  tmp2 = tot_energy[0]-pfix_T_avg;
+  tmp1 = (tot_energy[0]-an->pfix_T_avg)*(tot_energy[0]-an->pfix_T_avg);
+  tmp2 = tot_energy[0]-an->pfix_T_avg;
   instant_avg = tot_energy[0]; 
 
 /* print captions */
@@ -2929,20 +3301,20 @@ void FixTLoop(void)
 
 /* calculate and print global variances here */
 
-  for (i=1; i<(count_mix-1); i++) {
+  for (i=1; i<(an->count_mix-1); i++) {
 
     instant_avg += tot_energy[i];
 
-    tmp1 += (tot_energy[i]-pfix_T_avg)*(tot_energy[i]-pfix_T_avg);
-    tmp2 += (tot_energy[i]-pfix_T_avg);
+    tmp1 += (tot_energy[i]-an->pfix_T_avg)*(tot_energy[i]-an->pfix_T_avg);
+    tmp2 += (tot_energy[i]-an->pfix_T_avg);
     var_sum += (tmp1 - tmp2*tmp2/(i+1)) / i;
 
-    pfix_T_var = var_sum / (i+1);
+    an->pfix_T_var = var_sum / (i+1);
 
     if ( myid == 0 ) {
       if( !(i % 10) && ( myid == 0) ) {
         fprintf(varptr,"%8d %12.5E   %12.5E   %12.5E\n",
-                i, pfix_T_var, instant_avg/(i+1), pfix_T_avg);
+                i, an->pfix_T_var, instant_avg/(i+1), an->pfix_T_avg);
         fflush(varptr);
       }
     }
@@ -2967,7 +3339,7 @@ void FixTLoop(void)
     gamma[i] = 0.0;
     for (j=0; j<=ntemp; j++)
       gamma[i] += 
-	(energy_storage[j+h[i]]-fix_T_avg)*(energy_storage[j]-fix_T_avg);
+	(energy_storage[j+h[i]]-an->fix_T_avg)*(energy_storage[j]-an->fix_T_avg);
     gamma[i] /= equil_param.fix_T_step;
  
     rho[i] = gamma[i] / gamma[0];
@@ -2995,7 +3367,7 @@ void FixTLoop(void)
   free(rho);
 #endif
 
-  FinalMove();
+  FinalMove(an);
   return;
 
 } 
@@ -3013,14 +3385,14 @@ void SetEquilibrate(ChuParam ep)
 /*** GetEquil: returns the results of an equilibration run *****************
  ***************************************************************************/
 
-void GetEquil(double *equil_var)
+void GetEquil(Annealer *an, double *equil_var)
 {
 #ifdef MPI
-  equil_var[0] = pfix_T_var;
-  equil_var[1] = pfix_T_avg;
+  equil_var[0] = an->pfix_T_var;
+  equil_var[1] = an->pfix_T_avg;
 #else
-  equil_var[0] = fix_T_var;
-  equil_var[1] = fix_T_avg;
+  equil_var[0] = an->fix_T_var;
+  equil_var[1] = an->fix_T_avg;
 #endif
 }
 
@@ -3057,51 +3429,51 @@ void InitLandscape(int value, char *file)
  *                store Lam statistics in a state file                     *
  ***************************************************************************/
 
-double *GetLamstats(void)
+double *GetLamstats(Annealer *an)
 {
   double *stats;
 
   stats = (double *)calloc(31, sizeof(double));
 
-  stats[0] = (double)counter;
+  stats[0] = (double)an->counter;
 
-  stats[1]  = old_mean;
-  stats[2]  = energy;
+  stats[1]  = an->old_mean;
+  stats[2]  = an->energy;
 
-  stats[3]  = mean;
-  stats[4]  = vari;
+  stats[3]  = an->mean;
+  stats[4]  = an->vari;
 
-  stats[5]  = estimate_mean;
-  stats[6]  = estimate_sd;
+  stats[5]  = an->estimate_mean;
+  stats[6]  = an->estimate_sd;
 
-  stats[7]  = S;
-  stats[8]  = dS;
-  stats[9]  = S_0;
+  stats[7]  = an->S;
+  stats[8]  = an->dS;
+  stats[9]  = an->S_0;
 
-  stats[10] = alpha;
-  stats[11] = acc_ratio;
+  stats[10] = an->alpha;
+  stats[11] = an->acc_ratio;
 
-  stats[12] = w_b;
-  stats[13] = vsyy;
-  stats[14] = vsxy;
-  stats[15] = vsxx;
-  stats[16] = vsx;
-  stats[17] = vsy;
-  stats[18] = vsum;
-  stats[19] = D;
-  stats[20] = E;
+  stats[12] = an->w_b;
+  stats[13] = an->vsyy;
+  stats[14] = an->vsxy;
+  stats[15] = an->vsxx;
+  stats[16] = an->vsx;
+  stats[17] = an->vsy;
+  stats[18] = an->vsum;
+  stats[19] = an->D;
+  stats[20] = an->E;
 
-  stats[21] = w_a;
-  stats[22] = usyy;
-  stats[23] = usxy;
-  stats[24] = usxx;
-  stats[25] = usx;
-  stats[26] = usy;
-  stats[27] = usum;
-  stats[28] = A;
-  stats[29] = B;
+  stats[21] = an->w_a;
+  stats[22] = an->usyy;
+  stats[23] = an->usxy;
+  stats[24] = an->usxx;
+  stats[25] = an->usx;
+  stats[26] = an->usy;
+  stats[27] = an->usum;
+  stats[28] = an->A;
+  stats[29] = an->B;
 
-  stats[30] = (double)count_tau;
+  stats[30] = (double)an->count_tau;
 
   return(stats);
 }
@@ -3169,45 +3541,45 @@ void SetOutname(char *outname)
  *                    file.                                                *
  ***************************************************************************/
 
-void RestoreLamstats(double *stats)
+void RestoreLamstats(Annealer *an, double *stats)
 {
-  counter = (int)rint(stats[0]);
-
-  old_mean      = stats[1];
-  energy        = stats[2];
-  mean          = stats[3];
-  vari          = stats[4];
-
-  estimate_mean = stats[5];
-  estimate_sd   = stats[6];
-
-  S             = stats[7];
-  dS            = stats[8];
-  S_0           = stats[9];
-  alpha         = stats[10];
-  acc_ratio     = stats[11];
-
-  w_b           = stats[12];
-  vsyy          = stats[13];
-  vsxy          = stats[14];
-  vsxx          = stats[15];
-  vsx           = stats[16];
-  vsy           = stats[17];
-  vsum          = stats[18];
-  D             = stats[19];
-  E             = stats[20];
-
-  w_a           = stats[21];
-  usyy          = stats[22];
-  usxy          = stats[23];
-  usxx          = stats[24];
-  usx           = stats[25];
-  usy           = stats[26];
-  usum          = stats[27];
-  A             = stats[28];
-  B             = stats[29];
-
-  count_tau = (long)rint(stats[30]);
+  an->counter = (int)rint(stats[0]);
+
+  an->old_mean      = stats[1];
+  an->energy        = stats[2];
+  an->mean          = stats[3];
+  an->vari          = stats[4];
+
+  an->estimate_mean = stats[5];
+  an->estimate_sd   = stats[6];
+
+  an->S             = stats[7];
+  an->dS            = stats[8];
+  an->S_0           = stats[9];
+  an->alpha         = stats[10];
+  an->acc_ratio     = stats[11];
+
+  an->w_b           = stats[12];
+  an->vsyy          = stats[13];
+  an->vsxy          = stats[14];
+  an->vsxx          = stats[15];
+  an->vsx           = stats[16];
+  an->vsy           = stats[17];
+  an->vsum          = stats[18];
+  an->D             = stats[19];
+  an->E             = stats[20];
+
+  an->w_a           = stats[21];
+  an->usyy          = stats[22];
+  an->usxy          = stats[23];
+  an->usxx          = stats[24];
+  an->usx           = stats[25];
+  an->usy           = stats[26];
+  an->usum          = stats[27];
+  an->A             = stats[28];
+  an->B             = stats[29];
+
+  an->count_tau = (long)rint(stats[30]);
 
   free(stats);
 }
@@ -3237,7 +3609,7 @@ void RestoreTimes(double *delta)
 /*** RestoreLog: restores the .log (and the .llog files) upon restart ******
  ***************************************************************************/
 
-void RestoreLog(void)
+void RestoreLog(Annealer *an)
 {
   char   *shell_cmd;                             /* used by 'system' below */
   char   *outfile;                           /* temporary output file name */
@@ -3260,7 +3632,7 @@ void RestoreLog(void)
 
 /* this is the last line we've written into the .log file */
 
-  max_saved_count = state->tune.initial_moves+proc_init+count_tau*proc_tau;
+  max_saved_count = state->tune.initial_moves+proc_init+an->count_tau*proc_tau;
 
   logline   = (char *)calloc(MAX_RECORD, sizeof(char));
   shell_cmd = (char *)calloc(MAX_RECORD, sizeof(char));
@@ -3400,7 +3772,7 @@ void RestoreLog(void)
  *              the entire landscape or only the accepted landscape *
  ***************************************************************************/
 
-void WriteLandscape(char *landfile, int iteration, double delta_energy)
+void WriteLandscape(Annealer *an, char *landfile, int iteration, double delta_energy)
 {
   const char *format =
     "  %9d %14.6f  %10.6e %16.6f %16.6f %5.2f \n";
@@ -3412,8 +3784,8 @@ void WriteLandscape(char *landfile, int iteration, double delta_energy)
       file_error("WriteLandscape");
     fprintf(landptr, format, 
 	    iteration, 
-	    1.0/S, 1.0/dS, energy, delta_energy,
-	    acc_ratio);
+	    1.0/an->S, 1.0/an->dS, an->energy, delta_energy,
+	    an->acc_ratio);
     fclose( landptr );
 
 }
@@ -3424,19 +3796,22 @@ void WriteLandscape(char *landfile, int iteration, double delta_energy)
  *             (if -l is chosen).                                          *
  ***************************************************************************/
 
-void WriteLog(void)
+void WriteLog(Annealer *an)
 {
   FILE   *logptr;                      /* file pointer for global log file */
 
 #ifdef MPI
   FILE   *l_logptr;             /* file pointer for local log file (.llog) */
 
+  if ( an->thread != 0 )               /* hybrid mode: chain 0 logs the rank */
+    return;
+
   if (myid == 0) {
 #endif
     logptr = fopen(logfile, "a");   /* first write to the global .log file */
     if ( !logptr ) 
       file_error("WriteLog");
-    PrintLog(logptr, 0);
+    PrintLog(an, logptr, 0);
     fclose( logptr );
 
 #ifdef MPI  
@@ -3446,7 +3821,7 @@ void WriteLog(void)
     l_logptr = fopen(l_logfile, "a");   /* then do the same for .llog file */
     if ( !l_logptr )
       file_error("WriteLog");
-    PrintLog(l_logptr, 1);
+    PrintLog(an, l_logptr, 1);
     fclose( l_logptr );
   }
 
@@ -3454,7 +3829,7 @@ void WriteLog(void)
 #endif
   
     if ( log_flag ) {                        /* display log to the screen? */
-      PrintLog(stdout, 0);
+      PrintLog(an, stdout, 0);
       fflush( stdout );
     }
     
@@ -3465,15 +3840,45 @@ void WriteLog(void)
 }
 
 
+/*** WriteLogComment: appends a line of free text (e.g. end of run stats **
+ *                    from the move generator) to the global .log file and *
+ *                    to stdout (if -l is chosen); only the root node      *
+ *                    writes, and nothing is written if there is no log    *
+ ***************************************************************************/
+
+void WriteLogComment(char *comment)
+{
+  FILE   *logptr;                      /* file pointer for global log file */
+
+  if ( equil || bench || nofile_flag )
+    return;
+#ifdef MPI
+  if ( myid != 0 )
+    return;
+#endif
+
+  logptr = fopen(logfile, "a");
+  if ( !logptr )
+    file_error("WriteLogComment");
+  fprintf(logptr, "%s\n", comment);
+  fclose(logptr);
+
+  if ( log_flag ) {
+    printf("%s\n", comment);
+    fflush(stdout);
+  }
+}
+
+
 /*** PrintLog: actually prints the log to wherever it needs to be printed **
  ***************************************************************************/
 
-void PrintLog(FILE *outptr, int local_flag)
+void PrintLog(Annealer *an, FILE *outptr, int local_flag)
 {
   const char *format =
     "  %10ld %14.6f  %10.6e %16.6f %16.6f %16.6f %16.6f %5.2f %8.5f\n";
 
-  if ( count_tau % (print_freq * captions) == 0 ) {
+  if ( an->count_tau % (print_freq * captions) == 0 ) {
     fprintf(outptr, 
 	    "\n iterations              T          dS/S            meanE");
     fprintf(outptr, 
@@ -3485,17 +3890,17 @@ void PrintLog(FILE *outptr, int local_flag)
 #ifdef MPI
   if ( local_flag ) {
     fprintf(outptr, format, 
-	    (state->tune.initial_moves+proc_init+count_tau*proc_tau), 
-	    1.0/S, dS/S, 
-	    l_mean, sqrt(l_vari), l_estimate_mean_u, l_estimate_sd, 
-	    l_acc_ratio, l_alpha);
+	    (state->tune.initial_moves+proc_init+an->count_tau*proc_tau), 
+	    1.0/an->S, an->dS/an->S, 
+	    an->l_mean, sqrt(an->l_vari), an->l_estimate_mean_u, an->l_estimate_sd, 
+	    an->l_acc_ratio, an->l_alpha);
   } else {
 #endif
     fprintf(outptr, format, 
-	    (state->tune.initial_moves+proc_init+count_tau*proc_tau), 
-	    1.0/S, dS/S, 
-	    mean, sqrt(vari), estimate_mean, estimate_sd, 
-	    acc_ratio, alpha);
+	    (state->tune.initial_moves+proc_init+an->count_tau*proc_tau), 
+	    1.0/an->S, an->dS/an->S, 
+	    an->mean, sqrt(an->vari), an->estimate_mean, an->estimate_sd, 
+	    an->acc_ratio, an->alpha);
 #ifdef MPI
   }    
 #endif
@@ -3506,7 +3911,7 @@ void PrintLog(FILE *outptr, int local_flag)
  * probability of being chosen, and dance_partner at each mix interval.       */
 
 
-void WriteMixLog(double *node_prob, int* dance_partner)
+void WriteMixLog(Annealer *an, double *node_prob, int* dance_partner)
 {
 
 #ifdef MPI
@@ -3529,38 +3934,38 @@ void WriteMixLog(double *node_prob, int* dance_partner)
   if(MPI_COMM_NULL != root_comm){
     MPI_Comm_rank(root_comm, &root_id);
   }
-  MPI_Bcast(&root_id, 1, MPI_INT, 0, *my_comm);
+  MPI_Bcast(&root_id, 1, MPI_INT, 0, *an->my_comm);
   MPI_Gather(&root_id, 1, MPI_INT, global_group_ids, 1, MPI_INT, 0, MPI_COMM_WORLD);
-  if (count_mix % glob_interval){ // if local mix
-    MPI_Gather(&node_prob[my_group_id], 1, MPI_DOUBLE, global_node_prob, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather(&dance_partner[my_group_id],1,MPI_INT, global_dance_partner, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (an->count_mix % glob_interval){ // if local mix
+    MPI_Gather(&node_prob[an->my_group_id], 1, MPI_DOUBLE, global_node_prob, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Gather(&dance_partner[an->my_group_id],1,MPI_INT, global_dance_partner, 1, MPI_INT, 0, MPI_COMM_WORLD);
     global_mix=0;
   }
 
   else{ // if global mix 
-    MPI_Bcast(&node_prob[root_id], 1, MPI_INT, 0, *my_comm);
-    MPI_Bcast(&dance_partner[root_id],1,MPI_INT,0,*my_comm);
+    MPI_Bcast(&node_prob[root_id], 1, MPI_INT, 0, *an->my_comm);
+    MPI_Bcast(&dance_partner[root_id],1,MPI_INT,0,*an->my_comm);
     MPI_Gather(&node_prob[root_id], 1, MPI_DOUBLE, global_node_prob, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
     MPI_Gather(&dance_partner[root_id], 1, MPI_INT, global_dance_partner,1, MPI_INT, 0, MPI_COMM_WORLD);
     global_mix=1;
   }
-  MPI_Gather(&estimate_mean, 1, MPI_DOUBLE, global_estimate_means, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Gather(&an->estimate_mean, 1, MPI_DOUBLE, global_estimate_means, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
 
   /*Collect data about energy */
-  MPI_Gather(&energy,1,MPI_DOUBLE,energies,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+  MPI_Gather(&an->energy,1,MPI_DOUBLE,energies,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
   if (myid == 0) {
 
     mixlogptr = fopen(mixlogfile, "a"); /*write to mixlog */
     if ( !mixlogptr )
       file_error("WriteMixLog");
-    if ( count_mix == 1 ){
+    if ( an->count_mix == 1 ){
        fprintf(mixlogptr,"\n iterations  global mix      ");
        for (i = 0; i<nnodes; i++)
         fprintf(mixlogptr, "Node %3d group:     Node %3d (e)meanE     Node %3d Energy:      Node %3d Probability:     Node %3d Choice:    ",
             i, i, i ,i, i);
        fprintf(mixlogptr,"\n");
     }
-    fprintf(mixlogptr,"%9d       %d            ", (state->tune.initial_moves+proc_init+count_tau*proc_tau), global_mix);
+    fprintf(mixlogptr,"%9d       %d            ", (state->tune.initial_moves+proc_init+an->count_tau*proc_tau), global_mix);
     for (i = 0; i<nnodes; i++)
       fprintf(mixlogptr, "      %2d           %16.6f      %16.6f           %1.6f                    %2d            ",
           global_group_ids[i],          
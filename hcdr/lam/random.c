@@ -8,8 +8,8 @@
  *                                                               *
  *****************************************************************
  *                                                               *
- *   functions for initializing and running erand48() random     *
- *   number generator                                            *
+ *   functions for initializing and running the random number    *
+ *   generator                                                   *
  *                                                               *
  *****************************************************************
  *                                                               *
@@ -18,103 +18,390 @@
  *                                                               *
  *****************************************************************/
 
+#include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <random.h>
 
-/* following to toggle between random number generators ********************
- * USE_... constants are defined in random.h or need to be specified using *
- * -D with the compiler; using any random number generator other than      *
- * erand48() is not supported and makes results hard to reproduce; it      *
- * should work fine though if you DO NOT RESTART RUNS FROM .state FILES    *
- * WHEN USING RANDOM NUMBER GENERATORS OTHER THAN ERAND48()                *
- ***************************************************************************/
+/* the generator is chosen at compile time (see random.h): Philox4x32-10 *
+ * by default, erand48() with -DUSE_ERAND48; both hand out their draws   *
+ * from a buffer that RandomRefill fills RAND_BUFFER draws at a time     */
 
-/* #ifdef USE_DRAND48
-  double drand48(); 
-  long   lrand48();
-  void   srand48(); 
-#elif USE_ERAND48 
-  double erand48(); 
-  #endif  */          
+#ifdef USE_ERAND48
+#define LOWBITS    0x330E        /* for drand (32 bits) to erand (48 bits) */
+#define BYTESIZE   8                                        /* compatibility */
+#else
+#define PHILOX_M0  0xD2511F53U                /* Philox4x32 multipliers */
+#define PHILOX_M1  0xCD9E8D57U
+#define PHILOX_W0  0x9E3779B9U                /* and key increments     */
+#define PHILOX_W1  0xBB67AE85U
+#endif
 
 
 /* STATIC VARIABLES ********************************************************/
-/* an array needed by erand48 */
+
+/* SRV 2026-10-17: each thread (chain) draws from a generator of its own; */
+/* the ziggurats below are shared, made by the first InitRandom           */
+
+static __thread RandState rs;  /* the state (as of the first draw in the */
+                                                                /* buffer) */
 
 #ifdef USE_ERAND48
-static unsigned short xsubj[3];        /* array used to initialize erand48 */
+static __thread unsigned short xsubj[3];   /* where erand48 has got to */
 #endif
 
+static __thread double rand_buf[RAND_BUFFER]; /* the draws, in order of use */
 
+/* the ziggurats of RandomExp and RandomNormal (SRV 2026-10-17): layer i  *
+ * is x[i] wide, layer 0 being the base strip with the tail beyond x[1] = *
+ * r; f[i] is the density (without its norm) at x[i]; the layers are made *
+ * once, by ZigInit, from r and the area v of each layer                  */
 
+#define ZIG_EXP_R   7.69711747013104972     /* for 256 layers: where the */
+#define ZIG_EXP_V   3.949659822581572e-3    /* tail starts, layer area   */
+#define ZIG_NOR_R   3.6541528853610088
+#define ZIG_NOR_V   4.92867323399e-3
 
-/*** RANDOM NUMBER FUNCTIONS ***********************************************/
+static double zig_exp_x[ZIG_LAYERS+1], zig_exp_f[ZIG_LAYERS+1];
+static double zig_nor_x[ZIG_LAYERS+1], zig_nor_f[ZIG_LAYERS+1];
+static int    zig_made = 0;
 
-/*** InitERand: initializes ERand by making xsubj static to random.c *******
+static void ZigInit(void);
+
+
+
+/*** THE GENERATOR *********************************************************/
+
+/*** RandomRefill: fills rand_buf with the RAND_BUFFER draws starting at ***
+ *                 rs; a Philox block of 128 bits makes two draws of 53    *
+ *                 bits each; Philox4x32-10 is 10 rounds that multiply two *
+ *                 words of the counter (32 x 32 -> 64 bits) and xor the   *
+ *                 halves into the other two words and the key, done here  *
+ *                 a round at a time for all blocks so that it vectorizes  *
  ***************************************************************************/
 
-void InitERand(unsigned short xsubi[3])
+static void RandomRefill(void)
 {
-    int       i;
+  int      i;
+#ifdef USE_ERAND48
+  for (i=0; i<3; i++)
+    xsubj[i] = (unsigned short)rs.ctr[i];
+  for (i=0; i<RAND_BUFFER; i++)
+    rand_buf[i] = erand48(xsubj);
+#else
+  uint32_t c0[RAND_BUFFER/2], c1[RAND_BUFFER/2];     /* the counters of */
+  uint32_t c2[RAND_BUFFER/2], c3[RAND_BUFFER/2];     /* all the blocks  */
+  uint32_t k0 = rs.key[0], k1 = rs.key[1];
+  uint64_t block, p0, p1;
+  uint32_t t;
+  int      r;
 
-    for(i=0; i<3; i++)
-	xsubj[i] = xsubi[i];
+  block = ((uint64_t)rs.ctr[1] << 32) | rs.ctr[0];
 
-    free(xsubi);  /* temporarily crashed for lorraine 1-19-03 */
+  for (i=0; i<RAND_BUFFER/2; i++) {
+    c0[i] = (uint32_t)(block + i);
+    c1[i] = (uint32_t)((block + i) >> 32);
+    c2[i] = rs.ctr[2];
+    c3[i] = rs.ctr[3];
+  }
+
+  for (r=0; r<10; r++) {
+    for (i=0; i<RAND_BUFFER/2; i++) {
+      p0    = (uint64_t)PHILOX_M0 * c0[i];
+      p1    = (uint64_t)PHILOX_M1 * c2[i];
+      t     = (uint32_t)(p1 >> 32) ^ c1[i] ^ k0;
+      c2[i] = (uint32_t)(p0 >> 32) ^ c3[i] ^ k1;
+      c0[i] = t;
+      c1[i] = (uint32_t)p1;
+      c3[i] = (uint32_t)p0;
+    }
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+
+  for (i=0; i<RAND_BUFFER/2; i++) {
+    rand_buf[2*i]   = (double)((((uint64_t)c0[i] << 32) | c1[i]) >> 11)
+                      * (1. / 9007199254740992.);               /* 2^-53 */
+    rand_buf[2*i+1] = (double)((((uint64_t)c2[i] << 32) | c3[i]) >> 11)
+                      * (1. / 9007199254740992.);
+  }
+#endif
+  rs.pos = 0;
 }
-  
 
+/*** RandomAdvance: moves rs on to the draws after the buffer ***************
+ ***************************************************************************/
 
-/*** RandomReal: returns a random real number between 0 and 1 using the  **
- *               random number generator of choice                        *
- **************************************************************************/
+static void RandomAdvance(void)
+{
+#ifdef USE_ERAND48
+  int      i;
 
-double RandomReal(void)
+  for (i=0; i<3; i++)
+    rs.ctr[i] = xsubj[i];
+#else
+  uint64_t block;
+
+  block     = (((uint64_t)rs.ctr[1] << 32) | rs.ctr[0]) + RAND_BUFFER/2;
+  rs.ctr[0] = (uint32_t)block;
+  rs.ctr[1] = (uint32_t)(block >> 32);
+#endif
+}
+
+
+
+/*** RANDOM NUMBER FUNCTIONS ***********************************************/
+
+/*** InitRandom: starts stream `stream` of the generator for seed `seed`; **
+ *               streams of the same seed never overlap                    *
+ ***************************************************************************/
+
+void InitRandom(uint64_t seed, uint64_t stream)
 {
-  double i;
+  memset(&rs, 0, sizeof(rs));
 
-#ifdef USE_DRAND48  
-  i = drand48();
-#elif  USE_ERAND48
-  i = erand48(xsubj);
+#ifdef USE_ERAND48
+  seed     += stream;                      /* each stream gets its own seed */
+  rs.ctr[0] = LOWBITS;
+  rs.ctr[1] = (unsigned short)seed;
+  rs.ctr[2] = (unsigned short)(seed >> (BYTESIZE * sizeof(unsigned short)));
 #else
-  i = ((double)random()) / 2147483648.;
+  rs.key[0] = (uint32_t)seed;
+  rs.key[1] = (uint32_t)(seed >> 32);
+  rs.ctr[2] = (uint32_t)stream;
+  rs.ctr[3] = (uint32_t)(stream >> 32);
 #endif
 
-  return(i);
+  RandomRefill();
+  if ( !zig_made )               /* before any other thread draws from them */
+    ZigInit();
 }
 
 
-/*** RandomInt: returns a random integer between 0 and max using the *******
- *              random number generator of choice                          *
+
+/*** RandomReal: returns a random real number between 0 and 1 (1 not in- **
+ *               cluded) from the buffer                                  *
+ **************************************************************************/
+
+double RandomReal(void)
+{
+  if ( rs.pos == RAND_BUFFER ) {
+    RandomAdvance();
+    RandomRefill();
+  }
+  return rand_buf[rs.pos++];
+}
+
+
+/*** RandomInt: returns a random integer between 0 and max (max not in- ****
+ *              cluded) from the buffer                                    *
  ***************************************************************************/
 
 int RandomInt(int max)
 {
-  register int   i;
+  return ((int)(RandomReal() * max)) % max;
+}
+
+
+/*** RandomFill: puts the next n random reals into u, as n calls to Random-*
+ *               Real would; RandomFillInt does the same for RandomInt     *
+ ***************************************************************************/
+
+void RandomFill(double *u, int n)
+{
+  int m;                                 /* draws taken out of the buffer */
 
-#ifdef USE_DRAND48
-  i = ((int)(drand48() * max)) % max;
-#elif  USE_ERAND48
-  i = ((int)(erand48(xsubj) * max)) % max;
+  while ( n > 0 ) {
+    if ( rs.pos == RAND_BUFFER ) {
+      RandomAdvance();
+      RandomRefill();
+    }
+    m = RAND_BUFFER - rs.pos;
+    if ( m > n )
+      m = n;
+    memcpy(u, rand_buf + rs.pos, m * sizeof(double));
+    rs.pos += m;
+    u      += m;
+    n      -= m;
+  }
+}
+
+void RandomFillInt(int *k, int n, int max)
+{
+  int i;
+
+  for (i=0; i<n; i++)
+    k[i] = RandomInt(max);
+}
+
+
+/*** ZigInit: makes the layers of the two ziggurats: x[i+1] is where the **
+ *            density is v/x[i] above f(x[i]), which gives each layer the *
+ *            area v; x[0] = v/f(r) makes the base strip (tail included)  *
+ *            as big as the others                                        *
+ ***************************************************************************/
+
+static void ZigInit(void)
+{
+  int i;
+
+  zig_exp_x[0] = ZIG_EXP_V / exp(-ZIG_EXP_R);
+  zig_exp_x[1] = ZIG_EXP_R;
+  zig_nor_x[0] = ZIG_NOR_V / exp(-.5 * ZIG_NOR_R * ZIG_NOR_R);
+  zig_nor_x[1] = ZIG_NOR_R;
+  for (i=1; i<ZIG_LAYERS-1; i++) {
+    zig_exp_x[i+1] = -log(ZIG_EXP_V / zig_exp_x[i] + exp(-zig_exp_x[i]));
+    zig_nor_x[i+1] = sqrt(-2. * log(ZIG_NOR_V / zig_nor_x[i] +
+                                    exp(-.5 * zig_nor_x[i] * zig_nor_x[i])));
+  }
+  zig_exp_x[ZIG_LAYERS] = 0.;
+  zig_nor_x[ZIG_LAYERS] = 0.;
+
+  for (i=0; i<=ZIG_LAYERS; i++) {
+    zig_exp_f[i] = exp(-zig_exp_x[i]);
+    zig_nor_f[i] = exp(-.5 * zig_nor_x[i] * zig_nor_x[i]);
+  }
+  zig_made = 1;
+}
+
+
+/*** ZigExp, ZigNormal: turn the uniform u into a deviate; the top bits ***
+ *                      of u pick the layer (and the sign), the rest is   *
+ *                      where in the layer; it comes out right away un-   *
+ *                      less it lies beyond the next layer's width        *
+ *                      (about 1 in 100), then the wedge or the tail take *
+ *                      more draws                                        *
+ ***************************************************************************/
+
+static double ZigExp(double u)
+{
+  double x, base = 0.;
+  int    i;
+
+  for (;;) {
+    u *= ZIG_LAYERS;
+    i  = (int)u;
+    x  = (u - i) * zig_exp_x[i];
+    if ( x < zig_exp_x[i+1] )
+      return base + x;
+    if ( i == 0 )                        /* the tail: r plus a fresh one */
+      base += ZIG_EXP_R;
+    else if ( zig_exp_f[i+1] + RandomReal() * (zig_exp_f[i] - zig_exp_f[i+1])
+              < exp(-x) )
+      return base + x;
+    u = RandomReal();
+  }
+}
+
+static double ZigNormal(double u)
+{
+  double x, y, sign;
+  int    i, k;
+
+  for (;;) {
+    u   *= 2*ZIG_LAYERS;
+    k    = (int)u;
+    i    = k >> 1;
+    sign = 1. - 2.*(k & 1);  /* k & 1 is the sign; a branch would miss */
+    x    = (u - k) * zig_nor_x[i];                   /* half the time */
+    if ( x < zig_nor_x[i+1] )
+      return sign * x;
+    if ( i == 0 ) {               /* the tail, after Marsaglia (1964) */
+      do {
+        x = -log(1. - RandomReal()) / ZIG_NOR_R;
+        y = -log(1. - RandomReal());
+      } while ( 2.*y < x*x );
+      return sign * (ZIG_NOR_R + x);
+    }
+    if ( zig_nor_f[i+1] + RandomReal() * (zig_nor_f[i] - zig_nor_f[i+1])
+         < exp(-.5 * x * x) )
+      return sign * x;
+    u = RandomReal();
+  }
+}
+
+
+/*** RandomExp, RandomNormal: return an exponential deviate of mean 1 and *
+ *                             a normal one of mean 0 and variance 1 (zig-  *
+ *                             gurat); RandomFillExp and RandomFillNormal   *
+ *                             make n of them, from RandomFill              *
+ ***************************************************************************/
+
+double RandomExp(void)
+{
+  if ( !zig_made )
+    ZigInit();
+  return ZigExp(RandomReal());
+}
+
+double RandomNormal(void)
+{
+  if ( !zig_made )
+    ZigInit();
+  return ZigNormal(RandomReal());
+}
+
+void RandomFillExp(double *x, int n)
+{
+  int i;
+
+  if ( !zig_made )
+    ZigInit();
+  RandomFill(x, n);
+  for (i=0; i<n; i++)
+    x[i] = ZigExp(x[i]);
+}
+
+void RandomFillNormal(double *x, int n)
+{
+  int i;
+
+  if ( !zig_made )
+    ZigInit();
+  RandomFill(x, n);
+  for (i=0; i<n; i++)
+    x[i] = ZigNormal(x[i]);
+}
+
+
+/*** RandomJump: skips the next n draws, in O(1) (O(n) for erand48) *******
+ ***************************************************************************/
+
+void RandomJump(unsigned long long n)
+{
+#ifdef USE_ERAND48
+  while ( n-- )
+    RandomReal();
 #else
-  i = random() % max;
-#endif
+  uint64_t block;     /* the block to go on with: counted in blocks, not */
+  uint64_t draw;      /* in draws, which overflow past block 2^63; draw  */
+                      /* is pos plus the odd one of n, from ctr[0..1] on */
 
-  return(i);
+  draw      = (uint64_t)rs.pos + n % 2;
+  block     = (((uint64_t)rs.ctr[1] << 32) | rs.ctr[0]) + n / 2 + draw / 2;
+  rs.ctr[0] = (uint32_t)block;
+  rs.ctr[1] = (uint32_t)(block >> 32);
+  RandomRefill();
+  rs.pos    = (int)(draw % 2);
+#endif
 }
 
 
-/*** GetERandState: returns the xsubj array, which is used to initialize ***
- *                  erand48(); used for saving the erand state in a state  *
- *                  file                                                   *
+/*** GetRandomState, SetRandomState: save and restore the state of the *****
+ *                                   generator, e.g. in a state file       *
  ***************************************************************************/
 
-unsigned short *GetERandState(void)
+void GetRandomState(RandState *state)
+{
+  *state = rs;
+}
+
+void SetRandomState(const RandState *state)
 {
-    unsigned short *p;
+  int pos = state->pos;
 
-    p = xsubj;
-    return(p);
+  rs = *state;
+  RandomRefill();
+  rs.pos = pos;
 }
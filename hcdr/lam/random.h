@@ -8,44 +8,101 @@
  *                                                               *
  *****************************************************************
  *                                                               *
- *   functions for initializing and running erand48() random     *
- *   number generator                                            *
+ *   functions for initializing and running the random number    *
+ *   generator                                                   *
  *                                                               *
  *****************************************************************/
 
 #ifndef RANDOM_INCLUDED
 #define RANDOM_INCLUDED
 
-/*** A CONSTANT ************************************************************/
+#include <stdint.h>
 
-#define USE_ERAND48             1     
-       /* tells the code to use erand48 by default, use -D opt to override */
-                /* alternative is: -DUSE_DRAND48 for using drand48 instead */
+/*** CONSTANTS *************************************************************/
+
+/* SRV 2026-10-17: the generator is Philox4x32-10 (Salmon et al. 2011), a  *
+ * counter-based one: draw n of stream s for seed k is a fixed function of *
+ * (k, s, n), so every rank (thread, chain) gets a stream of its own that  *
+ * is independent of its neighbours', jumping ahead is O(1) and the state  *
+ * is a handful of words; -DUSE_ERAND48 (ERAND48=on in Makefile.tsp) goes  *
+ * back to the erand48() we used to use, with the seed + stream seeding of *
+ * old, which reproduces runs from before; it jumps ahead in O(n) though   */
+
+#define RAND_BUFFER    256       /* draws made at a time (an even number) */
+#define ZIG_LAYERS     256             /* layers of the ziggurat samplers */
+
+/*** STRUCTS ***************************************************************/
+
+/* the state of the generator, for checkpoints: the buffer is refilled    *
+ * from ctr when the state is restored, then pos draws are skipped         */
+
+typedef struct {
+  uint32_t key[2];                           /* Philox key: the seed      */
+  uint32_t ctr[4];        /* counter of the first block in the buffer:    */
+                          /* ctr[0..1] the block, ctr[2..3] the stream;   */
+                          /* erand48 keeps its xsubi in ctr[0..2] instead */
+  int      pos;                   /* draws of the buffer already used up */
+} RandState;
 
 /*** FUNCTION PROTOTYPES ***************************************************/
 
-/*** InitERand: initializes ERand by making xsubj static to lsa.c **********
+/*** InitRandom: starts stream `stream` of the generator for seed `seed`; **
+ *               streams of the same seed never overlap; rank r uses      *
+ *               stream r (see RAND_STREAM for ranks and threads)         *
  ***************************************************************************/
 
-void InitERand(unsigned short *xsubi);
+void InitRandom(uint64_t seed, uint64_t stream);
+
+#define RAND_STREAM(rank, thread)  \
+  (((uint64_t)(thread) << 32) | (uint64_t)(rank))
 
-/*** RandomReal: returns a random real number between 0 and 1 using the  **
- *              random number generator of choice                          *
+/*** RandomReal: returns a random real number between 0 and 1 (1 not in- **
+ *               cluded) from the buffer                                  *
  **************************************************************************/
 
 double RandomReal(void);
 
-/*** RandomInt: returns a random integer between 0 and max using the *******
- *              random number generator of choice                          *
+/*** RandomInt: returns a random integer between 0 and max (max not in- ****
+ *              cluded) from the buffer                                    *
  ***************************************************************************/
 
 int RandomInt(int max);
 
-/*** GetERandState: returns the xsubj array, which is used to initialize **
- *                  erand48(); used for saving the erand state in a state *
- *                  file                                                  *
- **************************************************************************/
+/*** RandomFill: puts the next n random reals into u, as n calls to Random-*
+ *               Real would; RandomFillInt does the same for RandomInt     *
+ ***************************************************************************/
+
+void RandomFill(double *u, int n);
+
+void RandomFillInt(int *k, int n, int max);
+
+/*** RandomExp, RandomNormal: return an exponential deviate of mean 1 and *
+ *                             a normal one of mean 0 and variance 1, by   *
+ *                             the ziggurat method (Marsaglia and Tsang    *
+ *                             2000); they keep no state of their own but  *
+ *                             the generator's; RandomFillExp and Random-  *
+ *                             FillNormal make n of them at a time         *
+ ***************************************************************************/
+
+double RandomExp(void);
+
+double RandomNormal(void);
+
+void RandomFillExp(double *x, int n);
+
+void RandomFillNormal(double *x, int n);
+
+/*** RandomJump: skips the next n draws, in O(1) (O(n) for erand48) *******
+ ***************************************************************************/
+
+void RandomJump(unsigned long long n);
+
+/*** GetRandomState, SetRandomState: save and restore the state of the *****
+ *                                   generator, e.g. in a state file       *
+ ***************************************************************************/
+
+void GetRandomState(RandState *state);
 
-unsigned short *GetERandState(void);
+void SetRandomState(const RandState *state);
 
 #endif
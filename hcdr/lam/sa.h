@@ -45,6 +45,7 @@
 #endif
 
 #include <stdint.h>
+#include <mpi.h>                          /* for the Annealer's communicator */
 /* following for structures & consts used thruout */
 #ifndef GLOBAL_INCLUDED
 #include <global.h>
@@ -57,6 +58,9 @@
 
 #define MIN_DELTA    -100.    /* minimum exponent for Metropolis criterion */
                     /* provides a minimum probability for really bad moves */
+#define METRO_BLOCK  256     /* Metropolis thresholds drawn at a time (SRV) */
+#define VARI_NOISE   1e-12     /* variances below this times mean^2 are the */
+                    /* rounding of <E^2> - <E>^2 on a frozen chain (SRV)  */
 
 
 
@@ -113,7 +117,7 @@ typedef struct
   double control; 
   double criterion;   
   int    mix_interval; 
-  unsigned short shmem_flag;
+  unsigned short shmem_flag;   /* threads (chains) per rank, 0 or 1 for one */
   int glob_interval;
   int ngroups;
   unsigned short score_method;
@@ -176,6 +180,142 @@ typedef enum StopStyle {
   absolute_energy     
 } StopStyle;
 
+/* The annealing chain (SRV 2026-10-17) ************************************
+ *                                                                         *
+ * everything Loop and its helpers in lsa.c change as they go lives in     *
+ * here rather than in static variables, and gets passed to them, so that  *
+ * several independent chains can anneal in one address space; the prob-  *
+ * lem keeps the state of its moves for the chain (for the TSP: the tour   *
+ * and the acceptance stats) behind 'move'; what stays static in lsa.c     *
+ * (file names, flags, tau and such) is the same for all chains            *
+ *                                                                         *
+ * the fields every move touches come first and share one cache line, the *
+ * pre-drawn Metropolis thresholds follow on lines of their own, and the   *
+ * stats that only change once per tau come after those, so a move only   *
+ * touches the lines it needs; NewAnnealer aligns it to ANNEALER_ALIGN     *
+ ***************************************************************************/
+
+#define ANNEALER_ALIGN  64             /* a cache line, on the usual CPUs */
+
+typedef struct Annealer {
+
+/* touched by every move: one cache line */
+
+  double   energy;                                       /* current energy */
+  double   S;                                    /* current inverse energy */
+  double   dS;                         /* delta S: change in S during move */
+  double   *metro_S;     /* the S the current loop anneals at (S or S_0) */
+  int      metro_next;                   /* next unused entry of metro_e */
+  void     *move;         /* the problem's move state for this chain */
+  int      thread;          /* which of the rank's threads runs it (0..) */
+  struct Team *team;      /* the rank's threads, if more than one (group.h) */
+  struct Team *group;     /* those of them in its Lam group (group.h) */
+#ifdef MPI
+  int      l_success;                  /* local number of successful moves */
+#endif
+  uint8_t  success;                          /* number of successful moves */
+
+/* the Metropolis thresholds: pre-drawn -log(u) values */
+
+  double   metro_e[METRO_BLOCK] __attribute__((aligned(ANNEALER_ALIGN)));
+
+/* Lam stats: updated once per tau */
+
+  double   mean __attribute__((aligned(ANNEALER_ALIGN)));
+                             /* mean energy, collected from tau last steps */
+  double   vari;         /* energy variance, collected from tau last steps */
+  double   estimate_mean;                 /* Lam estimator for mean energy */
+  double   estimate_sd;     /* Lam estimator for energy standard deviation */
+  double   alpha;            /* the third term of the Lam schedule formula */
+  double   acc_ratio;       /* average acceptance ratio for all parameters */
+  double   S_0;                         /* the initial inverse temperature */
+  long     count_tau;     /* how many times we did tau (or proc_tau) moves */
+  int      skip;              /* how often to update S (see lsa.c), or -1 */
+  uint16_t m_success;            /* successful moves, for UpdateControl */
+
+  double   w_a;                          /* w_a is the weight for the mean */
+  double   usyy, usxy, usxx;    /* these parameters store intermediate re- */
+  double   usx, usy, usum;    /* sults for the updating formulas for A and */
+                              /* B; see Lam & Delosme, 1988b, p10          */
+  double   A, B;       /* A and B are the parameters for the rational func- */
+                       /* tion for the estimation of the mean              */
+
+  double   w_b;            /* w_b is the weight for the standard deviation */
+  double   vsyy, vsxy, vsxx;               /* the same for D and E, which */
+  double   vsx, vsy, vsum;               /* are the parameters for the ra- */
+  double   D, E;   /* tional function for the estimation of the std dev */
+
+  double   old_mean;                       /* old mean as stored by Frozen */
+  int      counter;                              /* counter used by Frozen */
+
+  double   fix_T_avg;          /* overall energy average at fixed temp and */
+  double   fix_T_var;        /* energy variance at fixed temp (equil runs) */
+
+  MPI_Comm *my_comm;             /* communicator of the chain's Lam group */
+
+#ifdef MPI
+
+/* local Lam stats, for tuning (see the comment on local weights in lsa.c) */
+
+  double   l_mean;          /* local mean energy, from proc_tau last steps */
+  double   l_vari;      /* local energy variance, from proc_tau last steps */
+  double   l_estimate_mean_l;        /* estimator for mean for lower bound */
+  double   l_estimate_mean_u;        /* estimator for mean for upper bound */
+  double   l_estimate_sd;          /* Lam estimator for sd for upper bound */
+  double   l_alpha;          /* the third term of the Lam schedule formula */
+  double   l_acc_ratio;     /* average acceptance ratio for all parameters */
+
+  double   l_w_a_l;    /* l_w_a_l: weight for the mean for the lower bound */
+  double   l_usyy_l, l_usxy_l, l_usxx_l;        /* intermediate results for */
+  double   l_usx_l, l_usy_l, l_usum_l;           /* l_A_l and l_B_l, which */
+  double   l_A_l, l_B_l;         /* estimate the mean for the lower bound */
+
+  double   l_w_a_u;    /* l_w_a_u: weight for the mean for the upper bound */
+  double   l_usyy_u, l_usxy_u, l_usxx_u;         /* the same for the upper */
+  double   l_usx_u, l_usy_u, l_usum_u;                            /* bound */
+  double   l_A_u, l_B_u;
+
+  double   l_w_b;                            /* l_w_b: local weight for sd */
+  double   l_vsyy, l_vsxy, l_vsxx;       /* intermediate results for l_D */
+  double   l_vsx, l_vsy, l_vsum;                 /* and l_E, which estimate */
+  double   l_D, l_E;                                 /* the local std dev */
+
+/* mixing */
+
+  int      my_group_id;                          /* our rank in that group */
+  int      *dance_partner;      /* stores dance partners for each node; */
+                                /* tuning needs them after the mix too  */
+  int      count_mix;                 /* counts the times we've been mixing */
+  int      local_frozen;     /* As all groups do not communicate, each pro- */
+                             /* cessor must communicate that they are frozen */
+  int      tot_frozen;        /* this will check if all groups are frozen */
+
+  double   pfix_T_avg;              /* global energy average at fixed temp */
+  double   pfix_T_var;             /* global energy variance at fixed temp */
+
+/* tuning: counters, and arrays that sample stats for the lower bound ... */
+
+  int      count_sample;               /* how many samples did we collect? */
+  int      count_tune;               /* how many times did we do sub_tune? */
+  int      moves_tune;          /* move counter: reset every tune_interval */
+
+  double   *dev;            /* standard deviations for a sub_tune_interval */
+  double   *tot_dev;              /* gathers all local standard deviations */
+  double   *coll_dev;                /* collects local standard deviations */
+  double   *cross_correl;            /* cross-correlations for lower bound */
+
+/* ... and for the upper bound */
+
+  double   *means;             /* used to save local means for upper bound */
+  double   *tot_means;                          /* gathers all local means */
+  double   *coll_means;                            /* collects local means */
+  double   *var_means;          /* variance of local means for lower bound */
+  int      *midpoints;              /* midpoints of groups for upper bound */
+
+#endif
+
+} Annealer;
+
 
 
 
@@ -212,6 +352,16 @@ int         bench;
 int         equil; 
 int         quenchit;
 
+/* hybrid mode (SRV 2026-10-17): with shmem_flag (see ReadTune) set to T > *
+ * 1, each rank runs T chains on as many threads, which share the problem *
+ * instance and form one Lam group; their stats are pooled and their local *
+ * mixes done through shared memory (group.c), leaving MPI to the global   *
+ * mixes between ranks; a rank then counts as T processors (see lsa.c); a  *
+ * run of one process (e.g. tsp_sa.threads) splits its T threads into      *
+ * ngroups groups instead, and mixes them globally in shared memory too    */
+
+int         nthreads;                     /* threads (chains) per process */
+
 
 
 
@@ -221,12 +371,20 @@ int         quenchit;
 
 /* Initializing functions */
 
+/*** NewAnnealer: allocates a chain (aligned, all zero) and sets up what ***
+ *                does not depend on the run; FreeAnnealer frees it again  *
+ ***************************************************************************/
+
+Annealer *NewAnnealer(void);
+
+void FreeAnnealer(Annealer *an);
+
 /*** Initialize: calls ParseCommandLine first; then does either initial ****
  *               randomization and collecting Lam stats or restores state  *
  *               of the annealer as saved in the state file                *
  ***************************************************************************/
 
-void Initialize(int argc, char **argv);
+void Initialize(Annealer *an, int argc, char **argv);
 
 /*** InitFilenames: initializes static file names needed in lsa.c **********
  ***************************************************************************/
@@ -238,20 +396,20 @@ void InitFilenames(void);
  *                   2. loop for initial collection of statistics          *
  ***************************************************************************/
 
-void InitialLoop(void);
+void InitialLoop(Annealer *an);
 
 /*** InitializeParameter: initializes variables used for calculating the ***
  *                        parameters A, B, D and E and the estimate_mean   *
  *                        plus estimate_sd (see Lam & Delosme, 1988a)      *
  ***************************************************************************/
 
-void InitializeParameter(void);
+void InitializeParameter(Annealer *an);
 
 /*** InitializeWeights: initialize weights a and b; these weights are ******
  *                      computed from the lambda memory length products    *
  ***************************************************************************/
 
-void InitializeWeights(void);
+void InitializeWeights(Annealer *an);
 
 
 
@@ -261,30 +419,30 @@ void InitializeWeights(void);
  *         considered frozen according to the stop criterion               *
  ***************************************************************************/
 
-void Loop(void);
+void Loop(Annealer *an);
 
 /*** UpdateS: update inverse temperature S at every Sskip step *************
  ***************************************************************************/
 
-void UpdateS(void);
+void UpdateS(Annealer *an);
 
 /*** UpdateStats: updates mean, variance and acc_ratio after tau moves *****
  *                it needs i to do sanity check in parallel code           *
  *                No it doesn't.                                           *
  ***************************************************************************/
 
-void UpdateStats();
+void UpdateStats(Annealer *an);
 
 /*** UpdateParameter: update parameters A, B, D and E and the estimators ***
  *                    for mean and standard deviation for the current S    *
  ***************************************************************************/
 
-void UpdateParameter(void);
+void UpdateParameter(Annealer *an);
 
 /*** Frozen: returns TRUE if frozen, FALSE otherwise ***********************
  ***************************************************************************/
 
-int Frozen(void);
+int Frozen(Annealer *an);
 
 
 
@@ -294,7 +452,7 @@ int Frozen(void);
  *             erature fixed for an equilibration run                      *
  ***************************************************************************/
 
-void FixTLoop(void);
+void FixTLoop(Annealer *an);
 
 /*** SetEquilibrate: simply makes the equil_param struct static to lsa.c ***
  ***************************************************************************/
@@ -304,7 +462,7 @@ void SetEquilibrate(ChuParam ep);
 /*** GetEquil: returns the results of an equilibration run *****************
  ***************************************************************************/
 
-void GetEquil(double *equil_var);
+void GetEquil(Annealer *an, double *equil_var);
 
 
 
@@ -315,7 +473,7 @@ void GetEquil(double *equil_var);
  *                store Lam statistics in a state file                     *
  ***************************************************************************/
 
-double *GetLamstats(void);
+double *GetLamstats(Annealer *an);
 
 /*** GetTimes: returns a two-element array with the current wallclock and **
  *             user time to be saved in the state file                     * 
@@ -339,12 +497,12 @@ void SetOutname(char *outname);
  *                    file.                                                *
  ***************************************************************************/
 
-void RestoreLamstats(double *stats); 
+void RestoreLamstats(Annealer *an, double *stats); 
 
 /*** RestoreLog: restores .log and .prolix files after upon restart ********
  ***************************************************************************/
 
-void RestoreLog(void);
+void RestoreLog(Annealer *an);
 
 /*** RestoreTimes: restores the wallclock and user times if -t is used *****
  ***************************************************************************/
@@ -363,7 +521,8 @@ void RestoreTimes(double *delta);
  *              the entire landscape or only the accepted landscape      **
  ***************************************************************************/
 
-void WriteLandscape(char *landfile, int iteration, double delta_energy);
+void WriteLandscape(Annealer *an, char *landfile, int iteration,
+                    double delta_energy);
 
 /***************************************************************************  
  *** InitLandscape: sets flag for printing landscape output and acceptance**
@@ -379,12 +538,18 @@ void InitLandscape(int value, char *file);
  *             to stdout (serial).                                         *
  ***************************************************************************/
 
-void WriteLog(void);
+void WriteLog(Annealer *an);
 
 /*** PrintLog: actually writes stuff to the .log file **********************
  ***************************************************************************/
 
-void PrintLog(FILE *outptr, int local_flag);
+void PrintLog(Annealer *an, FILE *outptr, int local_flag);
+
+/*** WriteLogComment: appends a line of free text to the global .log file **
+ *                    (root node only, and only if there is a .log file)   *
+ ***************************************************************************/
+
+void WriteLogComment(char *comment);
 
 
 
@@ -406,7 +571,7 @@ int ParseCommandLine(int argc, char **argv);
  *                  are used to open the right data file etc.)             *
  *                - initializes the cost function, establishes link be-    *
  *                  tween cost function and annealer and passes the init-  *
- *                  tial energy to lsa.c by p_chisq)                       *
+ *                  tial energy and the move state to the chain an)        *
  *                - initializes move generation in move(s).c               *
  *                - sets initial energy by evaluating cost function for    * 
  *                  the first time                                         *
@@ -414,7 +579,7 @@ int ParseCommandLine(int argc, char **argv);
  ***************************************************************************/
 
 double InitialMove(int argc, char **argv, int opt_index, 
-		   NucStatePtr state_ptr, double *p_chisq);  
+		   NucStatePtr state_ptr, Annealer *an);  
 
 /*** RestoreState: called when an interrupted run is restored; does the ****
  *                 following (see InitialMove for arguments, also see co-  *
@@ -425,14 +590,22 @@ double InitialMove(int argc, char **argv, int opt_index,
  *                 - restores move state in move(s).c                      *
  ***************************************************************************/
 
-void RestoreState(char *statefile, NucStatePtr state_ptr, double *p_chisq);  
+void RestoreState(char *statefile, NucStatePtr state_ptr, Annealer *an);  
+
+/*** InitialChain: sets up the chain an that thread 'thread' (> 0) of a ****
+ *                 hybrid run anneals, once InitialMove has set up the     *
+ *                 problem and chain 0: the thread's random numbers and    *
+ *                 scratch, and the chain's moves and initial energy       *
+ ***************************************************************************/
+
+void InitialChain(Annealer *an, int thread);
 
 /*** FinalMove: determines the final energy and move count and then prints *
  *              those to wherever they need to be printed to; also should  *
  *              do the cleaning up, i.e freeing stuff and such after a run *
  ***************************************************************************/
 
-void FinalMove(void);
+void FinalMove(Annealer *an);
 
 /*** WriteTimes: writes the timing information to wherever it needs to be **
  *               written to at the end of a run                            *
@@ -449,7 +622,7 @@ void WriteTimes(double *times);
  *               and new energy to the caller                              *
  ***************************************************************************/
 
-double GenerateMove(void);
+double GenerateMove(Annealer *an);
 
 /***************************************************************************/
 /*** UpdateControl: each 'interval' number of steps, acceptance stats are **
@@ -463,18 +636,49 @@ double GenerateMove(void);
  *                  trol for each parameter individually; this function    *
  *                  also prints prolix stuff, if required (-p)             *
  ***************************************************************************/
-void UpdateControl(uint16_t *m_success);
+void UpdateControl(Annealer *an, uint16_t *m_success);
 
 /*** AcceptMove: sets new energy as the old energy for the next step and ***
  *               keeps track of the number of successful moves             *
  ***************************************************************************/
 
-void AcceptMove(void);
+void AcceptMove(Annealer *an);
 
 /*** RejectMove: simply resets the tweaked parameter to the pretweak value *
  ***************************************************************************/
 
-void RejectMove(void);
+void RejectMove(Annealer *an);
+
+/* SRV 2026-10-17: the rejection-free (n-fold way) mode for the cold end   *
+ * of a run, where Loop would mostly generate moves only to reject them:   *
+ * the problem keeps the acceptance probability of every move of a fixed  *
+ * move set, so Loop can jump straight to the next accepted move           */
+
+/*** NFoldSwitch: called before each proc_tau steps with the last acc_ratio*
+ *                and the current S; returns 1 if they should be done re-  *
+ *                jection-free, after (re)building what that needs         *
+ ***************************************************************************/
+
+int NFoldSwitch(Annealer *an, double acc_ratio, double S);
+
+/*** NFoldWait: draws the number of steps that pass (all rejected) before **
+ *              the next accepted move, from the geometric distribution    *
+ ***************************************************************************/
+
+int NFoldWait(Annealer *an);
+
+/*** NFoldMove: picks the move the wait ends with (as GenerateMove would); *
+ *              returns its energy change, to be accepted, or FORBIDDEN_   *
+ *              MOVE if it is to be rejected after all (the move set's ac- *
+ *              ceptances may be for a lower S than the current one)       *
+ ***************************************************************************/
+
+double NFoldMove(Annealer *an, double S);
+
+/*** NFoldSkip: counts nsteps steps that were spent waiting ****************
+ ***************************************************************************/
+
+void NFoldSkip(Annealer *an, int nsteps);
 
 
 
@@ -482,8 +686,8 @@ void RejectMove(void);
 /* a function that writes the .state file (should live in savestate.c) */
 
 /*** StateWrite: collects Lam statistics, move state and the state of the **
- *               erand48 random number generator and writes all that into  *
- *               the state file, which can then be used to restore the run *
+ *               random number generator and writes all that into the      *
+ *               state file, which can then be used to restore the run     *
  *               in case it gets interrupted                               *
  ***************************************************************************/
 
@@ -0,0 +1,268 @@
+/*****************************************************************
+ *                                                               *
+ *   threads/mpi.c                                               *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   written by SRV (2026-10-17)                                 *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   MPI for a single process, for tsp_sa.threads (see mpi.h)    *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ * Copyright (C) 1989-2003 John Reinitz                          *
+ * the full GPL copyright notice can be found in lsa.c           *
+ *                                                               *
+ *****************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <error.h>
+#include "mpi.h"
+
+
+/*** ENVIRONMENT ***********************************************************/
+
+int MPI_Init(int *argc, char ***argv)
+{
+  return MPI_SUCCESS;
+}
+
+int MPI_Init_thread(int *argc, char ***argv, int required, int *provided)
+{
+  *provided = MPI_THREAD_MULTIPLE;    /* we are never called concurrently */
+  return MPI_SUCCESS;
+}
+
+int MPI_Query_thread(int *provided)
+{
+  *provided = MPI_THREAD_MULTIPLE;
+  return MPI_SUCCESS;
+}
+
+int MPI_Finalize(void)
+{
+  return MPI_SUCCESS;
+}
+
+int MPI_Get_processor_name(char *name, int *len)
+{
+  if ( gethostname(name, MPI_MAX_PROCESSOR_NAME) )
+    strcpy(name, "localhost");
+  name[MPI_MAX_PROCESSOR_NAME-1] = '\0';
+  *len = strlen(name);
+  return MPI_SUCCESS;
+}
+
+double MPI_Wtime(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+}
+
+int MPI_Alloc_mem(MPI_Aint size, MPI_Info info, void *baseptr)
+{
+  *(void **)baseptr = malloc(size);
+  if ( !*(void **)baseptr )
+    error("MPI_Alloc_mem: could not allocate %d bytes", (int)size);
+  return MPI_SUCCESS;
+}
+
+int MPI_Free_mem(void *base)
+{
+  free(base);
+  return MPI_SUCCESS;
+}
+
+
+
+/*** COMMUNICATORS AND GROUPS **********************************************/
+
+int MPI_Comm_size(MPI_Comm comm, int *size)
+{
+  *size = 1;
+  return MPI_SUCCESS;
+}
+
+int MPI_Comm_rank(MPI_Comm comm, int *rank)
+{
+  *rank = 0;
+  return MPI_SUCCESS;
+}
+
+int MPI_Comm_group(MPI_Comm comm, MPI_Group *group)
+{
+  *group = 0;
+  return MPI_SUCCESS;
+}
+
+/* a group can only hold rank 0, so we are in all the communicators made */
+
+int MPI_Comm_create_group(MPI_Comm comm, MPI_Group group, int tag,
+                          MPI_Comm *newcomm)
+{
+  *newcomm = MPI_COMM_WORLD;
+  return MPI_SUCCESS;
+}
+
+int MPI_Comm_free(MPI_Comm *comm)
+{
+  *comm = MPI_COMM_NULL;
+  return MPI_SUCCESS;
+}
+
+int MPI_Group_incl(MPI_Group group, int n, const int ranks[],
+                   MPI_Group *newgroup)
+{
+  if ( n != 1 || ranks[0] != 0 )
+    error("MPI_Group_incl: there is only rank 0 in a run without MPI");
+  *newgroup = 0;
+  return MPI_SUCCESS;
+}
+
+int MPI_Group_free(MPI_Group *group)
+{
+  return MPI_SUCCESS;
+}
+
+
+
+/*** DATATYPES AND OPERATIONS **********************************************/
+
+/* a struct is as long as its last member reaches, rounded up to the size *
+ * of its widest member, as the compiler lays it out                       */
+
+int MPI_Type_create_struct(int count, const int blocklengths[],
+                           const MPI_Aint displacements[],
+                           const MPI_Datatype types[], MPI_Datatype *newtype)
+{
+  MPI_Aint end = 0;
+  int      align = 1;
+  int      i;
+
+  for (i=0; i<count; i++) {
+    if ( displacements[i] + blocklengths[i] * types[i] > end )
+      end = displacements[i] + blocklengths[i] * types[i];
+    if ( types[i] > align )
+      align = types[i];
+  }
+  *newtype = (MPI_Datatype)((end + align - 1) / align * align);
+  return MPI_SUCCESS;
+}
+
+int MPI_Type_commit(MPI_Datatype *type)
+{
+  return MPI_SUCCESS;
+}
+
+int MPI_Type_free(MPI_Datatype *type)
+{
+  return MPI_SUCCESS;
+}
+
+int MPI_Op_create(MPI_User_function *function, int commute, MPI_Op *op)
+{
+  *op = 0;                            /* one rank: nothing to combine with */
+  return MPI_SUCCESS;
+}
+
+int MPI_Op_free(MPI_Op *op)
+{
+  return MPI_SUCCESS;
+}
+
+
+
+/*** COLLECTIVES ***********************************************************/
+
+/* Copy: what every collective comes down to with one rank */
+
+static void Copy(void *to, const void *from, int count, MPI_Datatype type)
+{
+  if ( from != MPI_IN_PLACE && to != MPI_IN_PLACE && to != from )
+    memcpy(to, from, (size_t)count * type);
+}
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count,
+                  MPI_Datatype type, MPI_Op op, MPI_Comm comm)
+{
+  Copy(recvbuf, sendbuf, count, type);
+  return MPI_SUCCESS;
+}
+
+int MPI_Reduce(const void *sendbuf, void *recvbuf, int count,
+               MPI_Datatype type, MPI_Op op, int root, MPI_Comm comm)
+{
+  Copy(recvbuf, sendbuf, count, type);
+  return MPI_SUCCESS;
+}
+
+int MPI_Bcast(void *buf, int count, MPI_Datatype type, int root,
+              MPI_Comm comm)
+{
+  return MPI_SUCCESS;
+}
+
+int MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+               MPI_Comm comm)
+{
+  Copy(recvbuf, sendbuf, sendcount, sendtype);
+  return MPI_SUCCESS;
+}
+
+int MPI_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+                MPI_Comm comm)
+{
+  Copy(recvbuf, sendbuf, recvcount, recvtype);
+  return MPI_SUCCESS;
+}
+
+int MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                  MPI_Comm comm)
+{
+  Copy(recvbuf, sendbuf, sendcount, sendtype);
+  return MPI_SUCCESS;
+}
+
+int MPI_Allgatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                   void *recvbuf, const int recvcounts[], const int displs[],
+                   MPI_Datatype recvtype, MPI_Comm comm)
+{
+  if ( recvbuf != MPI_IN_PLACE )
+    Copy((char *)recvbuf + (size_t)displs[0] * recvtype, sendbuf, sendcount,
+         sendtype);
+  return MPI_SUCCESS;
+}
+
+
+
+/*** POINT TO POINT ********************************************************/
+
+int MPI_Send(const void *buf, int count, MPI_Datatype type, int dest, int tag,
+             MPI_Comm comm)
+{
+  error("MPI_Send: there is nobody to send to in a run without MPI");
+  return MPI_SUCCESS;
+}
+
+int MPI_Irecv(void *buf, int count, MPI_Datatype type, int source, int tag,
+              MPI_Comm comm, MPI_Request *request)
+{
+  error("MPI_Irecv: there is nobody to receive from in a run without MPI");
+  return MPI_SUCCESS;
+}
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status)
+{
+  return MPI_SUCCESS;
+}
@@ -0,0 +1,139 @@
+/*****************************************************************
+ *                                                               *
+ *   threads/mpi.h                                               *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   written by SRV (2026-10-17)                                 *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   MPI for a single process, for tsp_sa.threads: the part of   *
+ *   MPI that the Lam code uses, for a world of one rank, where  *
+ *   collectives are copies and nothing is ever sent; the chains *
+ *   of the run are the threads of that process, which do their  *
+ *   mixing through shared memory (see InitTeam in lsa.c)        *
+ *                                                               *
+ *   this directory comes first on the include path of the       *
+ *   threads build only, so that <mpi.h> is this file there      *
+ *                                                               *
+ *****************************************************************/
+
+#ifndef THREADS_MPI_INCLUDED
+#define THREADS_MPI_INCLUDED
+
+#include <stddef.h>
+
+/*** TYPES *****************************************************************/
+
+/* a datatype is its size in bytes, which is all a copy needs to know */
+
+typedef ptrdiff_t MPI_Aint;
+typedef int       MPI_Datatype;
+typedef int       MPI_Op;
+typedef int       MPI_Comm;
+typedef int       MPI_Group;
+typedef int       MPI_Info;
+typedef int       MPI_Request;
+
+typedef struct {
+  int MPI_SOURCE;
+  int MPI_TAG;
+  int MPI_ERROR;
+} MPI_Status;
+
+typedef void MPI_User_function(void *in, void *inout, int *len,
+                               MPI_Datatype *dtype);
+
+/*** CONSTANTS *************************************************************/
+
+#define MPI_SUCCESS             0
+#define MPI_MAX_PROCESSOR_NAME  256
+
+#define MPI_COMM_NULL           (-1)
+#define MPI_COMM_WORLD          0
+#define MPI_INFO_NULL           0
+#define MPI_IN_PLACE            ((void *)1)
+
+#define MPI_THREAD_SINGLE       0
+#define MPI_THREAD_FUNNELED     1
+#define MPI_THREAD_SERIALIZED   2
+#define MPI_THREAD_MULTIPLE     3
+
+#define MPI_BYTE                ((MPI_Datatype)1)
+#define MPI_CHAR                ((MPI_Datatype)sizeof(char))
+#define MPI_INT                 ((MPI_Datatype)sizeof(int))
+#define MPI_DOUBLE              ((MPI_Datatype)sizeof(double))
+#define MPI_UNSIGNED_LONG       ((MPI_Datatype)sizeof(unsigned long))
+#define MPI_LONG_LONG           ((MPI_Datatype)sizeof(long long))
+#define MPI_UINT8_T             ((MPI_Datatype)1)
+#define MPI_UINT16_T            ((MPI_Datatype)2)
+
+#define MPI_SUM                 ((MPI_Op)1)
+#define MPI_MIN                 ((MPI_Op)2)
+
+/*** FUNCTION PROTOTYPES ***************************************************/
+
+/* environment */
+
+int    MPI_Init(int *argc, char ***argv);
+int    MPI_Init_thread(int *argc, char ***argv, int required, int *provided);
+int    MPI_Query_thread(int *provided);
+int    MPI_Finalize(void);
+int    MPI_Get_processor_name(char *name, int *len);
+double MPI_Wtime(void);
+int    MPI_Alloc_mem(MPI_Aint size, MPI_Info info, void *baseptr);
+int    MPI_Free_mem(void *base);
+
+/* communicators and groups: there is just the one rank, rank 0 */
+
+int MPI_Comm_size(MPI_Comm comm, int *size);
+int MPI_Comm_rank(MPI_Comm comm, int *rank);
+int MPI_Comm_group(MPI_Comm comm, MPI_Group *group);
+int MPI_Comm_create_group(MPI_Comm comm, MPI_Group group, int tag,
+                          MPI_Comm *newcomm);
+int MPI_Comm_free(MPI_Comm *comm);
+int MPI_Group_incl(MPI_Group group, int n, const int ranks[],
+                   MPI_Group *newgroup);
+int MPI_Group_free(MPI_Group *group);
+
+/* datatypes and operations */
+
+int MPI_Type_create_struct(int count, const int blocklengths[],
+                           const MPI_Aint displacements[],
+                           const MPI_Datatype types[], MPI_Datatype *newtype);
+int MPI_Type_commit(MPI_Datatype *type);
+int MPI_Type_free(MPI_Datatype *type);
+int MPI_Op_create(MPI_User_function *function, int commute, MPI_Op *op);
+int MPI_Op_free(MPI_Op *op);
+
+/* collectives: the one rank's data is the result */
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count,
+                  MPI_Datatype type, MPI_Op op, MPI_Comm comm);
+int MPI_Reduce(const void *sendbuf, void *recvbuf, int count,
+               MPI_Datatype type, MPI_Op op, int root, MPI_Comm comm);
+int MPI_Bcast(void *buf, int count, MPI_Datatype type, int root,
+              MPI_Comm comm);
+int MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+               MPI_Comm comm);
+int MPI_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+                MPI_Comm comm);
+int MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                  MPI_Comm comm);
+int MPI_Allgatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                   void *recvbuf, const int recvcounts[], const int displs[],
+                   MPI_Datatype recvtype, MPI_Comm comm);
+
+/* point to point: there is nobody to talk to, so these are errors */
+
+int MPI_Send(const void *buf, int count, MPI_Datatype type, int dest, int tag,
+             MPI_Comm comm);
+int MPI_Irecv(void *buf, int count, MPI_Datatype type, int source, int tag,
+              MPI_Comm comm, MPI_Request *request);
+int MPI_Wait(MPI_Request *request, MPI_Status *status);
+
+#endif
@@ -6,12 +6,23 @@
 # Making it always parallel
 
 # objects and headers for tsp_sa serial 
-TOBJ =  edge_wt.o move.o tsp_sa.o savestate.o initialize.o\
+TOBJ =  edge_wt.o move.o tsp_sa.o savestate.o initialize.o tour_list.o \
         ../lam/distributions.o ../lam/error.o  ../lam/lsa.o ../lam/random.o
 
 # these 2 lines are for parallel tsp_sa-mpi 
-TPOBJ = edge_wt.o move-mpi.o tsp_sa-mpi.o  savestate-mpi.o initialize.o \
-				../lam/distributions.o  ../lam/lsa-mpi.o ../lam/error.o ../lam/random.o
+TPOBJ = edge_wt.o move-mpi.o tsp_sa-mpi.o  savestate-mpi.o initialize.o tour_list.o \
+				../lam/distributions.o  ../lam/lsa-mpi.o ../lam/error.o ../lam/random.o \
+				../lam/group.o
+
+# and these for tsp_sa.threads, which needs no MPI (see lam/threads/mpi.h)
+TTOBJ = edge_wt.o move-threads.o tsp_sa-threads.o savestate-threads.o \
+				initialize-threads.o tour_list.o ../lam/distributions.o \
+				../lam/lsa-threads.o ../lam/error.o ../lam/random.o ../lam/group.o \
+				../lam/threads/mpi.o
+
+# and these for check_moves, which takes in move.c and tour_list.c
+TCKOBJ = check_moves.o edge_wt.o initialize.o ../lam/distributions.o \
+				../lam/error.o ../lam/random.o ../lam/threads/mpi.o
 
 #calc_ave_error_bar
 TEBOBJ = calc_ave_error_bar.o
@@ -58,8 +69,36 @@ printscore.o: printscore.c
 printscore: $(TPSOBJ)
 	$(CC) -o printscore $(CFLAGS) $(TPSOBJ) $(LIBS)
 
+# single machine stuff
+
+tsp_sa.threads: $(TTOBJ)
+	$(THREADSCC) -o tsp_sa.threads $(THREADSFLAGS) $(TTOBJ) $(LIBS)
+
+move-threads.o: move.c
+	$(THREADSCC) -c -o move-threads.o $(THREADSFLAGS) $(CFLAGS) move.c
+
+tsp_sa-threads.o: tsp_sa.c
+	$(THREADSCC) -c -o tsp_sa-threads.o $(THREADSFLAGS) $(CFLAGS) $(VFLAGS) tsp_sa.c
+
+savestate-threads.o: savestate.c
+	$(THREADSCC) -c -o savestate-threads.o $(THREADSFLAGS) $(CFLAGS) savestate.c
+
+initialize-threads.o: initialize.c
+	$(THREADSCC) -c -o initialize-threads.o $(THREADSFLAGS) $(CFLAGS) initialize.c
+
 tsp_sa:tsp_sa.mpi
 
+# checks of the move code
+
+check: check_moves
+	./check_moves
+
+check_moves: $(TCKOBJ)
+	$(THREADSCC) -o check_moves $(THREADSFLAGS) $(TCKOBJ) $(LIBS)
+
+check_moves.o: check_moves.c move.c tour_list.c
+	$(THREADSCC) -c -o check_moves.o $(THREADSFLAGS) $(CFLAGS) check_moves.c
+
 # ... and here be the cleanup and make deps targets
 
 clean:
@@ -0,0 +1,528 @@
+/*****************************************************************
+ *                                                               *
+ *   check_moves.c                                               *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   written by SRV (2026-10-18)                                 *
+ *                                                               *
+ *****************************************************************
+ *                                                               *
+ *   checks of the move code, which 'make check' builds and runs *
+ *   on random instances; it takes move.c and tour_list.c in     *
+ *   whole, so that it can call the static move operators and    *
+ *   look into the list tour, and stands in for the parts of     *
+ *   tsp_sa.c and lsa.c that move.c calls; it prints a line per  *
+ *   check and exits with the number that failed                 *
+ *                                                               *
+ *****************************************************************/
+
+#include "move.c"
+#include "tour_list.c"
+
+#include <pthread.h>
+
+
+/*** STATIC VARIABLES ******************************************************/
+
+static MoveParms check_mp;        /* what ReadMoveParameters hands InitMoves */
+static int       nfailed = 0;                    /* checks that went wrong */
+
+
+/*** what tsp_sa.c and lsa.c give move.c in a run: the parameters are ******
+ *   the defaults of the .params file, with the moves set by check_mp      *
+ ***************************************************************************/
+
+AParms ReadAParameters(FILE *fp)
+{
+  AParms l_aparms;
+
+  memset(&l_aparms, 0, sizeof(AParms));
+  l_aparms.seed              = 1234;
+  l_aparms.start_tempr       = 5000.;
+  l_aparms.gain_div_interval = 0.1 / 100;
+  l_aparms.interval          = 100;
+  return l_aparms;
+}
+
+EdgeParms ReadEdgeParameters(FILE *fp)
+{
+  EdgeParms l_eparms;
+
+  l_eparms.neighbour_k           = NEIGHBOUR_K_DEFAULT;
+  l_eparms.neighbour_cache_bytes = 0;
+  l_eparms.distance_matrix_bytes = DIST_MATRIX_BYTES_DEFAULT;
+  l_eparms.city_order            = FILE_ORDER;
+  return l_eparms;
+}
+
+MoveParms ReadMoveParameters(FILE *fp)
+{
+  return check_mp;
+}
+
+void InitEquilibrate(FILE *fp)
+{
+}
+
+
+/*** Check: reports the check what, which passed if ok *********************
+ ***************************************************************************/
+
+static void Check(int ok, const char *what)
+{
+  printf("%s: %s\n", ok ? "ok    " : "FAILED", what);
+  if (!ok)
+    nfailed++;
+}
+
+
+/*** RandomInstance: reads an instance of n cities, uniform in the unit ****
+ *                   square times 1000, as a .tsp file would give it, in   *
+ *                   place of the one before, which it frees as FinalMove  *
+ *                   does                                                  *
+ ***************************************************************************/
+
+static void RandomInstance(int n)
+{
+  FILE *fp;
+  int   i;
+
+  FreeNeighbourTable();
+  FreeSpatialGrid();
+  FreeDistanceMatrix();
+  FreeDistances();
+  FreeCityLabels();
+  FreeCoords();
+
+  fp = tmpfile();
+  if (!fp)
+    error("RandomInstance: could not open a temporary file");
+  fprintf(fp, "NAME : check%d\nTYPE : TSP\nDIMENSION : %d\n", n, n);
+  fprintf(fp, "EDGE_WEIGHT_TYPE : EUC_2D\nNODE_COORD_SECTION\n");
+  for (i=0; i<n; i++)
+    fprintf(fp, "%d %.3f %.3f\n", i+1, 1000. * drand48(), 1000. * drand48());
+  fprintf(fp, "EOF\n");
+  rewind(fp);
+  ReadTSP(fp);
+  fclose(fp);
+}
+
+
+/*** StartMoves: sets up the moves of mparms on a random instance of n *****
+ *               cities and returns the moves of a chain on it             *
+ ***************************************************************************/
+
+static MoveContext *StartMoves(int n, MoveParms mparms, Annealer *an)
+{
+  srand48(n);
+  RandomInstance(n);
+  check_mp = mparms;
+  dev_init(1, 2.5);                            /* uniform move sizes */
+  InitMoves(NULL, 100);
+  memset(an, 0, sizeof(Annealer));
+  StartTour(an);
+  return an->move;
+}
+
+
+/*** CheckOrOptLengths: Or-opt moves, one by one and in batches, must ******
+ *                      move segments of every length from 1 to OR_OPT_MAX *
+ ***************************************************************************/
+
+static void CheckOrOptLengths(void)
+{
+  MoveParms   mparms = { 0., 1., 0, 0, 1, 0. };  /* Or-opt moves only */
+  Annealer    an;
+  MoveContext *mc;
+  int         single[OR_OPT_MAX+1], batched[OR_OPT_MAX+1];
+  int         k, b, len, ok;
+
+  mc = StartMoves(300, mparms, &an);
+  memset(single, 0, sizeof(single));
+  memset(batched, 0, sizeof(batched));
+
+  for (k=0; k<30000; k++) {
+    ProposeOrOpt(mc);
+    if (mc->or_len >= 1 && mc->or_len <= OR_OPT_MAX)
+      single[mc->or_len]++;
+    else
+      single[0]++;
+  }
+
+  mp.batch_size = 32;
+  for (k=0; k<1000; k++) {
+    FillBatch(mc);
+    for (b=0; b<mc->batch_fill; b++) {
+      len = mc->batch[b].or_len;
+      if (len >= 1 && len <= OR_OPT_MAX)
+        batched[len]++;
+      else
+        batched[0]++;
+    }
+  }
+
+  ok = !single[0];
+  for (len=1; len<=OR_OPT_MAX; len++)
+    ok = ok && single[len] > 0;
+  Check(ok, "ProposeOrOpt moves segments of 1 to OR_OPT_MAX cities");
+
+  ok = !batched[0];
+  for (len=1; len<=OR_OPT_MAX; len++)
+    ok = ok && batched[len] > 0;
+  Check(ok, "FillBatch moves Or-opt segments of 1 to OR_OPT_MAX cities");
+}
+
+
+/*** CheckNFold: after a run of accepted swaps in the rejection-free ******
+ *               mode, the rates, nfold_total and the Fenwick tree that    *
+ *               NFoldUpdate kept up to date must be those a rebuild by    *
+ *               NFoldRates gives; FenwickFind must pick the right move at *
+ *               the ends of each move's share of the total, and never a   *
+ *               move with no share, for trees of any size                 *
+ ***************************************************************************/
+
+#define NFOLD_SWAPS  5000
+
+static double FenwickSum(MoveContext *mc, int m)   /* rates before move m */
+{
+  double sum = 0.;
+
+  for (; m > 0; m -= m & -m)
+    sum += mc->nfold_tree[m];
+  return sum;
+}
+
+static void CheckNFold(void)
+{
+  MoveParms   mparms = { 0., 0., 0, 0, 1, 0.5 };   /* swap moves only */
+  Annealer    an;
+  MoveContext *mc;
+  double      S = 0.05;              /* rates all over (0, 1] on this */
+  double      *rate, *sum, total, before, x;
+  int         sizes[] = { 1, 2, 7, 8, 9, 0 };   /* 0: the whole move set */
+  int         nmoves, k, m, nacc, bad, first, last;
+  char        what[128];
+
+  mc = StartMoves(1000, mparms, &an);
+  if (!NFoldBuild(mc))
+    error("CheckNFold: no n-fold move set for 1000 cities");
+  mc->nfold_on = 1;
+  NFoldRates(mc, S);
+
+  nacc = 0;
+  for (k=0; nacc<NFOLD_SWAPS && k<100*NFOLD_SWAPS; k++)
+    if (NFoldMove(&an, S) != FORBIDDEN_MOVE) {
+      AcceptMove(&an);
+      nacc++;
+    }
+
+  nmoves = mc->nfold_nmoves;
+  rate   = (double *)malloc(nmoves * sizeof(double));
+  sum    = (double *)malloc((nmoves+1) * sizeof(double));
+  for (m=0; m<nmoves; m++)
+    rate[m] = mc->nfold_rate[m];
+  for (m=0; m<=nmoves; m++)
+    sum[m] = FenwickSum(mc, m);
+  total = mc->nfold_total;
+
+  NFoldRates(mc, S);
+  bad = 0;
+  for (m=0; m<nmoves; m++)
+    if (rate[m] != mc->nfold_rate[m])
+      bad++;
+  snprintf(what, sizeof(what), "NFoldUpdate keeps the rates of NFoldRates "
+           "over %d accepted swaps", nacc);
+  Check(nacc == NFOLD_SWAPS && !bad, what);
+
+  bad = fabs(total - mc->nfold_total) > 1e-9 * mc->nfold_total;
+  for (m=0; m<=nmoves; m++)
+    if (fabs(sum[m] - FenwickSum(mc, m)) > 1e-9 * mc->nfold_total)
+      bad++;
+  Check(!bad && fabs(sum[nmoves] - total) <= 1e-9 * total,
+        "nfold_total and the Fenwick tree sums are those of a rebuild");
+
+/* rates of 0, 1/4, 1/2 and 1 add up exactly, so the ends of each share *
+ * can be hit exactly; the first and the last move always have one      */
+  bad = 0;
+  for (k=0; k<(int)(sizeof(sizes)/sizeof(sizes[0])); k++) {
+    mc->nfold_nmoves = sizes[k] ? sizes[k] : nmoves;
+    for (m=0; m<=mc->nfold_nmoves; m++)
+      mc->nfold_tree[m] = 0.;
+    last  = mc->nfold_nmoves - 1;
+    first = 1 + (int)(drand48() * 3);          /* after 1 to 3 without */
+    if (first > last)
+      first = last;
+    for (m=0; m<mc->nfold_nmoves; m++) {
+      rate[m] = (m < first || (m > first && m < last && drand48() < 0.3)) ?
+                0. : 0.25 * (1 << (int)(drand48() * 3));
+      FenwickAdd(mc, m, rate[m]);
+    }
+    before = 0.;
+    for (m=0; m<mc->nfold_nmoves; m++) {
+      if (rate[m] > 0.) {
+        if (FenwickFind(mc, before) != m)
+          bad++;
+        if (FenwickFind(mc, before + rate[m] - 1./1024) != m)
+          bad++;
+      }
+      before += rate[m];
+    }
+    if (FenwickFind(mc, 0.) != first)
+      bad++;
+    x = before;                        /* all of it: rounding, the last */
+    if (FenwickFind(mc, x) != last)
+      bad++;
+  }
+  mc->nfold_nmoves = nmoves;
+  NFoldRates(mc, S);
+  snprintf(what, sizeof(what), "FenwickFind picks the move whose share "
+           "holds x, at both ends of it, for 1, 2, 7, 8, 9 and %d moves", nmoves);
+  Check(!bad, what);
+
+  free(rate);
+  free(sum);
+}
+
+
+/*** CheckListSegments: after many random 2-opt moves on the list tour, **
+ *                      half of them to near cities, its segments must be *
+ *                      between group/2 and 2*group cities long still, and *
+ *                      it must be the tour the same moves give on arrays *
+ ***************************************************************************/
+
+static void CheckListSegments(void)
+{
+  int      n = 10000, nmoves = 200000;
+  city_t   *order, *position, *check;
+  double   *len;
+  TourList *tl;
+  city_t   a, c;
+  int      k, p, i, j, s, smin, smax, bad, fwd;
+  char     what[128];
+
+  srand48(n);
+  RandomInstance(n);
+  BuildDistanceMatrix(0);                       /* weigh edges on the fly */
+  distances = (dist_and_city *)calloc(ncities, sizeof(dist_and_city));
+  BuildNeighbourTable(8, 0);
+
+  order    = (city_t *)malloc(n * sizeof(city_t));
+  position = (city_t *)malloc(n * sizeof(city_t));
+  check    = (city_t *)malloc(n * sizeof(city_t));
+  len      = (double *)malloc(n * sizeof(double));
+  for (p=0; p<n; p++) {
+    order[p]    = p;
+    position[p] = p;
+  }
+  for (p=0; p<n; p++)
+    len[p] = EdgeWeight(order[p], order[(p+1)%n]);
+  tl = TourListBuild(NULL, order, len);
+
+  for (k=0; k<nmoves; k++) {         /* every other move is to one of */
+    a = (city_t)RandomInt(n);         /* the nearest neighbours, as at */
+    if (k % 2)                        /* the cold end of an anneal,    */
+      c = (city_t)GetJthNearestNeighbour(a, 1+RandomInt(8));  /* which */
+    else                              /* is what makes segments grow   */
+      c = (city_t)RandomInt(n);
+    if (a == c)
+      continue;
+    fwd = TourNext(tl, a) == order[(position[a]+1)%n];
+    TourTwoOpt(tl, a, c);
+    if (k < nmoves/100) {        /* the same move on the array tour: */
+      if (fwd) {                  /* reverse next(a)..c, or c..prev(a) */
+        i = (position[a] + 1) % n;          /* if the list runs the  */
+        j = position[c];                    /* other way round       */
+      } else {
+        i = position[c];
+        j = (position[a] - 1 + n) % n;
+      }
+      for (p=(j-i+n)%n + 1; p>1; p-=2) {
+        s = order[i];  order[i] = order[j];  order[j] = s;
+        position[order[i]] = i;
+        position[order[j]] = j;
+        i = (i+1) % n;
+        j = (j-1+n) % n;
+      }
+    }
+    if (k == nmoves/100-1) {        /* the same neighbours both ways? */
+      bad = 0;
+      for (p=0; p<n; p++) {
+        a = order[p];
+        c = order[(p+1)%n];
+        if (TourNext(tl, a) != c && TourPrev(tl, a) != c)
+          bad++;
+      }
+      snprintf(what, sizeof(what), "%d 2-opt moves give the same tour on "
+               "the list as on the array", nmoves/100);
+      Check(!bad, what);
+    }
+  }
+
+  smin = n;
+  smax = 0;
+  for (k=0, s=tl->nodes[0].seg; k<tl->nsegs; k++, s=tl->segs[s].next) {
+    if (tl->segs[s].size < smin) smin = tl->segs[s].size;
+    if (tl->segs[s].size > smax) smax = tl->segs[s].size;
+  }
+  snprintf(what, sizeof(what), "list segments of %d to %d cities for group "
+           "%d after %d 2-opt moves", smin, smax, tl->group, nmoves);
+  Check(2*smin >= tl->group && smax <= 2*tl->group, what);
+
+  TourListFlatten(tl, order, position, len);
+  bad = 0;
+  for (p=0; p<n; p++)
+    check[p] = 0;
+  for (p=0; p<n; p++) {
+    check[order[p]]++;
+    if (fabs(len[p] - EdgeWeight(order[p], order[(p+1)%n])) > 1e-9)
+      bad++;
+  }
+  for (p=0; p<n; p++)
+    if (check[p] != 1)
+      bad++;
+  Check(!bad, "the list is still a tour of all cities, with its edge weights");
+
+  TourListFree(tl);
+  free(order);
+  free(position);
+  free(check);
+  free(len);
+}
+
+
+/*** CheckEdgeWeights: the kernels EdgeWeights and EdgeDelta point to ****
+ *                     (SIMD ones where the CPU has them) must give the    *
+ *                     weights of CityDistance exactly, in every metric    *
+ *                     and for any number of edges                         *
+ ***************************************************************************/
+
+static void CheckEdgeWeights(void)
+{
+  EdgeWeightType types[] = { EUC_RAW, EUC_2D, CEIL_2D, ATT, GEO };
+  int      n = 1000, nedges = 64;
+  city_t   a[64], b[64];
+  double   w[64], removed, added;
+  int      t, k, m, i, bad;
+  char     what[128];
+
+  srand48(n);
+  RandomInstance(n);
+  for (t=0; t<(int)(sizeof(types)/sizeof(types[0])); t++) {
+    edge_weight_type = types[t];
+    FreeDistanceMatrix();              /* picks the kernels for the type */
+    bad = 0;
+    for (k=0; k<2000; k++) {
+      m = 1 + k % nedges;
+      for (i=0; i<m; i++) {
+        a[i] = (city_t)RandomInt(n);
+        b[i] = (i % 5) ? (city_t)RandomInt(n) : a[i];      /* some a == b */
+      }
+      EdgeWeights(a, b, m, w);
+      removed = added = 0.;
+      for (i=0; i<m; i++) {
+        if (w[i] != CityDistance(a[i], b[i]))
+          bad++;
+        if (i < m/2)
+          removed += CityDistance(a[i], b[i]);
+        else
+          added += CityDistance(a[i], b[i]);
+      }
+      if (EdgeDelta(a, b, m/2, m-m/2) != added - removed)
+        bad++;
+    }
+    snprintf(what, sizeof(what), "EdgeWeights and EdgeDelta give the %s "
+             "weights of CityDistance", EdgeWeightName());
+    Check(!bad, what);
+  }
+  edge_weight_type = EUC_RAW;
+  FreeDistanceMatrix();
+}
+
+
+/*** CheckSharedRows: threads that share a neighbour row cache much too ***
+ *                    small for them, so that rows keep being evicted and *
+ *                    filled again under them, must always get the rows   *
+ *                    the full table has                                   *
+ ***************************************************************************/
+
+#define ROW_THREADS  4
+#define ROW_LOOKUPS  200000
+
+static city_t *row_ref;                       /* the full table's rows */
+static int     row_k = 10;
+static long    row_bad[ROW_THREADS];       /* wrong rows each thread got */
+
+static void *RowLookups(void *arg)
+{
+  int            t = (int)(intptr_t)arg;
+  unsigned short seed[3] = { 1, 2, 0 };
+  city_t         home;
+  int            k, j;
+
+  seed[2] = (unsigned short)t;                         /* a stream each */
+  distances = (dist_and_city *)calloc(ncities, sizeof(dist_and_city));
+  row_bad[t] = 0;
+  for (k=0; k<ROW_LOOKUPS; k++) {
+    home = (city_t)(nrand48(seed) % ncities);
+    j    = 1 + (int)(nrand48(seed) % row_k);
+    if (GetJthNearestNeighbour(home, j) != row_ref[home*row_k + j-1])
+      row_bad[t]++;
+  }
+  free(distances);
+  return NULL;
+}
+
+static void CheckSharedRows(void)
+{
+  pthread_t     thread[ROW_THREADS];
+  unsigned long stats[3];
+  int           n = 2000, c, j, t, nbad = 0;
+  char          what[128];
+
+  srand48(n);
+  RandomInstance(n);
+  distances = (dist_and_city *)calloc(ncities, sizeof(dist_and_city));
+  row_ref   = (city_t *)malloc(n * row_k * sizeof(city_t));
+  BuildNeighbourTable(row_k, 0);
+  for (c=0; c<n; c++)
+    for (j=1; j<=row_k; j++)
+      row_ref[c*row_k + j-1] = GetJthNearestNeighbour(c, j);
+  FreeNeighbourTable();
+
+  BuildNeighbourTable(row_k, n*sizeof(int) + 64 * (row_k*sizeof(city_t) +
+                      sizeof(city_t) + sizeof(unsigned char) + sizeof(unsigned int)));
+  ShareNeighbourTable();
+  for (t=0; t<ROW_THREADS; t++)
+    pthread_create(thread+t, NULL, RowLookups, (void *)(intptr_t)t);
+  for (t=0; t<ROW_THREADS; t++) {
+    pthread_join(thread[t], NULL);
+    nbad += row_bad[t];
+  }
+  GetNeighbourCacheStats(stats);
+  snprintf(what, sizeof(what), "%d threads on a shared cache of %d rows get "
+           "the full table's rows (%lu misses)", ROW_THREADS,
+           GetNeighbourCacheStats(stats), stats[1]);
+  Check(!nbad && stats[1] > 0, what);
+
+  FreeNeighbourTable();
+  free(row_ref);
+}
+
+
+/*** main: runs all the checks *********************************************
+ ***************************************************************************/
+
+int main(int argc, char **argv)
+{
+  InitRandom(1234, RAND_STREAM(0, 0));
+
+  CheckOrOptLengths();
+  CheckNFold();
+  CheckListSegments();
+  CheckEdgeWeights();
+  CheckSharedRows();
+
+  printf("%d check(s) failed\n", nfailed);
+  return nfailed;
+}
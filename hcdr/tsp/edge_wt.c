@@ -2,39 +2,805 @@
  * Starting edge weight from scratch. */
 
 #include "edge_wt.h"
+#include "error.h"
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 #include <math.h>
+#include <pthread.h>
 #include <sys/param.h>
 
+#if !defined(NO_SIMD) && defined(__x86_64__) && defined(__GNUC__)
+#define EDGE_SIMD                        /* see SIMD KERNELS below */
+#include <immintrin.h>
+#endif
 
-double GetDistance(coord A, coord B){
-  /* Pythagoras */
-  return sqrt(pow(A.coord_x-B.coord_x,2)+pow(A.coord_y-B.coord_y,2));
+
+double GetDistance(city_t a, city_t b){
+  /* Pythagoras; squares by hand rather than pow(x,2) */
+  double dx = (double)city_x[a]-(double)city_x[b];
+  double dy = (double)city_y[a]-(double)city_y[b];
+  return sqrt(dx*dx+dy*dy);
+}
+
+/*** COORDINATES ***********************************************************
+ * SRV 2026-10-17: x and y in separate arrays, aligned so that vector      *
+ * loads over consecutive cities work; as floats with -DFLOAT_COORDS       *
+ ***************************************************************************/
+
+void AllocCoords(city_t n){
+  size_t bytes = ((n*sizeof(coord_t) + COORD_ALIGN-1)/COORD_ALIGN)*COORD_ALIGN;
+
+  city_x = (coord_t *)aligned_alloc(COORD_ALIGN, bytes);
+  city_y = (coord_t *)aligned_alloc(COORD_ALIGN, bytes);
+  if (city_x == NULL || city_y == NULL)
+    error("AllocCoords: city coordinates could not be allocated");
+  memset(city_x, 0, bytes);
+  memset(city_y, 0, bytes);
+}
+
+void FreeCoords(void){
+  free(city_x);
+  free(city_y);
+  city_x = NULL;
+  city_y = NULL;
+}
+
+/*** EDGE WEIGHTS **********************************************************
+ * SRV 2026-10-17: the TSPLIB edge weight functions. The integer ones are  *
+ * summed in long long, so tour lengths and move deltas are exact. The     *
+ * neighbour lists still rank cities by plain GetDistance, which is all    *
+ * the move generator needs.                                               *
+ ***************************************************************************/
+
+#define GEO_PI   3.141592                      /* TSPLIB's value, not M_PI */
+#define GEO_RRR  6378.388                   /* TSPLIB's earth radius in km */
+
+static inline long WeightEuc2D(city_t a, city_t b){
+  return (long)(GetDistance(a, b) + 0.5);                     /* nint() */
+}
+
+static inline long WeightCeil2D(city_t a, city_t b){
+  return (long)ceil(GetDistance(a, b));
+}
+
+static inline long WeightAtt(city_t a, city_t b){
+  double dx = (double)city_x[a]-(double)city_x[b];     /* pseudo-Euclidean */
+  double dy = (double)city_y[a]-(double)city_y[b];
+  double r  = sqrt((dx*dx+dy*dy)/10.);
+  long   t  = (long)(r + 0.5);
+  return (t < r) ? t+1 : t;
+}
+
+/* DDD.MM to radians; the integer part is truncated as in the programs    *
+ * that produced the published optima (the TSPLIB text says nint)         */
+static inline double GeoRadians(double x){
+  double deg = (double)(long)x;
+  return GEO_PI*(deg + 5.*(x-deg)/3.)/180.;
+}
+
+static inline long WeightGeo(city_t a, city_t b){
+  double lat_a = GeoRadians(city_x[a]), lon_a = GeoRadians(city_y[a]);
+  double lat_b = GeoRadians(city_x[b]), lon_b = GeoRadians(city_y[b]);
+  double q1 = cos(lon_a-lon_b);
+  double q2 = cos(lat_a-lat_b);
+  double q3 = cos(lat_a+lat_b);
+  return (long)(GEO_RRR*acos(.5*((1.+q1)*q2 - (1.-q1)*q3)) + 1.);
+}
+
+/* weight of one edge, the slow but general way: for tour_cost & friends */
+double CityDistance(city_t a, city_t b){
+  switch (edge_weight_type){
+  case EUC_2D:  return (double)WeightEuc2D(a, b);
+  case CEIL_2D: return (double)WeightCeil2D(a, b);
+  case ATT:     return (double)WeightAtt(a, b);
+  case GEO:     return (double)WeightGeo(a, b);
+  default:      return GetDistance(a, b);
+  }
+}
+
+const char *EdgeWeightName(void){
+  switch (edge_weight_type){
+  case EUC_2D:  return "EUC_2D";
+  case CEIL_2D: return "CEIL_2D";
+  case ATT:     return "ATT";
+  case GEO:     return "GEO";
+  default:      return "EUC_RAW";
+  }
+}
+
+
+/*** DISTANCE MATRIX *******************************************************
+ * SRV 2026-10-17: packed lower triangle, the weight between cities a > b  *
+ * is at a*(a-1)/2+b; floats for EUC_RAW like the old explicit edge        *
+ * weights (LG 03-03), ints for the integer metrics.                       *
+ ***************************************************************************/
+
+static float *matrix_f = NULL;
+static int   *matrix_i = NULL;
+
+static inline size_t MatrixIndex(city_t a, city_t b){
+  return (a > b) ? (size_t)a*(a-1)/2 + b : (size_t)b*(b-1)/2 + a;
+}
+
+
+/*** EDGE DELTA KERNELS ****************************************************
+ * One per metric and storage, so the weight is inlined and there is no   *
+ * branch per edge; SelectEdgeDelta picks one once the matrix is decided. *
+ * They return the weight of the nadd added edges a[nrem..], b[nrem..]     *
+ * minus that of the nrem removed ones a[0..], b[0..].                     *
+ ***************************************************************************/
+
+#define EDGE_DELTA_INT(name, WEIGHT)                                         \
+static double name(const city_t *a, const city_t *b,         \
+                   int nrem, int nadd){                                      \
+  long long removed = 0, added = 0;                                          \
+  int i;                                                                     \
+  for (i=0; i<nrem; i++)                                                     \
+    removed += WEIGHT;                                                       \
+  for (; i<nrem+nadd; i++)                                                   \
+    added += WEIGHT;                                                         \
+  return (double)(added - removed);                                          \
+}
+
+EDGE_DELTA_INT(DeltaEuc2D,   WeightEuc2D(a[i], b[i]))
+EDGE_DELTA_INT(DeltaCeil2D,  WeightCeil2D(a[i], b[i]))
+EDGE_DELTA_INT(DeltaAtt,     WeightAtt(a[i], b[i]))
+EDGE_DELTA_INT(DeltaGeo,     WeightGeo(a[i], b[i]))
+EDGE_DELTA_INT(DeltaMatrixI, (a[i] == b[i] ? 0 : matrix_i[MatrixIndex(a[i], b[i])]))
+
+static double DeltaRaw(const city_t *a, const city_t *b,
+                       int nrem, int nadd){
+  double removed = 0., added = 0.;
+  int i;
+  for (i=0; i<nrem; i++)
+    removed += GetDistance(a[i], b[i]);
+  for (; i<nrem+nadd; i++)
+    added += GetDistance(a[i], b[i]);
+  return added - removed;
+}
+
+static double DeltaMatrixF(const city_t *a, const city_t *b,
+                           int nrem, int nadd){
+  double removed = 0., added = 0.;
+  int i;
+  for (i=0; i<nrem; i++)
+    removed += (a[i] == b[i]) ? 0. : matrix_f[MatrixIndex(a[i], b[i])];
+  for (; i<nrem+nadd; i++)
+    added += (a[i] == b[i]) ? 0. : matrix_f[MatrixIndex(a[i], b[i])];
+  return added - removed;
+}
+
+/* SRV 2026-10-17: the same per edge, for the batched moves in move.c;   *
+ * w[i] is the weight of edge (a[i], b[i]); one tight loop without sums,  *
+ * so the coordinate loads of many edges are in flight at once, and the  *
+ * compiler may vectorize it                                             */
+#define EDGE_WEIGHTS(name, WEIGHT)                                           \
+static void name(const city_t *a, const city_t *b, int n, double *w){       \
+  int i;                                                                     \
+  for (i=0; i<n; i++)                                                        \
+    w[i] = (double)(WEIGHT);                                                 \
+}
+
+EDGE_WEIGHTS(WeightsEuc2D,   WeightEuc2D(a[i], b[i]))
+EDGE_WEIGHTS(WeightsCeil2D,  WeightCeil2D(a[i], b[i]))
+EDGE_WEIGHTS(WeightsAtt,     WeightAtt(a[i], b[i]))
+EDGE_WEIGHTS(WeightsGeo,     WeightGeo(a[i], b[i]))
+EDGE_WEIGHTS(WeightsMatrixI, (a[i] == b[i] ? 0 : matrix_i[MatrixIndex(a[i], b[i])]))
+EDGE_WEIGHTS(WeightsMatrixF, (a[i] == b[i] ? 0. : matrix_f[MatrixIndex(a[i], b[i])]))
+EDGE_WEIGHTS(WeightsRaw,     GetDistance(a[i], b[i]))
+
+
+/*** SIMD KERNELS **********************************************************
+ * SRV 2026-10-18: EdgeWeights for the on the fly Euclidean metrics        *
+ * (EUC_RAW, EUC_2D and CEIL_2D) also comes as AVX2 kernels, which do 4    *
+ * edges at a time and gather their coordinates out of city_x and city_y;  *
+ * SelectEdgeDelta picks them at run time if the CPU has AVX2, so one      *
+ * binary runs everywhere, and NO_SIMD=on builds without them. Their       *
+ * weights are bit for bit those of the scalar kernels, so runs do not     *
+ * change. EdgeDelta stays scalar: a move sums 2 to 8 edges, too few for   *
+ * the gathers to pay. AVX-512 kernels of 8 edges were no faster than      *
+ * these (its gathers are slower per city), so there are none.             *
+ ***************************************************************************/
+
+#ifdef EDGE_SIMD
+
+/* the ids of 4 cities as 32 bit gather indices */
+__attribute__((target("avx2")))
+static inline __m128i Ids4(const city_t *p){
+#ifdef WIDE_CITIES
+  return _mm_loadu_si128((const __m128i *)p);
+#else
+  return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)p));
+#endif
+}
+
+/* the coordinates of 4 cities, in double */
+__attribute__((target("avx2")))
+static inline __m256d Coords4(const coord_t *c, __m128i ids){
+#ifdef FLOAT_COORDS
+  return _mm256_cvtps_pd(_mm_i32gather_ps(c, ids, sizeof(coord_t)));
+#else
+  return _mm256_i32gather_pd(c, ids, sizeof(coord_t));
+#endif
+}
+
+/* GetDistance of 4 edges; no FMA, which would round differently */
+__attribute__((target("avx2")))
+static inline __m256d Distance4(const city_t *a, const city_t *b){
+  __m128i ia = Ids4(a), ib = Ids4(b);
+  __m256d dx = _mm256_sub_pd(Coords4(city_x, ia), Coords4(city_x, ib));
+  __m256d dy = _mm256_sub_pd(Coords4(city_y, ia), Coords4(city_y, ib));
+  return _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx),
+                                      _mm256_mul_pd(dy, dy)));
+}
+
+/* the metrics: distances are never negative, so nint() is floor(d+.5) */
+#define RAW4(d)    (d)
+#define NINT4(d)   _mm256_floor_pd(_mm256_add_pd(d, _mm256_set1_pd(.5)))
+#define CEIL4(d)   _mm256_ceil_pd(d)
+
+/* the last n%4 edges go to the scalar kernel SCALAR */
+#define EDGE_WEIGHTS_AVX2(name, ROUND, SCALAR)                              \
+__attribute__((target("avx2")))                                              \
+static void name(const city_t *a, const city_t *b, int n, double *w){       \
+  int i;                                                                     \
+  for (i=0; i+4<=n; i+=4)                                                    \
+    _mm256_storeu_pd(w+i, ROUND(Distance4(a+i, b+i)));                       \
+  if (i < n)                                                                 \
+    SCALAR(a+i, b+i, n-i, w+i);                                              \
+}
+
+EDGE_WEIGHTS_AVX2(WeightsRawAvx2,    RAW4,  WeightsRaw)
+EDGE_WEIGHTS_AVX2(WeightsEuc2DAvx2,  NINT4, WeightsEuc2D)
+EDGE_WEIGHTS_AVX2(WeightsCeil2DAvx2, CEIL4, WeightsCeil2D)
+
+/* swaps in the AVX2 EdgeWeights for the metrics that have one */
+static void SelectSimdWeights(void){
+  if (!__builtin_cpu_supports("avx2"))
+    return;
+  switch (edge_weight_type){
+  case EUC_RAW: EdgeWeights = WeightsRawAvx2;    break;
+  case EUC_2D:  EdgeWeights = WeightsEuc2DAvx2;  break;
+  case CEIL_2D: EdgeWeights = WeightsCeil2DAvx2; break;
+  default:                                     /* ATT and GEO stay scalar */
+    break;
+  }
+}
+#endif
+
+static void SelectEdgeDelta(void){
+  if (matrix_f) {
+    EdgeDelta   = DeltaMatrixF;
+    EdgeWeights = WeightsMatrixF;
+  } else if (matrix_i) {
+    EdgeDelta   = DeltaMatrixI;
+    EdgeWeights = WeightsMatrixI;
+  } else switch (edge_weight_type){
+  case EUC_2D:  EdgeDelta = DeltaEuc2D;  EdgeWeights = WeightsEuc2D;  break;
+  case CEIL_2D: EdgeDelta = DeltaCeil2D; EdgeWeights = WeightsCeil2D; break;
+  case ATT:     EdgeDelta = DeltaAtt;    EdgeWeights = WeightsAtt;    break;
+  case GEO:     EdgeDelta = DeltaGeo;    EdgeWeights = WeightsGeo;    break;
+  default:      EdgeDelta = DeltaRaw;    EdgeWeights = WeightsRaw;    break;
+  }
+#ifdef EDGE_SIMD
+  if (!matrix_f && !matrix_i)
+    SelectSimdWeights();
+#endif
+}
+
+/* EdgeDelta starts out here, so that users that never build a matrix    *
+ * (printscore) get the right on the fly kernel on their first call      */
+static double DeltaFirstCall(const city_t *a, const city_t *b,
+                             int nrem, int nadd){
+  SelectEdgeDelta();
+  return EdgeDelta(a, b, nrem, nadd);
+}
+
+double (*EdgeDelta)(const city_t *a, const city_t *b,
+                    int nrem, int nadd) = DeltaFirstCall;
+
+static void WeightsFirstCall(const city_t *a, const city_t *b,
+                             int n, double *w){
+  SelectEdgeDelta();
+  EdgeWeights(a, b, n, w);
+}
+
+void (*EdgeWeights)(const city_t *a, const city_t *b,
+                    int n, double *w) = WeightsFirstCall;
+
+
+int BuildDistanceMatrix(long max_bytes){
+  size_t a, b, row;
+  size_t bytes = sizeof(float)*(size_t)ncities*(ncities-1)/2;
+
+  matrix_f = NULL;              /* sizeof(int) == sizeof(float) for bytes */
+  matrix_i = NULL;
+  if ( max_bytes > 0 && bytes <= (size_t)max_bytes && ncities >= 2 ){
+    if (edge_weight_type == EUC_RAW)
+      matrix_f = (float *)malloc(bytes);
+    else
+      matrix_i = (int *)malloc(bytes);
+  }
+  /* a failed malloc is not fatal, we can still go on the fly */
+  for (a=1; a<ncities && (matrix_f || matrix_i); a++){
+    row = a*(a-1)/2;
+    for (b=0; b<a; b++)
+      if (matrix_f)
+        matrix_f[row+b] = (float)GetDistance(a, b);
+      else
+        matrix_i[row+b] = (int)CityDistance(a, b);
+  }
+  SelectEdgeDelta();
+  return (matrix_f || matrix_i);
+}
+
+void FreeDistanceMatrix(void){
+  free(matrix_f);
+  free(matrix_i);
+  matrix_f = NULL;
+  matrix_i = NULL;
+  EdgeDelta   = DeltaFirstCall;
+  EdgeWeights = WeightsFirstCall;
+}
+
+
+/*** CITY RENUMBERING ****************************************************
+ * SRV 2026-10-17: cities are numbered by their position along a Hilbert  *
+ * (or Morton) curve over a 2^16 x 2^16 grid on their bounding box, so    *
+ * that the coordinates, neighbour rows and matrix rows that a move       *
+ * touches together are mostly close together in memory                  *
+ ***************************************************************************/
+
+#define CURVE_BITS 16
+
+typedef struct {
+  unsigned long  key;                     /* position along the curve */
+  city_t city;                    /* id in the .tsp file      */
+} key_and_city;
+
+static city_t *city_label = NULL;   /* file id of every city */
+
+static unsigned long HilbertKey(unsigned long x, unsigned long y){
+  unsigned long s, rx, ry, t, d = 0;
+  for (s = 1UL<<(CURVE_BITS-1); s > 0; s >>= 1){
+    rx = (x & s) > 0;
+    ry = (y & s) > 0;
+    d += s*s*((3*rx)^ry);
+    if (ry == 0){                       /* rotate the quadrant */
+      if (rx == 1){
+        x = s-1-(x & (s-1));
+        y = s-1-(y & (s-1));
+      }
+      t = x; x = y; y = t;
+    }
+  }
+  return d;
+}
+
+static unsigned long MortonKey(unsigned long x, unsigned long y){
+  unsigned long s, d = 0;
+  int b;
+  for (b=0, s=1; b<CURVE_BITS; b++, s <<= 1)
+    d |= ((x & s) << b) | ((y & s) << (b+1));
+  return d;
+}
+
+static int CompareKeys(const void *a, const void *b){
+  const key_and_city *A = (const key_and_city *)a;
+  const key_and_city *B = (const key_and_city *)b;
+  if (A->key != B->key)
+    return (A->key < B->key) ? -1 : 1;
+  return (int)A->city - (int)B->city;   /* ties keep file order */
+}
+
+void RenumberCities(CityOrder order){
+  key_and_city   *keys;
+  coord_t        *sorted_x, *sorted_y;
+  double         xmin, ymin, xmax, ymax, scale;
+  unsigned long  gx, gy;
+  int            i;
+
+  FreeCityLabels();
+  if (order == FILE_ORDER || ncities < 2)
+    return;
+
+  xmin = xmax = city_x[0];
+  ymin = ymax = city_y[0];
+  for (i=1; i<ncities; i++){
+    xmin = MIN(xmin, city_x[i]);
+    xmax = MAX(xmax, city_x[i]);
+    ymin = MIN(ymin, city_y[i]);
+    ymax = MAX(ymax, city_y[i]);
+  }
+  scale = MAX(xmax-xmin, ymax-ymin);
+  scale = (scale > 0.) ? ((1UL<<CURVE_BITS)-1)/scale : 0.;
+
+  keys   = (key_and_city *)malloc(ncities*sizeof(key_and_city));
+  sorted_x = (coord_t *)malloc(ncities*sizeof(coord_t));
+  sorted_y = (coord_t *)malloc(ncities*sizeof(coord_t));
+  city_label = (city_t *)malloc(ncities*sizeof(city_t));
+  if (!keys || !sorted_x || !sorted_y || !city_label)
+    error("RenumberCities: could not allocate the curve keys");
+
+  for (i=0; i<ncities; i++){
+    gx = (unsigned long)((city_x[i]-xmin)*scale);
+    gy = (unsigned long)((city_y[i]-ymin)*scale);
+    keys[i].key  = (order == HILBERT_ORDER) ? HilbertKey(gx, gy)
+                                            : MortonKey(gx, gy);
+    keys[i].city = i;
+  }
+  qsort(keys, ncities, sizeof(key_and_city), CompareKeys);
+
+  for (i=0; i<ncities; i++){
+    city_label[i] = keys[i].city;
+    sorted_x[i]   = city_x[keys[i].city];
+    sorted_y[i]   = city_y[keys[i].city];
+  }
+  memcpy(city_x, sorted_x, ncities*sizeof(coord_t));
+  memcpy(city_y, sorted_y, ncities*sizeof(coord_t));
+
+  free(sorted_x);
+  free(sorted_y);
+  free(keys);
+}
+
+city_t OriginalCity(city_t c){
+  return city_label ? city_label[c] : c;
+}
+
+void FreeCityLabels(void){
+  free(city_label);
+  city_label = NULL;
+}
+
+
+/*** SPATIAL GRID **********************************************************
+ * SRV 2026-10-17: uniform grid over the cities, sized for about two      *
+ * cities per cell; cities are bucketed by cell with a counting sort so    *
+ * that grid_cities[grid_start[c]..grid_start[c+1]-1] are the cities in    *
+ * cell c. It is built the first time a neighbour query needs it.          *
+ ***************************************************************************/
+
+#define GRID_CITIES_PER_CELL 2.
+
+static double grid_xmin, grid_ymin;             /* lower left of the grid */
+static double grid_h;                                       /* cell width */
+static int    grid_nx = 0, grid_ny = 0;            /* cells in x and in y */
+static int    *grid_start = NULL;       /* first entry of each cell (+1) */
+static city_t *grid_cities = NULL;      /* city ids sorted by cell */
+
+static int GridCellX(double x){
+  int c = (int)((x-grid_xmin)/grid_h);
+  return MIN(MAX(c, 0), grid_nx-1);
+}
+
+static int GridCellY(double y){
+  int c = (int)((y-grid_ymin)/grid_h);
+  return MIN(MAX(c, 0), grid_ny-1);
+}
+
+static void BuildSpatialGrid(void){
+  int i, c;
+  double xmax, ymax, w, h;
+
+  grid_xmin = xmax = city_x[0];
+  grid_ymin = ymax = city_y[0];
+  for (i=1; i<ncities; i++){
+    grid_xmin = MIN(grid_xmin, city_x[i]);
+    xmax      = MAX(xmax,      city_x[i]);
+    grid_ymin = MIN(grid_ymin, city_y[i]);
+    ymax      = MAX(ymax,      city_y[i]);
+  }
+  w = xmax-grid_xmin;
+  h = ymax-grid_ymin;
+  /* square cells for the bounding box; the second term keeps instances   *
+   * lying on a line from ending up with zero-width cells                 */
+  grid_h = MAX(sqrt(w*h*GRID_CITIES_PER_CELL/ncities),
+               MAX(w, h)*GRID_CITIES_PER_CELL/ncities);
+  if (grid_h <= 0.)
+    grid_h = 1.;
+  grid_nx = (int)(w/grid_h) + 1;
+  grid_ny = (int)(h/grid_h) + 1;
+
+  grid_start  = (int *)calloc((size_t)grid_nx*grid_ny + 1, sizeof(int));
+  grid_cities = (city_t *)malloc(sizeof(city_t)*ncities);
+  if (grid_start == NULL || grid_cities == NULL)
+    error("BuildSpatialGrid: could not allocate spatial grid");
+
+  for (i=0; i<ncities; i++){            /* count, prefix sum, then bucket */
+    c = GridCellY(city_y[i])*grid_nx + GridCellX(city_x[i]);
+    grid_start[c+1]++;
+  }
+  for (c=0; c<grid_nx*grid_ny; c++)
+    grid_start[c+1] += grid_start[c];
+  for (i=0; i<ncities; i++){
+    c = GridCellY(city_y[i])*grid_nx + GridCellX(city_x[i]);
+    grid_cities[grid_start[c]++] = i;
+  }
+  for (c=grid_nx*grid_ny; c>0; c--)      /* bucketing shifted the starts */
+    grid_start[c] = grid_start[c-1];
+  grid_start[0] = 0;
+}
+
+/* appends the cities of the square ring of cells at Chebyshev distance r  *
+ * around cell (cx,cy) to distances[*m..], with their distance to home     */
+static void GridAddRing(int cx, int cy, int r, city_t home, int *m){
+  int dx, dy, x, y, c, e;
+  for (dy=-r; dy<=r; dy++){
+    y = cy+dy;
+    if (y < 0 || y >= grid_ny)
+      continue;
+    for (dx=-r; dx<=r; dx += (dy==-r || dy==r || r==0) ? 1 : 2*r){
+      x = cx+dx;
+      if (x < 0 || x >= grid_nx)
+        continue;
+      c = y*grid_nx + x;
+      for (e=grid_start[c]; e<grid_start[c+1]; e++){
+        distances[*m].city     = grid_cities[e];
+        distances[*m].distance = GetDistance(grid_cities[e], home);
+        (*m)++;
+      }
+    }
+  }
+}
+
+/*** GridSelect: leaves the n-th nearest city of home (rank 0 is home) in **
+ *               distances[n], with distances[0..n-1] the closer ones.     *
+ *               Rings of cells are added until every city closer than     *
+ *               the current n-th candidate has been seen: the cities      *
+ *               outside ring r are at least r*grid_h away. Only the       *
+ *               cities of those rings are looked at, i.e. O(n) for small  *
+ *               n rather than O(ncities).                                 *
+ ***************************************************************************/
+static void GridSelect(city_t home, city_t n){
+  int    cx, cy;
+  int    r = 0;
+  int    m = 0;                            /* candidates in distances[] */
+  double reach = -1.;           /* distance of a known n-th candidate */
+
+  if (grid_start == NULL)
+    BuildSpatialGrid();
+
+  cx = GridCellX(city_x[home]);
+  cy = GridCellY(city_y[home]);
+  for (;;){
+    GridAddRing(cx, cy, r, home, &m);
+    if (cx-r <= 0 && cy-r <= 0 && cx+r >= grid_nx-1 && cy+r >= grid_ny-1)
+      break;                                        /* whole grid is in */
+    if (m > n){
+      if (reach < 0.){
+        FloydRivestSelect(0, m-1, n);
+        reach = distances[n].distance;
+      }
+      if (r*grid_h >= reach)
+        break;
+    }
+    r++;
+  }
+  FloydRivestSelect(0, m-1, n);
+}
+
+void FreeSpatialGrid(void){
+  free(grid_start);
+  free(grid_cities);
+  grid_start  = NULL;
+  grid_cities = NULL;
+  grid_nx = grid_ny = 0;
 }
 
 
-int GetJthNearestNeighbour(unsigned short home, unsigned short n){
-  coord nhome = node_coords[home];
-  for(int i=0; i<ncities; i++){
-    distances[i].city     = i;
-    distances[i].distance = GetDistance(node_coords[i], nhome);
-    /* if we want to get into this, might be worth trying different
-     * method here of just updating distance --- will look into
-     * this but I'm not sure it will actually be faster... */
+/*** NEIGHBOUR LISTS *******************************************************
+ * SRV 2026-10-17: the sorted nneighbours nearest cities of a city (its    *
+ * row) are either all precomputed into neighbour_table, or, if that does  *
+ * not fit into the per-rank byte budget, kept in a cache of row_slots     *
+ * rows that is filled on first use and evicted with the clock algorithm.  *
+ * SRV 2026-10-18: if the chains of a rank share the cache, only a miss    *
+ * takes row_lock; a hit reads the slot between two looks at its slot_seq, *
+ * which is odd while a miss rewrites the slot, and falls back to the lock *
+ * if it changed or the slot holds another city by then (a seqlock).       *
+ ***************************************************************************/
+
+static city_t *neighbour_table = NULL;   /* the rows themselves */
+static int            *row_slot  = NULL;  /* cache slot of a city, or -1 */
+static city_t *slot_city = NULL;  /* city held by a cache slot   */
+static unsigned char  *slot_ref  = NULL;  /* clock reference bits        */
+static unsigned int   *slot_seq  = NULL;  /* rewrites of a slot, times 2 */
+static int            row_slots  = 0;     /* number of cache slots       */
+static int            clock_hand = 0;     /* next slot to consider       */
+
+static __thread unsigned long row_hits = 0; /* cache statistics: hits */
+static unsigned long  row_misses    = 0;  /* are the thread's, the rest */
+static unsigned long  row_evictions = 0;
+
+static int             row_shared = 0;   /* 1 if threads share the cache */
+static pthread_mutex_t row_lock = PTHREAD_MUTEX_INITIALIZER;
+
+__thread dist_and_city *distances;     /* see edge_wt.h */
+
+/* order by distance, ties by city id so every rank builds the same rows */
+static int CompareDistances(const void *a, const void *b){
+  const dist_and_city *A = (const dist_and_city *)a;
+  const dist_and_city *B = (const dist_and_city *)b;
+  if (A->distance < B->distance) return -1;
+  if (A->distance > B->distance) return 1;
+  return (int)A->city - (int)B->city;
+}
+
+static void FillNeighbourRow(city_t home, city_t *row){
+  int i, filled;
+  /* partition the k+1 closest (self included) to the front, sort them */
+  GridSelect(home, nneighbours);
+  qsort(distances, nneighbours+1, sizeof(dist_and_city), CompareDistances);
+  /* self need not be first if cities share coordinates, so skip by id */
+  filled = 0;
+  for (i=0; i<=nneighbours && filled<nneighbours; i++)
+    if (distances[i].city != home)
+      row[filled++] = distances[i].city;
+}
+
+static city_t *NeighbourRow(city_t home){
+  int slot;
+
+  if (!row_slots)
+    return neighbour_table + (size_t)home*nneighbours;
+
+  slot = row_slot[home];
+  if (slot >= 0){
+    row_hits++;
+    slot_ref[slot] = 1;
+    return neighbour_table + (size_t)slot*nneighbours;
+  }
+
+  row_misses++;
+  while (slot_ref[clock_hand]){     /* second chance for recently used rows */
+    slot_ref[clock_hand] = 0;
+    clock_hand = (clock_hand+1) % row_slots;
   }
-  FloydRivestSelect( 0, ncities-1, n);
+  slot = clock_hand;
+  clock_hand = (clock_hand+1) % row_slots;
+  __atomic_store_n(&slot_seq[slot], slot_seq[slot]+1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);       /* odd: being rewritten */
+  if (slot_city[slot] < ncities){
+    __atomic_store_n(&row_slot[slot_city[slot]], -1, __ATOMIC_RELAXED);
+    row_evictions++;
+  }
+  __atomic_store_n(&slot_city[slot], home, __ATOMIC_RELAXED);
+  slot_ref[slot]  = 1;
+  FillNeighbourRow(home, neighbour_table + (size_t)slot*nneighbours);
+  __atomic_store_n(&slot_seq[slot], slot_seq[slot]+1, __ATOMIC_RELEASE);
+  __atomic_store_n(&row_slot[home], slot, __ATOMIC_RELEASE);
+  return neighbour_table + (size_t)slot*nneighbours;
+}
+
+/*** SharedRowLookup: the n-th city of home's row when the threads share ***
+ *                    the cache: without the lock if the row is in there   *
+ *                    and no miss rewrites its slot meanwhile              *
+ ***************************************************************************/
+static city_t SharedRowLookup(city_t home, city_t n){
+  unsigned int seq;
+  city_t city;
+  int slot;
+
+  slot = __atomic_load_n(&row_slot[home], __ATOMIC_ACQUIRE);
+  if (slot >= 0){
+    seq = __atomic_load_n(&slot_seq[slot], __ATOMIC_ACQUIRE);
+    if (!(seq & 1) && __atomic_load_n(&slot_city[slot], __ATOMIC_RELAXED) == home){
+      city = __atomic_load_n(neighbour_table + (size_t)slot*nneighbours + n-1,
+                             __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&slot_seq[slot], __ATOMIC_RELAXED) == seq){
+        row_hits++;
+        if (!slot_ref[slot])          /* no store if set: the line stays shared */
+          __atomic_store_n(&slot_ref[slot], 1, __ATOMIC_RELAXED);
+        return city;
+      }
+    }
+  }
+  pthread_mutex_lock(&row_lock);       /* a miss, or a slot on the move */
+  city = NeighbourRow(home)[n-1];
+  pthread_mutex_unlock(&row_lock);
+  return city;
+}
+
+
+/* SRV 2026-10-17: ranks 1..nneighbours come out of the neighbour rows;  *
+ * the rarer far moves use the spatial grid to find the exact j-th one   */
+int GetJthNearestNeighbour(city_t home, city_t n){
+  if (n > 0 && n <= nneighbours){
+    if (!row_shared)
+      return NeighbourRow(home)[n-1];
+    return SharedRowLookup(home, n);
+  }
+  GridSelect(home, n);
   return distances[n].city;
 }
 
+void BuildNeighbourTable(unsigned short k, long budget){
+  city_t home;
+  size_t row_bytes;
+  int i;
+
+  if (k > ncities-1)
+    k = ncities-1;
+  nneighbours = k;
+  neighbour_table = NULL;
+  row_slots = 0;
+  if (!k)
+    return;
+
+  row_bytes = sizeof(city_t)*k;
+  if ( budget <= 0 || (size_t)ncities*row_bytes <= (size_t)budget ){
+    neighbour_table = (city_t *)malloc(row_bytes*ncities);
+    if (neighbour_table == NULL)
+      error("BuildNeighbourTable: could not allocate neighbour table");
+    for (home=0; home<ncities; home++)
+      FillNeighbourRow(home, neighbour_table + (size_t)home*k);
+    return;
+  }
+
+/* too big: the budget pays for the city->slot index and then for as many *
+ * rows (plus their slot bookkeeping) as it can hold                       */
+  if ( (size_t)budget < ncities*sizeof(int) + row_bytes +
+       sizeof(city_t) + sizeof(unsigned char) + sizeof(unsigned int) )
+    error("BuildNeighbourTable: neighbour cache budget of %g bytes is "
+          "too small for %d cities", (double)budget, (int)ncities);
+  row_slots = ((size_t)budget - ncities*sizeof(int)) /
+              (row_bytes + sizeof(city_t) + sizeof(unsigned char) +
+               sizeof(unsigned int));
+
+  neighbour_table = (city_t *)malloc(row_bytes*row_slots);
+  row_slot  = (int *)malloc(sizeof(int)*ncities);
+  slot_city = (city_t *)malloc(sizeof(city_t)*row_slots);
+  slot_ref  = (unsigned char *)calloc(row_slots, sizeof(unsigned char));
+  slot_seq  = (unsigned int *)calloc(row_slots, sizeof(unsigned int));
+  if (!neighbour_table || !row_slot || !slot_city || !slot_ref || !slot_seq)
+    error("BuildNeighbourTable: could not allocate neighbour cache");
+  for (i=0; i<ncities; i++)
+    row_slot[i] = -1;
+  for (i=0; i<row_slots; i++)
+    slot_city[i] = ncities;                        /* i.e. an empty slot */
+  clock_hand = 0;
+  row_hits = row_misses = row_evictions = 0;
+}
+
+int GetNeighbourCacheStats(unsigned long *stats){
+  stats[0] = row_hits;
+  stats[1] = row_misses;
+  stats[2] = row_evictions;
+  return row_slots;
+}
+
+void ShareNeighbourTable(void){
+  if (grid_start == NULL)
+    BuildSpatialGrid();
+  row_shared = (row_slots > 0);             /* full tables are read only */
+}
+
+void FreeNeighbourTable(void){
+  free(neighbour_table);
+  free(row_slot);
+  free(slot_city);
+  free(slot_ref);
+  free(slot_seq);
+  neighbour_table = NULL;
+  row_slot  = NULL;
+  slot_city = NULL;
+  slot_ref  = NULL;
+  slot_seq  = NULL;
+  row_slots = 0;
+  row_shared = 0;
+  nneighbours = 0;
+}
+
 #define FRCONSTANT1 600
 #define FRCONSTANT2 0.5
 #define FRCONSTANT3 0.5
-void FloydRivestSelect(unsigned short left, unsigned short right, unsigned short k){
-  unsigned short i;
-  unsigned short n;
-  unsigned short j;
-  unsigned short pivot_index;
+void FloydRivestSelect(city_t left, city_t right, city_t k){
+  city_t i;
+  city_t n;
+  city_t j;
+  city_t pivot_index;
   double pivot;
   double sd;
   double z;
@@ -82,7 +848,7 @@ void FloydRivestSelect(unsigned short left, unsigned short right, unsigned short
   }
 }
 
-void swap_inplace(unsigned short left, unsigned short right){
+void swap_inplace(city_t left, city_t right){
   dist_and_city _  = distances[left];
   distances[left]  = distances[right];
   distances[right] = _;
@@ -1,30 +1,171 @@
-typedef struct{
-  double coord_x;
-  double coord_y;
-} coord;
+#ifndef EDGE_WT_INCLUDED
+#define EDGE_WT_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* SRV 2026-10-17: city ids and tour positions are city_t, 16 bits wide   *
+ * (at most 65535 cities) unless built with WIDE_CITIES=on; 32 bits       *
+ * double the tours, neighbour rows and mixing messages, which small      *
+ * instances, the common case, would pay for without any need            */
+#ifdef WIDE_CITIES
+typedef uint32_t city_t;
+#define CITY_MAX UINT32_MAX
+#else
+typedef uint16_t city_t;
+#define CITY_MAX UINT16_MAX
+#endif
+
+/* SRV 2026-10-17: city coordinates are kept as two separate arrays of    *
+ * coord_t (structure of arrays); building with FLOAT_COORDS=on makes      *
+ * them floats, which halves their size; sums stay in double or long long */
+#ifdef FLOAT_COORDS
+typedef float  coord_t;
+#else
+typedef double coord_t;
+#endif
+
+#define COORD_ALIGN 64         /* city_x and city_y start on a cache line */
 
 typedef struct distance_from_city_struct
 {
   double distance;
-  unsigned short city;
+  city_t city;
 }
 dist_and_city;
 
 
-unsigned short ncities;
-coord *node_coords;
+/* SRV 2026-10-17: edge parameters, read from the optional $edge_parameters *
+ * section of the .params file (see ReadEdgeParameters in tsp_sa.c)        */
+#define NEIGHBOUR_K_DEFAULT 32    /* default length of the neighbour lists */
+#define DIST_MATRIX_BYTES_DEFAULT (64L<<20) /* distance matrix memory cap */
+
+/* SRV 2026-10-17: the order in which cities are numbered (and stored)   *
+ * internally; along a space filling curve close cities are close in     *
+ * memory too; output always uses the ids (line order) of the .tsp file  */
+typedef enum { FILE_ORDER, HILBERT_ORDER, MORTON_ORDER } CityOrder;
+
+typedef struct {
+  unsigned short neighbour_k;     /* nearest neighbours kept per city RO */
+  long   neighbour_cache_bytes;  /* per-rank byte budget for the lists, */
+                                 /* 0 means no limit                 RO */
+  long   distance_matrix_bytes;  /* use a distance matrix if it fits    */
+                                 /* into this; 0 means never         RO */
+  int    city_order;             /* a CityOrder: 0 file, 1 Hilbert,     */
+                                 /* 2 Morton                         RO */
+} EdgeParms;
+
+city_t ncities;
+coord_t *city_x;                   /* x coordinates, by (internal) city id */
+coord_t *city_y;                   /* y coordinates, by (internal) city id */
 
-dist_and_city *distances;
+/* scratch of the neighbour queries: each thread (chain) has its own, the *
+ * rest of the instance (coords, neighbour rows, matrix) is shared         */
+extern __thread dist_and_city *distances;
+
+/* length of the neighbour rows: entry j-1 of the row of city c is the     *
+ * j-th nearest neighbour of c (c itself is rank 0 and is not kept)        */
+unsigned short nneighbours;
+
+/* SRV 2026-10-17: the TSPLIB EDGE_WEIGHT_TYPE of the instance; EUC_RAW  *
+ * (unrounded Euclidean) is what we always did, and stays the default if   *
+ * the .tsp file has no EDGE_WEIGHT_TYPE line                              */
+typedef enum { EUC_RAW, EUC_2D, CEIL_2D, ATT, GEO } EdgeWeightType;
+
+EdgeWeightType edge_weight_type;
 
 /*Static Variables Needed in move.c and others */
-int GetJthNearestNeighbour(unsigned short home, unsigned short j);
+int GetJthNearestNeighbour(city_t home, city_t j);
+
+void FloydRivestSelect(city_t left, city_t right, city_t k);
 
-void FloydRivestSelect(unsigned short left, unsigned short right, unsigned
-short k);
+/*** GetDistance: unrounded Euclidean distance between cities a and b ******
+ ***************************************************************************/
+double GetDistance(city_t a, city_t b);
 
-double GetDistance(coord A, coord B);
+/*** AllocCoords: allocates (aligned and zeroed) city_x and city_y for n ***
+ *                cities; FreeCoords frees them again                      *
+ ***************************************************************************/
+void AllocCoords(city_t n);
+
+void FreeCoords(void);
 
 void FreeDistances();
 
+/*** CityDistance: weight of the edge between cities a and b in the edge **
+ *                 weight type of the instance; not for inner loops        *
+ ***************************************************************************/
+double CityDistance(city_t a, city_t b);
+
+/*** EdgeDelta: weight of the nadd edges (a[i], b[i]), nrem <= i < nrem+   *
+ *              nadd, minus that of the nrem edges (a[i], b[i]), i < nrem; *
+ *              integer metrics are summed exactly; points to the kernel   *
+ *              for the metric and storage, picked by BuildDistanceMatrix  *
+ ***************************************************************************/
+extern double (*EdgeDelta)(const city_t *a, const city_t *b,
+                           int nrem, int nadd);
+
+/*** EdgeWeights: w[i] = weight of the edge (a[i], b[i]), i < n, in the ***
+ *                precision of EdgeDelta; picked along with it             *
+ ***************************************************************************/
+extern void (*EdgeWeights)(const city_t *a, const city_t *b,
+                           int n, double *w);
+
+/*** EdgeWeightName: the TSPLIB name of edge_weight_type ******************/
+const char *EdgeWeightName(void);
+
+/*** BuildDistanceMatrix: fills the distance matrix if it takes at most **
+ *                        max_bytes (0 means never) and picks EdgeDelta;   *
+ *                        returns 1 if the matrix is used, 0 if distances  *
+ *                        stay on the fly                                  *
+ ***************************************************************************/
+int BuildDistanceMatrix(long max_bytes);
+
+void FreeDistanceMatrix(void);
+
+/*** BuildNeighbourTable: sets up the rows of the k nearest cities of all **
+ *                        cities; if they all fit into budget bytes (or    *
+ *                        budget is 0) they are computed right away, else  *
+ *                        a cache of as many rows as fit is set up and the *
+ *                        rows are filled on first use; needs the coords   *
+ *                        and distances; k is clipped to ncities-1         *
+ ***************************************************************************/
+void BuildNeighbourTable(unsigned short k, long budget);
+
+/*** GetNeighbourCacheStats: puts the row cache hits, misses and evictions *
+ *                           into stats[0..2] and returns the number of    *
+ *                           cache slots (0 if all rows are precomputed);  *
+ *                           the hits are the calling thread's, the rest   *
+ *                           are the rank's                                *
+ ***************************************************************************/
+int GetNeighbourCacheStats(unsigned long *stats);
+
+void FreeNeighbourTable(void);
+
+/*** ShareNeighbourTable: makes the neighbour queries safe for threads that *
+ *                        share the table: builds the grid now rather than *
+ *                        on first use and locks the row cache, if any    *
+ ***************************************************************************/
+void ShareNeighbourTable(void);
+
+/*** RenumberCities: sorts the cities along the given space filling ********
+ *                   curve and remembers the file id of every city; has   *
+ *                   to come before anything that stores city ids         *
+ ***************************************************************************/
+void RenumberCities(CityOrder order);
+
+/*** OriginalCity: the id city c has in the .tsp file (c if not renumbered)*
+ ***************************************************************************/
+city_t OriginalCity(city_t c);
+
+void FreeCityLabels(void);
+
+/*** FreeSpatialGrid: frees the uniform grid over the cities which the *****
+ *                    neighbour queries build on first use                 *
+ ***************************************************************************/
+void FreeSpatialGrid(void);
+
 __attribute__((always_inline))
-void swap_inplace(unsigned short left, unsigned short right);
+void swap_inplace(city_t left, city_t right);
+
+#endif
@@ -24,15 +24,13 @@
 * is passed in and its cost returned.        *
 **********************************************/
 
-double tour_cost(unsigned short*tour_pointer)
+double tour_cost(city_t*tour_pointer)
 {  /* begin tour_cost*/
-int i; /*loop counter */
  double cost = 0;  /*cost of tour*/
-for ( i=0; i<ncities-1; i++)
-  {/*begin for */
-  cost += GetDistance(node_coords[tour_pointer[i]], node_coords[tour_pointer[i+1]]) ;
-  } /*end for */
-cost += GetDistance(node_coords[tour_pointer[0]],node_coords[tour_pointer[ncities-1]]) ;
+ /* SRV 2026-10-17: all the open edges (tour[i], tour[i+1]) in one go, *
+  * summed exactly for the integer edge weight types                   */
+ cost  = EdgeDelta(tour_pointer, tour_pointer+1, 0, ncities-1);
+ cost += CityDistance(tour_pointer[0], tour_pointer[ncities-1]) ;
  return cost;
 }  /* end tour_cost*/
 
@@ -60,9 +58,11 @@ void ReadTSP (FILE *infile) { /* begin ReadTSP instance file */
   bool ReadingNodeCoordData = false;
   bool ReadingCoordinateData = false;
   /*   double floatdata = 0.0; memory hog */
-  float x,y;
+  double x,y;       /* SRV 2026-10-17: double, TSPLIB rounds on these */
   int i = 0;
+  char *typename;
   int _index;
+  long dimension;                                   /* DIMENSION as read */
   char stringdata[180];
 
 /* heading names for TSP LIB files */
@@ -79,6 +79,7 @@ void ReadTSP (FILE *infile) { /* begin ReadTSP instance file */
   if( !infile )
     error("ReadTSP: could not locate input file\n");
 
+   edge_weight_type = EUC_RAW;            /* if there is no header line */
    stringdata[0]=0;
    while ((strstr(stringdata, "EOF")== NULL) && (strstr(stringdata, "$$$")==NULL))
    {
@@ -97,9 +98,9 @@ void ReadTSP (FILE *infile) { /* begin ReadTSP instance file */
          for (i = 0; i < ncities; ++i)
          { 
            fgets(stringdata,180,infile);
-           sscanf(stringdata, "%d %f %f", &_index, &x, &y);
-           node_coords[i].coord_x=x;
-           node_coords[i].coord_y=y;
+           sscanf(stringdata, "%d %lf %lf", &_index, &x, &y);
+           city_x[i]=x;
+           city_y[i]=y;
             
          }   /*  endfor edge weights in lower triangular form */
          ReadingNodeCoordData = false;
@@ -119,12 +120,33 @@ void ReadTSP (FILE *infile) { /* begin ReadTSP instance file */
          DimensionString[loop1] = '\0';  /* null character */
 
           /* convert the problem dimension to integer */
-         ncities = atoi (DimensionString);
-
-         node_coords=calloc(ncities, sizeof(coord));
-         if(node_coords==NULL){
-          error("tsp_sa: node_coords could not be allocated");
-         } 
+         dimension = atol (DimensionString);
+         if (dimension < 2 || dimension > CITY_MAX)
+           error("ReadTSP: DIMENSION %g is out of range for %d bit city ids%s",
+                 (double)dimension, (int)(8*sizeof(city_t)),
+                 (sizeof(city_t) < 4) ? " (build with WIDE_CITIES=on)" : "");
+         ncities = (city_t)dimension;
+
+         AllocCoords(ncities);
+      }
+      if (strstr (stringdata, "EDGE_WEIGHT_TYPE") != NULL)
+      {/* SRV 2026-10-17: get the edge weight type; not using the full   *
+        * EDGE_WEIGHT_TYPE_HEADER since the spacing around ':' varies   */
+        typename = strchr(stringdata, ':');
+        typename = typename ? typename+1 : stringdata+strlen("EDGE_WEIGHT_TYPE");
+        typename += strspn(typename, " \t");
+        typename[strcspn(typename, " \t\r\n")] = '\0';
+
+        if (!strcmp(typename, "EUC_2D"))
+          edge_weight_type = EUC_2D;
+        else if (!strcmp(typename, "CEIL_2D"))
+          edge_weight_type = CEIL_2D;
+        else if (!strcmp(typename, "ATT"))
+          edge_weight_type = ATT;
+        else if (!strcmp(typename, "GEO"))
+          edge_weight_type = GEO;
+        else
+          error("ReadTSP: unsupported EDGE_WEIGHT_TYPE %s", typename);
       }
       if (strstr (stringdata, NODE_COORD_SECTION_HEADER) != NULL)
       {  /* we're up to the edge weight section */
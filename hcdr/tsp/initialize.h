@@ -3,7 +3,7 @@
 * entire tour for all city pairs.  Any tour  *
 * is passed in and its cost returned.        *
 **********************************************/
-double tour_cost(unsigned short* tour_pointer);
+double tour_cost(city_t* tour_pointer);
 
 /***************************************************************************
 * ReadTSP  reads in the data from the input file from TSPLIB either:       *
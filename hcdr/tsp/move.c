@@ -24,10 +24,12 @@
 #include <math.h>
 #endif
 #include <ctype.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/types.h>
+#include <time.h>                      /* clock_gettime for the move costs */
 #include <unistd.h>
 
 #include "error.h"
@@ -38,26 +40,47 @@
 #include "edge_wt.h" /* included for prototypes and neighbors*/
 #include "distributions.h"   /* problem independent distributions */
 #include "initialize.h"
+#include "tour_list.h"           /* the two-level list tour (tour_list=1) */
 
 #include <mpi.h>                     /* this is the official MPI interface */
 #include "MPI.h"  /* our own structs and such only needed by parallel code */
 
 static int tour_debug=0;  /*debug flag for tours and edges */
 
+/* the adaptive operator selection (SRV 2026-10-17) */
+#define MOVE_TIME_SAMPLE 32      /* time one in this many moves, which    */
+                                 /* keeps clock_gettime (a system call    */
+                                 /* for CPU clocks) out of the rest       */
+#define MOVE_RATE_DECAY  0.3     /* weight of the newest interval's rate  */
+#define MOVE_WEIGHT_MIN  0.05    /* no operator drops below this weight   */
+#define MOVE_RATE_TINY   1e-100  /* below this the rates are all decayed  */
+                                 /* (frozen), so the weights stay put     */
 
+/* the rejection-free mode (SRV 2026-10-17) */
+#define NFOLD_MAX_MOVES  (1<<22)  /* no n-fold way for more moves than this */
+#define NFOLD_K          8        /* neighbours per city in its move set:   */
+                                  /* at the cold end theta_bar is near      */
+                                  /* THETA_MIN, so moves seldom reach past  */
+                                  /* these, and an accepted move costs O(K) */
+#define NFOLD_S_SLACK    0.05     /* the acceptances get recomputed once S  */
+                                  /* is this much above the S they are for  */
+#define NFOLD_ACC_DECAY  0.05     /* acc_ratio of a tau is noisy: switch by */
+                                  /* its moving average, with this weight   */
 
 
-/*** STATIC VARIABLES ******************************************************/
 
-static AParms    ap;                /* static copy of annealing parameters */
 
-/* SRV 2025-11-16 made acc_tab no longer a pointer and made it into
- * the actual struct itself */
-static AccStats  acc_tab;   /* struct to accumulate acceptance statistics */
+/*** STATIC VARIABLES ******************************************************/
 
-static unsigned  int    nhits;    /* number of moves since the start of execution */
-static unsigned int    nsweeps;     /* number of sweeps since start of execution */
+static AParms    ap;                /* static copy of annealing parameters */
+static EdgeParms ep;          /* static copy of neighbour/edge parameters */
+static MoveParms mp;                    /* static copy of move parameters */
+static int dist_matrix_used;     /* 1 if BuildDistanceMatrix made a matrix */
 
+/* SRV 2026-10-17: the tour, the acceptance stats and the rest of what a  *
+ * chain changes as it anneals live in its MoveContext (see move.h), which *
+ * every function below that needs them gets passed as mc; what is static  *
+ * in here is the same for all chains                                      */
 
 static int       prolix;           /* flag for printing stat info (prolix) */
                                    /* value of zero means no trace */
@@ -65,24 +88,10 @@ static char      *prolixfile;                   /* filename of prolix file */
 
 static MPI_Aint nbytes;
 static MPI_Aint size_arr;
+static MPI_Aint size_len;                  /* bytes of edge_len in messages */
 
 /*** TSP TOUR VARIABLES ******************************************************/
 
-/* Edited by seb: Changed shorts to ints because some of the test problems are massive */
-static unsigned short *curr_tour_and_pos = NULL;
-
-static unsigned short *curr_tour = NULL;  /* pointer to tour of city ids 
-                                  in current order visited*/ 
-static unsigned short *curr_position = NULL;  /* maintains the current tour position 
-                               for each city*/
-                    /*index is city id-1 element is curr_tour index */ 
-static unsigned short swap[2];  /* array of indices of swapped elements in tour*/ 
-static int *min_tour = NULL;  /* pointer to the minimum annealing tour 
-                                 found so far-not really SA methodology*/ 
-static double curr_cost = 0.0;  /*cost of the current tour*/ 
-static double new_cost = 0.0;  /* cost of the proposed new tour*/ 
-static double min_cost = 0.0;  /* cost of the minimum tour found so far 
-                                  for fun-not really SA methodology*/
 static double tour_max = 0.0;  /* max index into tour array */
 static double neighbor_max = 0.0; /* max number for furthest neighbor 
                                     this is the max move size */
@@ -92,6 +101,15 @@ static int neighbor_maxint = 0; /* integer value max number for
 
 /*** FUNCTIONS *************************************************************/
 
+static int SwapEdges(MoveContext *mc, city_t *tour, city_t *swap, city_t *from, city_t *to,
+                     double *removed);
+static int TwoOptEdges(MoveContext *mc, city_t *tour, city_t *swap, city_t *from, city_t *to,
+                       double *removed);
+static int OrOptEdges(MoveContext *mc, city_t *tour, city_t *swap, int len, city_t *from,
+                      city_t *to, double *removed);
+static double NextCandidate(MoveContext *mc);
+static void NFoldUpdate(MoveContext *mc);
+
 
 /*** INITIALIZING AND RESTORING FUNCTIONS **********************************/
 
@@ -125,24 +143,63 @@ void InitTSP (FILE *infile) { /* begin InitTSP */
 
 
 
+/*** NewMoveContext: allocates the moves of the chain an and starts their *
+ *                   acceptance stats and operator registry; acc_tab used  *
+ *                   to be set up by InitMoves (SRV 2026-10-17)            *
+ ***************************************************************************/
+static MoveContext *NewMoveContext(Annealer *an)
+{
+  MoveContext *mc;
+
+  mc = (MoveContext *)calloc(1, sizeof(MoveContext));
+  if (mc == NULL)
+    error("NewMoveContext: could not allocate the move state");
+  mc->an = an;
+
+  mc->acc_tab.theta_bar = (floor (ncities/2));
+  /* THETA_INIT varies by tsp instance so cannot be a constant */
+  /* so do not use: acc_tab->theta_bar = THETA_INIT; */
+  mc->acc_tab.hits      = 0;
+  mc->acc_tab.success   = 0;
+  mc->or_acc_tab.theta_bar = THETA_MIN;     /* Or-opt likes its cities close */
+  mc->or_acc_tab.hits      = 0;
+  mc->or_acc_tab.success   = 0;
+  mc->ranks.theta_bar      = -1.;           /* no buffer of ranks made yet */
+  mc->ranks.next           = RANK_BUFFER;
+  mc->or_ranks.theta_bar   = -1.;
+  mc->or_ranks.next        = RANK_BUFFER;
+  mc->move_kind = SWAP_MOVE;
+  mc->or_len    = 1;
+  mc->nfold_acc = -1.;
+  InitMoveOps(mc);
+
+  mc->nhits   = 0;
+  mc->nsweeps = 0;
+  return mc;
+}
+
+
 /***********************************************
 * allocates dynamic memory for the tour arrays.*
 * Tours are 1 by dimension data structures.    *
 * called by input_lib in tsp_sa.c              *
 ************************************************/
- int tour_allocate(void)
+ int tour_allocate(MoveContext *mc)
 {  /* begin tour_allocate */
-    curr_tour_and_pos=(unsigned short*) malloc (sizeof (unsigned short) * 2* ncities);   
-if (curr_tour_and_pos == NULL)
+    mc->curr_tour_and_pos=(city_t*) malloc (sizeof (city_t) * 2* ncities);   
+if (mc->curr_tour_and_pos == NULL)
          return 1;
-    curr_tour = curr_tour_and_pos;
-    curr_position=curr_tour_and_pos+ncities;
-   if (curr_position == NULL)
+    mc->curr_tour = mc->curr_tour_and_pos;
+    mc->curr_position=mc->curr_tour_and_pos+ncities;
+   if (mc->curr_position == NULL)
+      return 1;
+    mc->edge_len = (double *) malloc (sizeof (double) * ncities);
+   if (mc->edge_len == NULL)
       return 1;
  if (tour_debug) 
 { /* begin debug */
-      min_tour = ( unsigned short*) malloc (sizeof (unsigned short) * ncities);
-   if (min_tour == NULL)
+      mc->min_tour = ( city_t*) malloc (sizeof (city_t) * ncities);
+   if (mc->min_tour == NULL)
       return 1;
 } /* end debug */
     return 0;
@@ -152,13 +209,18 @@ if (curr_tour_and_pos == NULL)
 /*******************************************
 * come up with a starting tour and set min *
 * mindlessly assign cities is numeric order*
+* for the chain an, whose moves (an->move) *
+* it sets up first;                        *
 * returns starting energy (cost)           *
 ********************************************/
-double StartTour( void )
+double StartTour(Annealer *an)
 {  /* begin start_tour*/
 
 int i; /*loop counter */
 FILE *debugptr = NULL; /* pointer for tour debug file */
+MoveContext *mc = NewMoveContext(an);
+
+an->move = mc;
 
 /*************************************************/
 /* curr_tour contains city ids                   */
@@ -167,34 +229,36 @@ FILE *debugptr = NULL; /* pointer for tour debug file */
 /*************************************************/
 /* again, why is this function here? (Aug 2 2024 SRV) */
 //init_cost();
-if (tour_allocate()==1)
+if (tour_allocate(mc)==1)
   error("Error in allocating memory for tour");
 
+/* SRV 2026-10-17: still the .tsp file order if the cities got renumbered */
+for ( i=0; i<ncities; i++)
+  {/*begin for */
+    mc->curr_tour [OriginalCity(i)] = i;     /* curr_tour contains city_id */
+  } /*end for */
 for ( i=0; i<ncities; i++)
   {/*begin for */
-    curr_tour [i] = i;     /* curr_tour contains city_id */
-                             /* index is one less than city_id */
-    curr_position [i] = i;   /* curr_position contains an index (not city_id) */
+    mc->curr_position [mc->curr_tour[i]] = i;   /* curr_position contains an index (not city_id) */
   } /*end for */
 
  /* let's get the cost */
- curr_cost = tour_cost(curr_tour);
+ mc->curr_cost = tour_cost(mc->curr_tour);
+ for ( i=0; i<ncities; i++)
+   mc->edge_len [i] = TourEdge(mc->curr_tour, i);
+ if (mp.tour_list)             /* from here on the list is the real tour */
+   mc->tl = TourListBuild(mc->tl, mc->curr_tour, mc->edge_len);
 
  if (tour_debug) 
    { /* begin debug */
      /* first tour is min tour found so far only for fun, so not for everytime*/
-     min_cost = curr_cost ;
+     mc->min_cost = mc->curr_cost ;
      for ( i=0; i<ncities; i++)
        {/*begin for */
-           min_tour [i] = curr_tour [i];
+           mc->min_tour [i] = mc->curr_tour [i];
        } /*end for */
     } /* end debug */
 
-    /* set up max for random swap and neighbor generators */
-    tour_max = (double) (ncities-1);      /* max index into tour array */
-    neighbor_max = (double) (ncities-2);  /* for now use all neighbors */
-    neighbor_maxint = ncities -2;  /* for now use all neighbors */
-
   if (tour_debug) 
     { /* begin debug */
     debugptr = fopen("tour_debug", "w");
@@ -207,23 +271,23 @@ for ( i=0; i<ncities; i++)
 
 	/* let's print tour we have */
 	fprintf(debugptr,"\n The Starting Tour and cost is:");
-	print_curr_tour (debugptr);
+	print_curr_tour (mc, debugptr);
         fclose(debugptr);
     } /* end debug */
 
- return curr_cost;
+ return mc->curr_cost;
  }  /* end start_tour*/
 
 
 /****************************************
 * init_cost initializes tour costs to 0 *
 *****************************************/
- void init_cost(void)
+ void init_cost(MoveContext *mc)
 {  /* begin init_cost*/
-   min_cost = 0;
-   curr_cost = 0;
-   new_cost = 0;
-   swap[0] = swap[1] = 0;
+   mc->min_cost = 0;
+   mc->curr_cost = 0;
+   mc->new_cost = 0;
+   mc->swap[0] = mc->swap[1] = 0;
 }  /* end init_cost*/
 
 
@@ -231,20 +295,15 @@ for ( i=0; i<ncities; i++)
  *** InitMoves: initializes the following moves.c-specific stuff:      *****
  *              - static annealing parameter struct (ap)                   *
  *              - initializes random number generator in lsa.c             *
- *              - initializes acc_tab for acceptance statistics            *
  *              - initializes distances for nmin                           *
+ *              - builds the nearest neighbour lists (edge_wt.c)           *
+ *              - builds the distance matrix, if it is small enough        *
  *                                                                         *
  *              it then returns the initial temperature to the caller      *
  ***************************************************************************/
 
 double InitMoves(FILE *fp, int Tau)
 {  /* begin init moves */
-   unsigned short *xsubj; 
-   long seedval;
-   unsigned short left16, middle16;
-   int left;
-
-      xsubj = (unsigned short *)calloc(3, sizeof(unsigned short));
 
 /* read annealing paramters */
 
@@ -257,46 +316,73 @@ double InitMoves(FILE *fp, int Tau)
   if ( equil == 1 )   /* read equilibration params and put them into lsa.c */
       InitEquilibrate(fp);
  
-/* initialze the random number generator, now erand48() */
+/* initialze the random number generator: each processor gets a stream  *
+ * of its own (SRV 2026-10-17: streams, not neighbouring seeds)           */
 
 #ifdef MPI
-  seedval  = ap.seed + myid;       /* each processor gets a different seed */
+  InitRandom((uint64_t)ap.seed, RAND_STREAM(myid, 0));
 #else
-  seedval  = ap.seed;
+  InitRandom((uint64_t)ap.seed, RAND_STREAM(0, 0));
 #endif
 
-  xsubj[0] = LOWBITS;
+/* acc_tab is for statistics like acceptance ratio etc. */
 
-  middle16 = (unsigned short)seedval;
-  xsubj[1] = middle16;
+    distances = (dist_and_city *)calloc(ncities, sizeof(dist_and_city));
 
-  left     = seedval >> (BYTESIZE * sizeof(unsigned short));
-  left16   = (unsigned short)left;
-  xsubj[2] = left16;
+/* set up max for random swap and neighbor generators; these used to be   *
+ * set by StartTour, but they are the same for all chains (SRV)           */
+    tour_max = (double) (ncities-1);      /* max index into tour array */
+    neighbor_max = (double) (ncities-2);  /* for now use all neighbors */
+    neighbor_maxint = ncities -2;  /* for now use all neighbors */
 
-  InitERand(xsubj);        /* makes the xsubj array static to random.c */
+/* precompute the nearest neighbour lists once, so that GenerateMove only  *
+ * pays for a full neighbour selection on the rare far moves (SRV 2026)    */
+  ep = ReadEdgeParameters(fp);
+  mp = ReadMoveParameters(fp);
+  if (mp.tour_list)             /* batches keep track of tour positions, */
+    mp.batch_size = 1;          /* which the list tour does not have     */
+  RenumberCities((CityOrder)ep.city_order);   /* before any ids are kept */
+  BuildNeighbourTable(ep.neighbour_k, ep.neighbour_cache_bytes);
 
-/* acc_tab is for statistics like acceptance ratio etc. */
-
-    distances = (dist_and_city *)calloc(ncities, sizeof(dist_and_city));
-  acc_tab.theta_bar = (floor (ncities/2));
-  /* THETA_INIT varies by tsp instance so cannot be a constant */
-  /* so do not use: acc_tab->theta_bar = THETA_INIT; */
-  acc_tab.hits      = 0;
-  acc_tab.success   = 0;
- 
-  nhits   = 0;
-  nsweeps = 0;
+/* small enough instances get a distance matrix for calc_new_cost and     *
+ * tour_cost; this has to happen before StartTour computes curr_cost     */
+  dist_matrix_used = BuildDistanceMatrix(ep.distance_matrix_bytes);
 
   /* Initialize some byte info that we will need later 
    * for state messages */
-  size_arr=ncities*2*sizeof(unsigned short);
-  nbytes = 2*sizeof(unsigned char) + sizeof(unsigned short) +
-  size_arr+ 2*sizeof(unsigned int) + 2*sizeof(double);
+  size_arr=ncities*2*sizeof(city_t);
+  size_len=ncities*sizeof(double);
+  nbytes = sizeof(unsigned char) + sizeof(city_t) + size_len +
+  size_arr+ 4*sizeof(unsigned int) + 3*sizeof(double) +
+  2*NMOVE_OPS*sizeof(double);
 /* Finally, return the start temperature. */
   return ap.start_tempr;
 }  /* end init moves */
 
+/*** InitThreadMoves: what InitMoves sets up per thread, for the chains ***
+ *                    that thread 1.. of a rank runs (hybrid mode): its    *
+ *                    stream of random numbers and its scratch for the     *
+ *                    neighbour queries; FreeThreadMoves frees the latter  *
+ ***************************************************************************/
+
+void InitThreadMoves(int thread)
+{
+#ifdef MPI
+  InitRandom((uint64_t)ap.seed, RAND_STREAM(myid, thread));
+#else
+  InitRandom((uint64_t)ap.seed, RAND_STREAM(0, thread));
+#endif
+  distances = (dist_and_city *)calloc(ncities, sizeof(dist_and_city));
+  if (distances == NULL)
+    error("InitThreadMoves: could not allocate distances");
+}
+
+void FreeThreadMoves(void)
+{
+  free(distances);
+  distances = NULL;
+}
+
 /*** RestoreMoves: restores move generator from state file *****************
  *           NOTE: InitMoves will be called before this function during    *
  *                 a restore                                               *
@@ -342,30 +428,92 @@ void RestoreProlix(void)
  *                 data file                                               *
  ***************************************************************************/
 
-AParms GetFinalInfo(void)
+AParms GetFinalInfo(MoveContext *mc)
 {
-  ap.stop_energy = curr_cost;
-  ap.max_count   = nhits;
+  AParms info = ap;            /* a copy: ap is the same for all chains */
+
+  info.stop_energy = mc->curr_cost;
+  info.max_count   = mc->nhits;
 
-  return ap;
+  return info;
 }
 
  /**************************************************
 * deallocates dynamic memory for the tour arrays   *
+* and the rest of the chain's moves (mc itself)    *
 * called by final move in tsp_s.c                  *
 ****************************************************/
- void tour_deallocate(void)
+ void tour_deallocate(MoveContext *mc)
 {  /* begin tour_deallocate */
 if (tour_debug) 
 { /* begin debug */
-   free (min_tour);
+   free (mc->min_tour);
 } /* end debug */
-    free (curr_tour_and_pos);
+    free (mc->curr_tour_and_pos);
+    free (mc->edge_len);
+    TourListFree(mc->tl);
+    free (mc->nfold_to);
+    free (mc->nfold_rev_start);
+    free (mc->nfold_rev);
+    free (mc->nfold_rate);
+    free (mc->nfold_tree);
+    free (mc);
 }  /* end tour_deallocate */
 
 
+/*** FlattenTour: with tour_list, brings curr_tour, curr_position and ****
+ *                edge_len up to date with the list tour, for output and   *
+ *                mixing; they are not kept up to date move by move        *
+ ***************************************************************************/
+static void FlattenTour(MoveContext *mc)
+{
+  if (mp.tour_list)
+    TourListFlatten(mc->tl, mc->curr_tour, mc->curr_position, mc->edge_len);
+}
+
+
 /*** MOVE GENERATION - PART 1: FUNCS NEEDED IN LSA.C ***********************/
 
+/*** ElapsedNs: CPU nanoseconds this thread spent since *t0; wallclock ***
+ *               time would also count whatever else ran on the core       *
+ ***************************************************************************/
+
+static double ElapsedNs(struct timespec *t0)
+{
+  struct timespec t1;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+  return 1e9 * (double)(t1.tv_sec - t0->tv_sec) +
+         (double)(t1.tv_nsec - t0->tv_nsec);
+}
+
+/*** SelectMoveOp: draws the kind of the next move from the operator ******
+ *                 weights; no random number if there is only one kind     *
+ ***************************************************************************/
+
+static int SelectMoveOp(MoveContext *mc)
+{
+  int    k, last = 0;
+  double xi;
+
+  if (mc->nmove_ops_used == 1) {
+    for (k=0; mc->move_ops[k].weight <= 0.; k++)
+      ;
+    return k;
+  }
+  xi = RandomReal();
+  for (k=0; k<NMOVE_OPS; k++){
+    if (mc->move_ops[k].weight > 0.) {
+      last = k;
+      if (xi < mc->move_ops[k].weight)
+        return k;
+      xi -= mc->move_ops[k].weight;
+    }
+  }
+  return last;                      /* the weights summed to just below 1 */
+}
+
+
 /* GenerateMove: wrapper for Move makes a move and returns difference of    *
  * energies before and after the move          *
  ***************************************************************************/
@@ -382,29 +530,18 @@ if (tour_debug)
 * return the difference in cost curr_cost-new_cost*
 **************************************************/
 
-double GenerateMove()
+double GenerateMove(Annealer *an)
 {  /* begin GenerateMove*/
-  /* delta_e is the change in energy returned as function value */
- /* it is the difference in the cost of the current tour and the new tour*/
-  double delta_e = 0.0;
-  double xi;  /* uniform random variable for move control */
-  double theta; /* move control variable to pick neighbors*/
-  int i = 0;
-  int j = 0;
-  unsigned short city_id;  /*city id for swap */
-
-/* make a move, get energy and return delta_e */
-
-
+  MoveContext *mc = an->move;                       /* the chain's moves */
+  MoveOp *op;                           /* the move operator we try this time */
+  struct timespec t0;                                   /* for timed moves */
 
 /* increase counters */
 /* SRV Nov 19 2025 - switching nhits to be after nsweeps *
  * in order to force UpdateControl to only occur after   *
  * communication steps.                                  */
-  acc_tab.hits++;
-
-  nhits++;
-  nsweeps=  (nhits) * lam_group_size;   /* calculate number of sweeps */
+  mc->nhits++;
+  mc->nsweeps=  (mc->nhits) * lam_group_size;   /* calculate number of sweeps */
 /* update statistics if interval passed & at least one sweep completed */
 
 /* Seb RV August 1st 2024: Changed this to happen after nsweeps is 
@@ -414,6 +551,78 @@ double GenerateMove()
  /* Removed all of this logic entirely. UpdateControl can only occur 
  during an update_stats step. Seb RV Nov 19 2025 */
 
+ /* SRV 2026-10-17: pick a move operator by weight (only draw if there is  *
+  * a choice, so swap-only runs keep their random number sequence), then  *
+  * let it propose a move and weigh it; every MOVE_TIME_SAMPLE-th move is  *
+  * timed for the operator's cost per move                                 */
+  if (mp.batch_size > 1) {
+    mc->new_cost = NextCandidate(mc);
+    if (mc->new_cost == FORBIDDEN_MOVE)                    /* a null move */
+      return FORBIDDEN_MOVE;
+    return mc->new_cost - mc->curr_cost;
+  }
+
+  mc->move_kind = SelectMoveOp(mc);
+  op        = mc->move_ops + mc->move_kind;
+
+  mc->move_timed = !(mc->nhits % MOVE_TIME_SAMPLE);
+  if (mc->move_timed)
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+
+  op->proposed++;
+  op->propose(mc);
+  mc->new_cost = op->delta(mc);
+
+  if (mc->move_timed) {
+    op->ns += ElapsedNs(&t0);
+    op->timed++;
+  }
+
+  if (mc->new_cost == FORBIDDEN_MOVE)                    /* a null move */
+    return FORBIDDEN_MOVE;
+  return mc->new_cost - mc->curr_cost;
+
+ }  /* end generate_move*/
+
+
+/*** FillRanks: draws the next RANK_BUFFER move sizes of DrawNeighbour- *
+ *               Move for rb in one go with generate_devs: for theta_bar 1 *
+ *               if the distribution just scales with theta_bar (then they *
+ *               outlast the theta_bar changes of UpdateControl), else for *
+ *               the theta_bar of rb                                       *
+ ***************************************************************************/
+
+static void FillRanks(MoveContext *mc, RankBuffer *rb)
+{
+  int    k;
+  struct timespec t0;           /* the whole fill is timed, for the .log */
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+
+  generate_devs(rb->scale > 0. ? 1. : rb->theta_bar, rb->theta, RANK_BUFFER);
+
+  /* tsp needs a positive value for theta (distributions 7 and 11 are *
+   * symmetric, the others tsp_sa allows are positive anyway)          */
+  for (k=0; k<RANK_BUFFER; k++)
+    rb->theta[k] = fabs(rb->theta[k]);
+  rb->next = 0;
+
+  mc->rank_ns += ElapsedNs(&t0);
+}
+
+
+/*** DrawNeighbourMove: the proposal all our operators share: *i is a *****
+ *                      uniform tour position and the other end will be  *
+ *                      the *j-th nearest neighbour of tour[*i], with *j *
+ *                      drawn around the theta_bar of stats (Lam); this  *
+ *                      only draws the numbers, ResolveNeighbourMove     *
+ *                      looks them up in the tour                        *
+ ***************************************************************************/
+
+static void DrawNeighbourMove(MoveContext *mc, AccStats *stats, int *i, int *j)
+{
+  RankBuffer *rb;
+  double theta; /* move control variable to pick neighbors*/
 
 /* now generate new micro state */
 /* ThermoDynamics! (/s) Seb RV 2024 */
@@ -425,17 +634,27 @@ double GenerateMove()
 ***************************************************************************/
 
   /*pick first tour index randomly */
-  i=(int) RandomInt(tour_max);  /* uniform dist i=[0, prob_dimension-1] */
-
-  /* control the neighbor pick the lam way */
-  theta = generate_dev(acc_tab.theta_bar, DistP.distribution, DistP.q); 
-
-  if (DistP.distribution == 7) /* tsp needs a positive value for theta */
-   {theta = fabs(theta);}
+  *i=(int) RandomInt(tour_max);  /* uniform dist i=[0, prob_dimension-1] */
+
+  /* control the neighbor pick the lam way, from the buffer of stats; when *
+   * theta_bar changes (UpdateControl, a restore) only the scale does, or, *
+   * for distributions that do not scale, the buffer is made again         */
+  rb = (stats == &mc->or_acc_tab) ? &mc->or_ranks : &mc->ranks;
+  if (rb->theta_bar != stats->theta_bar) {
+    rb->theta_bar = stats->theta_bar;
+    rb->scale     = dev_scale(rb->theta_bar);
+    if (rb->scale == 0.)
+      rb->next = RANK_BUFFER;
+  }
+  if (rb->next == RANK_BUFFER)
+    FillRanks(mc, rb);
+  theta = rb->theta[rb->next++];
+  if (rb->scale > 0.)
+    theta *= rb->scale;
+  mc->rank_n++;
 
   if (theta > neighbor_max)  /* in this case Lam used uniform dist*/
-    {xi=RandomReal();
-     theta = xi * neighbor_max;} 
+    theta = RandomReal() * neighbor_max;
 
   /*****************************************************************/
   /* round robin method is another way tried once upon a time      */
@@ -444,57 +663,649 @@ double GenerateMove()
   /*****************************************************************/
 
   /* pick a neighbor index;  0th neighbor is self so don't go there */
-   j=  (int)(ceil(theta));
+  *j=  (int)(ceil(theta));
+}
+
+
+/*** ResolveNeighbourMove: fills swap with the move drawn as i and j *****
+ ***************************************************************************/
+
+static void ResolveNeighbourMove(MoveContext *mc, int i, int j, city_t *swap)
+{
+  city_t city_id;  /*city id for swap */
 
   swap[0]=i;   /* i is index into tour (just dandy) */
   /* j= index into the row of neighbor; neighbor.to_city has 
    *    value of the city_id -1 which is what we need */
 
-  city_id = GetJthNearestNeighbour(curr_tour[i],j);  
+  /* SRV 2026-10-17: the list tour has no positions, so i is the city   *
+   * itself there (a uniform city just as well) and so is swap[1]        */
+  city_id = GetJthNearestNeighbour(mp.tour_list ? i : mc->curr_tour[i],j);  
 /***********************************************************************
  *** city_id variable is actually one less because it is the address   *
  *** the address is what we need to index position (SRV fixed this     *
  *** Aug 23 2024                                                       *
 ************************************************************************/
-    swap[1] = curr_position[city_id];
- /* let's get the cost */
- new_cost = curr_cost;
- new_cost = calc_new_cost(curr_tour, swap, new_cost);
- delta_e=new_cost - curr_cost; 
+    swap[1] = mp.tour_list ? city_id : mc->curr_position[city_id];
+}
 
- return delta_e;
 
- }  /* end generate_move*/
+/*** ProposeNeighbourMove: draws and resolves a move for the operators ****
+ *                         that use stats                                  *
+ ***************************************************************************/
 
+static void ProposeNeighbourMove(MoveContext *mc, AccStats *stats)
+{
+  int i = 0;
+  int j = 0;
 
-/*** AcceptMove: sets new energy cost and tour in current cost and tour    * 
- *               for the next step and keeps track of the number of        *
- *               successful moves for acceptance statistics                *
+  stats->hits++;
+  DrawNeighbourMove(mc, stats, &i, &j);
+  ResolveNeighbourMove(mc, i, j, mc->swap);
+}
+
+
+/*** MoveWindow: the tour positions a move reads, as up to two runs of ****
+ *               span[w] positions from lo[w] (mod ncities): the cities  *
+ *               and edge_len entries its delta needs                    *
  ***************************************************************************/
 
-void AcceptMove(void)
-{  /* begin accept_move*/
+static void MoveWindow(int kind, city_t *swap, int len, int *lo, int *span)
+{
+  int n = ncities;
+
+  switch (kind) {
+  case SWAP_MOVE:
+    lo[0] = (swap[0]-1+n) % n;   span[0] = 3;
+    lo[1] = (swap[1]-1+n) % n;   span[1] = 3;
+    break;
+  case TWO_OPT_MOVE:
+    lo[0] = swap[0];             span[0] = 2;
+    lo[1] = swap[1];             span[1] = 2;
+    break;
+  default:
+    lo[0] = (swap[0]-1+n) % n;   span[0] = len+2;
+    lo[1] = swap[1];             span[1] = 2;
+    break;
+  }
+}
+
+
+/*** MarkDirty: notes the tour positions the move in swap is about to ****
+ *              change (cities or edge_len), as one run for the 2-opt and *
+ *              Or-opt moves and two for a swap, so the candidates of the *
+ *              batch that read them get weighed again; the runs follow   *
+ *              TwoOptReverse and OrOptRelocate, null moves mark nothing  *
+ ***************************************************************************/
+
+static void MarkDirty(MoveContext *mc)
+{
+  int n = ncities;
+  int i = mc->swap[0], k = mc->swap[1];
+  int len, m;
+
+  switch (mc->move_kind) {
+  case SWAP_MOVE:
+    mc->dirty_lo[mc->ndirty] = (i-1+n) % n;   mc->dirty_span[mc->ndirty++] = 2;
+    mc->dirty_lo[mc->ndirty] = (k-1+n) % n;   mc->dirty_span[mc->ndirty++] = 2;
+    break;
+  case TWO_OPT_MOVE:
+    len = (k - i + n) % n;
+    if (len <= 1 || len == n-1)
+      break;
+    if (len <= n/2) {                 /* edges i..k, cities i+1..k */
+      mc->dirty_lo[mc->ndirty] = i;   mc->dirty_span[mc->ndirty++] = len+1;
+    } else {                          /* edges k..i, cities k+1..i */
+      mc->dirty_lo[mc->ndirty] = k;   mc->dirty_span[mc->ndirty++] = n-len+1;
+    }
+    break;
+  default:
+    len = mc->or_len;
+    if (n < len+3 || (k-i+n) % n < len || k == (i-1+n) % n)
+      break;
+    m = (k - (i+len) + 2*n) % n + 1;
+    if (m <= n-len-m) {               /* edges i-1..c, cities i..c */
+      mc->dirty_lo[mc->ndirty] = (i-1+n) % n;   mc->dirty_span[mc->ndirty++] = m+len+1;
+    } else {                          /* edges c..i+len-1, cities after c */
+      mc->dirty_lo[mc->ndirty] = k;   mc->dirty_span[mc->ndirty++] = n-m+1;
+    }
+    break;
+  }
+}
+
+
+/*** Overlap: 1 if the runs of na positions from a and nb from b meet *****
+ *            (mod ncities)                                                *
+ ***************************************************************************/
+
+static int Overlap(int a, int na, int b, int nb)
+{
+  int d = b - a;                     /* a, b < ncities: no division needed */
+
+  if (d < 0)
+    d += ncities;
+  return d < na || (d > 0 && ncities - d < nb);
+}
+
+
+/*** FillBatch: proposes batch_size moves at once: first all the random ***
+ *              numbers, in the order single moves draw them, then the    *
+ *              tour lookups, then the edges they add, which are weighed *
+ *              in a single EdgeWeights call; the removed edges come out *
+ *              of edge_len as before (SRV 2026-10-17)                    *
+ ***************************************************************************/
+
+static void FillBatch(MoveContext *mc)
+{
+  static __thread city_t from[4*MOVE_BATCH_MAX], to[4*MOVE_BATCH_MAX];
+  static __thread double w[4*MOVE_BATCH_MAX];      /* scratch, per thread */
+  static __thread int    first[MOVE_BATCH_MAX + 1];
+  MoveCandidate *c;
+  struct timespec t0;
+  double added;
+  int    b, t, timed;
+
+  timed = !(mc->nbatches++ % MOVE_TIME_SAMPLE);
+  if (timed)
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+
+  mc->batch_fill = mp.batch_size;
+  for (b=0; b<mc->batch_fill; b++){
+    c = mc->batch + b;
+    c->kind   = SelectMoveOp(mc);
+    c->or_len = 1;
+    if (c->kind == OR_OPT_MOVE)
+      c->or_len = 1 + RandomInt(OR_OPT_MAX);
+    DrawNeighbourMove(mc, mc->move_ops[c->kind].stats, &(c->i), &(c->j));
+  }
+  for (b=0; b<mc->batch_fill; b++){
+    c = mc->batch + b;
+    ResolveNeighbourMove(mc, c->i, c->j, c->swap);
+    c->city[0] = mc->curr_tour[c->swap[0]];
+    c->city[1] = mc->curr_tour[c->swap[1]];
+  }
+
+  first[0] = 0;
+  for (b=0; b<mc->batch_fill; b++){
+    c = mc->batch + b;
+    switch (c->kind) {
+    case SWAP_MOVE:
+      t = SwapEdges(mc, mc->curr_tour, c->swap, from+first[b], to+first[b],
+                    &(c->removed));
+      break;
+    case TWO_OPT_MOVE:
+      t = TwoOptEdges(mc, mc->curr_tour, c->swap, from+first[b], to+first[b],
+                      &(c->removed));
+      break;
+    default:
+      t = OrOptEdges(mc, mc->curr_tour, c->swap, c->or_len, from+first[b],
+                     to+first[b], &(c->removed));
+      break;
+    }
+    first[b+1] = first[b] + t;
+    c->null  = !t;
+    MoveWindow(c->kind, c->swap, c->or_len, c->lo, c->span);
+    c->mark  = 0;
+    c->timed = timed;
+  }
+
+  EdgeWeights(from, to, first[mc->batch_fill], w);
+
+  for (b=0; b<mc->batch_fill; b++){          /* summed in EdgeDelta's order */
+    added = 0.;
+    for (t=first[b]; t<first[b+1]; t++)
+      added += w[t];
+    mc->batch[b].added = added;
+  }
+
+  if (timed) {          /* each move gets an even share of the time */
+    added = ElapsedNs(&t0) / mc->batch_fill;
+    for (b=0; b<mc->batch_fill; b++){
+      mc->move_ops[mc->batch[b].kind].ns += added;
+      mc->move_ops[mc->batch[b].kind].timed++;
+    }
+  }
+  mc->batch_next = 0;
+  mc->ndirty     = 0;
+}
+
+
+/*** NextCandidate: GenerateMove for batch_size > 1; hands out the next ***
+ *                  move of the batch and returns its new cost, which it  *
+ *                  weighs again (one by one) if an accepted move changed *
+ *                  the tour it was weighed against; the move keeps its   *
+ *                  two cities then, so no neighbour is looked up twice;  *
+ *                  FORBIDDEN_MOVE for a null move, as its delta gives    *
+ ***************************************************************************/
+
+static double NextCandidate(MoveContext *mc)
+{
+  MoveCandidate *c;
+  MoveOp        *op;
+  int           d, w, stale = 0;
+
+  if (mc->batch_next >= mc->batch_fill)
+    FillBatch(mc);
+  c  = mc->batch + mc->batch_next++;
+  op = mc->move_ops + c->kind;
+
+  mc->move_kind  = c->kind;
+  mc->or_len     = c->or_len;
+  mc->move_timed = c->timed;
+  op->proposed++;
+  op->stats->hits++;
+
+  for (d=c->mark; d<mc->ndirty && !stale; d++)
+    for (w=0; w<2; w++)
+      if (Overlap(c->lo[w], c->span[w], mc->dirty_lo[d], mc->dirty_span[d]))
+        stale = 1;
+
+  if (stale) {
+    mc->swap[0] = mc->curr_position[c->city[0]];
+    mc->swap[1] = mc->curr_position[c->city[1]];
+    return op->delta(mc);
+  }
+  mc->swap[0] = c->swap[0];
+  mc->swap[1] = c->swap[1];
+  if (c->null)
+    return FORBIDDEN_MOVE;
+  return mc->curr_cost + c->added - c->removed;  /* as calc_new_cost adds up */
+}
+
+
+/*** TwoOptReverse: carries out the 2-opt move proposed in swap: the cities*
+ *                  tour[swap[0]+1] up to tour[swap[1]] (mod ncities) are  *
+ *                  reversed, or, if that is shorter, the rest of the tour *
+ *                  from tour[swap[1]+1] to tour[swap[0]], which gives the *
+ *                  same cycle; curr_position follows the cities and the  *
+ *                  edge lengths inside the segment are just reversed      *
+ ***************************************************************************/
+
+static void TwoOptReverse(MoveContext *mc)
+{
+  int    i = mc->swap[0], k = mc->swap[1];
+  int    len = (k - i + ncities) % ncities;      /* cities from i+1 to k */
+  int    start, t, p, q;
+  city_t hold;
+  double hold_len;
+
+  if (len <= 1 || len == ncities-1)               /* null moves, see calc_ */
+    return;                                       /* two_opt_cost          */
+  if (len <= ncities/2)
+    start = (i+1) % ncities;
+  else {
+    start = (k+1) % ncities;
+    len   = ncities - len;
+  }
+
+  for (t=0; t<len/2; t++){                     /* the cities, outside in */
+    p = (start+t) % ncities;
+    q = (start+len-1-t) % ncities;
+    hold = mc->curr_tour[p];
+    mc->curr_tour[p] = mc->curr_tour[q];
+    mc->curr_tour[q] = hold;
+    mc->curr_position[mc->curr_tour[p]] = p;
+    mc->curr_position[mc->curr_tour[q]] = q;
+  }
+  for (t=0; t<(len-1)/2; t++){         /* the len-1 edges inside the run */
+    p = (start+t) % ncities;
+    q = (start+len-2-t) % ncities;
+    hold_len    = mc->edge_len[p];
+    mc->edge_len[p] = mc->edge_len[q];
+    mc->edge_len[q] = hold_len;
+  }
+  mc->edge_len[i] = TourEdge(mc->curr_tour, i);    /* and the two new ones at the */
+  mc->edge_len[k] = TourEdge(mc->curr_tour, k);    /* ends, whichever side it was */
+}
+
+
+/*** OrOptRelocate: carries out the Or-opt move proposed in swap and ******
+ *                  or_len: the segment of or_len cities from tour[swap[0]] *
+ *                  goes in after c = tour[swap[1]]; the cities in between *
+ *                  shift by or_len, on whichever side of the segment c is  *
+ *                  closer; their positions and edge lengths shift along   *
+ ***************************************************************************/
+
+static void OrOptRelocate(MoveContext *mc)
+{
+  int    n = ncities, len = mc->or_len;
+  int    i = mc->swap[0], pc = mc->swap[1];
+  int    m, t, from, to, ahead;
+  city_t seg[OR_OPT_MAX];                   /* the cities being moved ... */
+  double seg_len[OR_OPT_MAX];               /* ... and the edges in there */
+
+  if (n < len+3 || (pc-i+n) % n < len || pc == (i-1+n) % n)
+    return;                              /* null moves, see calc_or_opt_ */
+
+  for (t=0; t<len; t++){
+    seg[t]     = mc->curr_tour[(i+t)%n];
+    seg_len[t] = mc->edge_len[(i+t)%n];
+  }
+
+  m     = (pc - (i+len) + 2*n) % n + 1;      /* cities from succ(seg) to c */
+  ahead = (m <= n-len-m);              /* else from succ(c) to pred(seg) */
+  if (ahead) {                /* those m cities move back by len, in order */
+    for (t=0; t<m; t++){
+      from = (i+len+t) % n;
+      to   = (i+t) % n;
+      mc->curr_tour[to] = mc->curr_tour[from];
+      mc->curr_position[mc->curr_tour[to]] = to;
+      if (t < m-1)
+        mc->edge_len[to] = mc->edge_len[from];
+    }
+    to = (i+m) % n;                              /* the segment goes here */
+  } else {                    /* the n-len-m cities after c move up by len */
+    m = n-len-m;
+    for (t=m-1; t>=0; t--){
+      from = (pc+1+t) % n;
+      to   = (pc+1+t+len) % n;
+      mc->curr_tour[to] = mc->curr_tour[from];
+      mc->curr_position[mc->curr_tour[to]] = to;
+      if (t < m-1)
+        mc->edge_len[to] = mc->edge_len[from];
+    }
+    to = (pc+1) % n;
+  }
+  for (t=0; t<len; t++){
+    mc->curr_tour[(to+t)%n] = seg[t];
+    mc->curr_position[seg[t]] = (to+t) % n;
+    if (t < len-1)
+      mc->edge_len[(to+t)%n] = seg_len[t];
+  }
+
+  /* the three new edges: c to the segment, the segment to what followed *
+   * c, and the gap the segment left behind                               */
+  t = (to-1+n) % n;
+  mc->edge_len[t] = TourEdge(mc->curr_tour, t);
+  t = (to+len-1) % n;
+  mc->edge_len[t] = TourEdge(mc->curr_tour, t);
+  t = ahead ? (i-1+n) % n : (i+len-1) % n;
+  mc->edge_len[t] = TourEdge(mc->curr_tour, t);
+}
+
+
+/*** SwapMove: exchanges the cities at swap[0] and swap[1] in the tour ***
+ ***************************************************************************/
+
+static void SwapMove(MoveContext *mc)
+{
   int hold;                            /* temporary swap location */
- /* actually swap the elements in curr tour for real */
-    /* new cost must be saved in curr cost */
-     curr_cost = new_cost ; /* my way */
+
   /* elements must be swapped in curr tour and position */ 
       /* element of curr_tour is city ID */
       /* element of swap is index to curr_tour */
       /* element of curr_position is index to curr_tour */
       /* index to curr_postion is city ID -1 */
-      hold = curr_tour [ swap [0]];
-      curr_tour [swap[0] ] = curr_tour [swap [1]];
-      curr_tour [swap[1] ] = hold;
+      hold = mc->curr_tour [ mc->swap [0]];
+      mc->curr_tour [mc->swap[0] ] = mc->curr_tour [mc->swap [1]];
+      mc->curr_tour [mc->swap[1] ] = hold;
        /* ** hold is a city id so must sub 1 to get index into curr_position** */
-      curr_position [hold ] = swap [1];
-      curr_position [curr_tour [swap[0]] ] = swap[0];
+      mc->curr_position [hold ] = mc->swap [1];
+      mc->curr_position [mc->curr_tour [mc->swap[0]] ] = mc->swap[0];
+      /* the (up to) four edges on either side of the swapped positions */
+      mc->edge_len [mc->swap[0]] = TourEdge(mc->curr_tour, mc->swap[0]);
+      mc->edge_len [(mc->swap[0]+ncities-1)%ncities] =
+        TourEdge(mc->curr_tour, (mc->swap[0]+ncities-1)%ncities);
+      mc->edge_len [mc->swap[1]] = TourEdge(mc->curr_tour, mc->swap[1]);
+      mc->edge_len [(mc->swap[1]+ncities-1)%ncities] =
+        TourEdge(mc->curr_tour, (mc->swap[1]+ncities-1)%ncities);
+}
+
+
+/*** propose, delta and reject hooks of the move operators; the accept ****
+ *   hooks are SwapMove, TwoOptReverse and OrOptRelocate above; nothing is *
+ *   changed before accept, so there is nothing to undo on reject          *
+ ***************************************************************************/
+
+static void ProposeSwap(MoveContext *mc)   { ProposeNeighbourMove(mc, &mc->acc_tab); }
+
+static void ProposeTwoOpt(MoveContext *mc) { ProposeNeighbourMove(mc, &mc->acc_tab); }
+
+static void ProposeOrOpt(MoveContext *mc)
+{
+  mc->or_len = 1 + RandomInt(OR_OPT_MAX);
+  ProposeNeighbourMove(mc, &mc->or_acc_tab);
+}
+
+static double SwapDelta(MoveContext *mc)
+{
+  return calc_new_cost(mc, mc->curr_tour, mc->swap, mc->curr_cost);
+}
+
+static double TwoOptDelta(MoveContext *mc)
+{
+  return calc_two_opt_cost(mc, mc->curr_tour, mc->swap, mc->curr_cost);
+}
+
+static double OrOptDelta(MoveContext *mc)
+{
+  return calc_or_opt_cost(mc, mc->curr_tour, mc->swap, mc->or_len, mc->curr_cost);
+}
+
+static void RejectNothing(MoveContext *mc) { }
+
+
+/*** the same moves on the list tour (tour_list = 1), where swap holds ****
+ *   cities: the removed edges come with the links, and the Or-opt move is *
+ *   made of up to three 2-opt moves (SRV 2026-10-17)                      *
+ ***************************************************************************/
+
+static double SwapDeltaList(MoveContext *mc)
+{
+  city_t a = mc->swap[0], c = mc->swap[1];
+  city_t from[4], to[4];
+  double removed;
+  int    nadd = 2;
+
+  from[0] = c;  to[0] = TourPrev(mc->tl, a);
+  from[1] = a;  to[1] = TourNext(mc->tl, c);
+  if (c == TourNext(mc->tl, a))                              /* neighbours: the */
+    removed = TourPrevLen(mc->tl, a) + TourNextLen(mc->tl, c);       /* edge a-c stays  */
+  else if (c == TourPrev(mc->tl, a)) {
+    from[0] = a;  to[0] = TourPrev(mc->tl, c);
+    from[1] = c;  to[1] = TourNext(mc->tl, a);
+    removed = TourPrevLen(mc->tl, c) + TourNextLen(mc->tl, a);
+  } else {
+    from[2] = c;  to[2] = TourNext(mc->tl, a);
+    from[3] = a;  to[3] = TourPrev(mc->tl, c);
+    removed = TourPrevLen(mc->tl, a) + TourNextLen(mc->tl, a) +
+              TourPrevLen(mc->tl, c) + TourNextLen(mc->tl, c);
+    nadd = 4;
+  }
+  return mc->curr_cost + EdgeDelta(from, to, 0, nadd) - removed;
+}
+
+static double TwoOptDeltaList(MoveContext *mc)
+{
+  city_t a = mc->swap[0], c = mc->swap[1];
+  city_t from[2], to[2];
+
+  if (c == TourNext(mc->tl, a) || c == TourPrev(mc->tl, a))                /* null move */
+    return FORBIDDEN_MOVE;
+  from[0] = a;             to[0] = c;
+  from[1] = TourNext(mc->tl, a);   to[1] = TourNext(mc->tl, c);
+  return mc->curr_cost + EdgeDelta(from, to, 0, 2)
+                   - TourNextLen(mc->tl, a) - TourNextLen(mc->tl, c);
+}
+
+static double OrOptDeltaList(MoveContext *mc)
+{
+  city_t s = mc->swap[0], c = mc->swap[1], s_end = mc->swap[0];
+  city_t from[3], to[3];
+  int    t;
+
+  for (t=1; t<mc->or_len; t++)
+    s_end = TourNext(mc->tl, s_end);
+  if (ncities < mc->or_len+3 || TourBetween(mc->tl, s, c, s_end) || c == TourPrev(mc->tl, s))
+    return FORBIDDEN_MOVE;                                     /* null move */
+  from[0] = TourPrev(mc->tl, s);   to[0] = TourNext(mc->tl, s_end);
+  from[1] = c;             to[1] = s;
+  from[2] = s_end;         to[2] = TourNext(mc->tl, c);
+  return mc->curr_cost + EdgeDelta(from, to, 0, 3) - TourPrevLen(mc->tl, s)
+                   - TourNextLen(mc->tl, s_end) - TourNextLen(mc->tl, c);
+}
+
+static void SwapMoveList(MoveContext *mc)   { TourSwapCities(mc->tl, mc->swap[0], mc->swap[1]); }
+
+static void TwoOptMoveList(MoveContext *mc) { TourTwoOpt(mc->tl, mc->swap[0], mc->swap[1]); }
+
+static void OrOptMoveList(MoveContext *mc)
+{
+  city_t s = mc->swap[0], c = mc->swap[1], s_end = mc->swap[0];
+  city_t p, q, d;
+  int    t;
+
+  for (t=1; t<mc->or_len; t++)
+    s_end = TourNext(mc->tl, s_end);
+  if (ncities < mc->or_len+3 || TourBetween(mc->tl, s, c, s_end) || c == TourPrev(mc->tl, s))
+    return;
+  p = TourPrev(mc->tl, s);
+  q = TourNext(mc->tl, s_end);
+  d = TourNext(mc->tl, c);
+                    /* p s..s' q..c d  ->  p c..q s'..s d (either way round) */
+  TourTwoOpt(mc->tl, p, c);
+  if (c != q) {                              /* ->  p q..c s'..s d */
+    if (TourNext(mc->tl, p) == c)
+      TourTwoOpt(mc->tl, p, q);
+    else
+      TourTwoOpt(mc->tl, c, s_end);
+  }
+  if (s != s_end) {                          /* ->  p q..c s..s' d */
+    if (TourNext(mc->tl, c) == s_end)
+      TourTwoOpt(mc->tl, c, s);
+    else
+      TourTwoOpt(mc->tl, d, s_end);
+  }
+}
+
+
+/*** InitMoveOps: fills the move operator registry; the weights start ****
+ *                out as the fractions from $move_parameters, with the    *
+ *                rest going to swaps; the adaptive selector keeps every *
+ *                operator at MOVE_WEIGHT_MIN or above (SRV 2026-10-17)   *
+ ***************************************************************************/
+
+void InitMoveOps(MoveContext *mc)
+{
+  int    k;
+  double total = 0.;
+
+  mc->move_ops[SWAP_MOVE].name    = "swap";
+  mc->move_ops[SWAP_MOVE].stats   = &mc->acc_tab;
+  mc->move_ops[SWAP_MOVE].propose = ProposeSwap;
+  mc->move_ops[SWAP_MOVE].delta   = SwapDelta;
+  mc->move_ops[SWAP_MOVE].accept  = SwapMove;
+  mc->move_ops[SWAP_MOVE].weight  =
+    1. - mp.two_opt_fraction - mp.or_opt_fraction;
+
+  mc->move_ops[TWO_OPT_MOVE].name    = "2-opt";
+  mc->move_ops[TWO_OPT_MOVE].stats   = &mc->acc_tab;
+  mc->move_ops[TWO_OPT_MOVE].propose = ProposeTwoOpt;
+  mc->move_ops[TWO_OPT_MOVE].delta   = TwoOptDelta;
+  mc->move_ops[TWO_OPT_MOVE].accept  = TwoOptReverse;
+  mc->move_ops[TWO_OPT_MOVE].weight  = mp.two_opt_fraction;
+
+  mc->move_ops[OR_OPT_MOVE].name    = "Or-opt";
+  mc->move_ops[OR_OPT_MOVE].stats   = &mc->or_acc_tab;
+  mc->move_ops[OR_OPT_MOVE].propose = ProposeOrOpt;
+  mc->move_ops[OR_OPT_MOVE].delta   = OrOptDelta;
+  mc->move_ops[OR_OPT_MOVE].accept  = OrOptRelocate;
+  mc->move_ops[OR_OPT_MOVE].weight  = mp.or_opt_fraction;
+
+  if (mp.tour_list) {                         /* the same moves, by city */
+    mc->move_ops[SWAP_MOVE].delta     = SwapDeltaList;
+    mc->move_ops[SWAP_MOVE].accept    = SwapMoveList;
+    mc->move_ops[TWO_OPT_MOVE].delta  = TwoOptDeltaList;
+    mc->move_ops[TWO_OPT_MOVE].accept = TwoOptMoveList;
+    mc->move_ops[OR_OPT_MOVE].delta   = OrOptDeltaList;
+    mc->move_ops[OR_OPT_MOVE].accept  = OrOptMoveList;
+  }
+
+  mc->nmove_ops_used = 0;
+  for (k=0; k<NMOVE_OPS; k++){
+    mc->move_ops[k].reject   = RejectNothing;
+    mc->move_ops[k].rate     = 0.;
+    mc->move_ops[k].proposed = 0;
+    mc->move_ops[k].accepted = 0;
+    mc->move_ops[k].gain     = 0.;
+    mc->move_ops[k].ns       = 0.;
+    mc->move_ops[k].timed    = 0;
+    if (mp.adaptive_selection && mc->move_ops[k].weight < MOVE_WEIGHT_MIN)
+      mc->move_ops[k].weight = MOVE_WEIGHT_MIN;
+    if (mc->move_ops[k].weight < 1e-12)           /* swap after 0.7 + 0.3 */
+      mc->move_ops[k].weight = 0.;
+    total += mc->move_ops[k].weight;
+    if (mc->move_ops[k].weight > 0.)
+      mc->nmove_ops_used++;
+  }
+  for (k=0; k<NMOVE_OPS; k++)
+    mc->move_ops[k].weight /= total;
+}
+
+
+/*** AdaptMoveWeights: the bandit; each operator's reward is the energy ***
+ *                     its accepted moves gave up in the last interval,   *
+ *                     per ns it spends on a move (from the timed ones);  *
+ *                     the smoothed rewards set the weights in proportion *
+ *                     (probability matching), above MOVE_WEIGHT_MIN      *
+ ***************************************************************************/
+
+static void AdaptMoveWeights(MoveContext *mc)
+{
+  int    k;
+  double reward, total = 0.;
+  MoveOp *op;
+
+  for (k=0; k<NMOVE_OPS; k++){
+    op = mc->move_ops + k;
+    if (op->proposed > 0 && op->timed > 0) {
+      reward   = op->gain / (op->proposed * (op->ns / op->timed));
+      op->rate = (1.-MOVE_RATE_DECAY) * op->rate + MOVE_RATE_DECAY * reward;
+    }
+    total += op->rate;
+  }
+  if (total < MOVE_RATE_TINY)        /* nothing gained (lately): keep them */
+    return;
+  for (k=0; k<NMOVE_OPS; k++)
+    mc->move_ops[k].weight = MOVE_WEIGHT_MIN +
+      (1. - NMOVE_OPS*MOVE_WEIGHT_MIN) * mc->move_ops[k].rate / total;
+}
+
+
+/*** AcceptMove: sets new energy cost and tour in current cost and tour    * 
+ *               for the next step and keeps track of the number of        *
+ *               successful moves for acceptance statistics                *
+ ***************************************************************************/
+
+void AcceptMove(Annealer *an)
+{  /* begin accept_move*/
+  MoveContext *mc = an->move;                       /* the chain's moves */
+  MoveOp *op = mc->move_ops + mc->move_kind;
+  struct timespec t0;                                   /* for timed moves */
+
+  if (mc->move_timed)
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+
+  if (mp.batch_size > 1 && !mc->nfold_on)  /* the rest of the batch looks here */
+    MarkDirty(mc);
+ /* actually change curr tour for real, the operator's way */
+  op->accept(mc);
+  if (mc->nfold_on)                    /* the moves around it change their odds */
+    NFoldUpdate(mc);
+    /* new cost must be saved in curr cost */
+  if (mc->new_cost < mc->curr_cost)
+    op->gain += mc->curr_cost - mc->new_cost;
+     mc->curr_cost = mc->new_cost ; /* my way */
+
     /* count the acceptances we have */
-       acc_tab.success++;
+  op->stats->success++;
+  op->accepted++;
+  if (mc->move_timed)
+    op->ns += ElapsedNs(&t0);
  if (tour_debug) 
 { /* begin debug */
    /* just for grins keep the best found so far */
-      global_min ();
+      global_min (mc);
 } /* end debug */
 
 
@@ -504,13 +1315,256 @@ void AcceptMove(void)
 /*******************************************
 * Reject move does nothing right now.      *
 ********************************************/
- void RejectMove()
+ void RejectMove(Annealer *an)
 {  /* begin reject_move*/
+  MoveContext *mc = an->move;                       /* the chain's moves */
  
   /* sorry, nothing to do. I leave original state intact until accept.   */
+  mc->move_ops[mc->move_kind].reject(mc);
  }  /* end reject_move*/
 
 
+/*** REJECTION-FREE MODE (N-FOLD WAY) FOR THE COLD END, SRV 2026-10-17 ****
+ *   Below mp.nfold_acc_ratio, Loop stops proposing moves one by one:      *
+ *   each step would pick a move m of the nfold_k nearest neighbour swaps  *
+ *   (all equally likely) and accept it with nfold_rate[m], so a step      *
+ *   accepts some move with p = nfold_total / nfold_nmoves; the steps up   *
+ *   to the next acceptance are geometric in p, and the move is picked in  *
+ *   proportion to nfold_rate from the Fenwick tree. The rates are for     *
+ *   nfold_S, at most the current S; NFoldMove thins them down to S (a     *
+ *   move picked at nfold_S is rejected with the odds it lost since), which*
+ *   keeps the chain exact while the rates only get recomputed every few   *
+ *   percent of S. An accepted swap only changes the moves of the six      *
+ *   cities around the two spots, and the moves that swap them in.         *
+ ***************************************************************************/
+
+/*** NFoldRate: the Metropolis acceptance of dE at S, as Loop has it *******
+ ***************************************************************************/
+
+static double NFoldRate(double dE, double S)
+{
+  double exp_arg = -S * dE;
+
+  if (dE <= 0.)
+    return 1.;
+  if (exp_arg <= MIN_DELTA)
+    exp_arg = MIN_DELTA;
+  return exp(exp_arg);
+}
+
+/*** FenwickAdd, FenwickFind: add d to move m; find the move m such that ***
+ *                            the rates of the moves before m sum up to at *
+ *                            most x < their sum up to and including m     *
+ ***************************************************************************/
+
+static void FenwickAdd(MoveContext *mc, int m, double d)
+{
+  for (m++; m <= mc->nfold_nmoves; m += m & -m)
+    mc->nfold_tree[m] += d;
+}
+
+static int FenwickFind(MoveContext *mc, double x)
+{
+  int pos = 0, step;
+
+  for (step=1; 2*step <= mc->nfold_nmoves; step *= 2)
+    ;
+  for (; step > 0; step /= 2)
+    if (pos+step <= mc->nfold_nmoves && mc->nfold_tree[pos+step] <= x) {
+      pos += step;
+      x   -= mc->nfold_tree[pos];
+    }
+  return pos < mc->nfold_nmoves ? pos : mc->nfold_nmoves-1;     /* rounding: last */
+}
+
+/*** NFoldDelta: the energy change of move m in the current tour ***********
+ ***************************************************************************/
+
+static double NFoldDelta(MoveContext *mc, int m)
+{
+  city_t sw[2];
+
+  sw[0] = mc->curr_position[m / mc->nfold_k];
+  sw[1] = mc->curr_position[mc->nfold_to[m]];
+  return calc_new_cost(mc, mc->curr_tour, sw, 0.);
+}
+
+/*** NFoldSetRate: recomputes the rate of move m and its place in the tree *
+ ***************************************************************************/
+
+static void NFoldSetRate(MoveContext *mc, int m)
+{
+  double rate = NFoldRate(NFoldDelta(mc, m), mc->nfold_S);
+
+  FenwickAdd(mc, m, rate - mc->nfold_rate[m]);
+  mc->nfold_total  += rate - mc->nfold_rate[m];
+  mc->nfold_rate[m] = rate;
+}
+
+/*** NFoldBuild: sets up the move set (the neighbours and which moves swap *
+ *               in which city); returns 0 if it would be too big          *
+ ***************************************************************************/
+
+static int NFoldBuild(MoveContext *mc)
+{
+  int a, j, m;
+
+  mc->nfold_k = (ep.neighbour_k < NFOLD_K) ? ep.neighbour_k : NFOLD_K;
+  if (mc->nfold_k > ncities-1)
+    mc->nfold_k = ncities-1;
+  if (mc->nfold_k < 1 || (double)ncities * mc->nfold_k > NFOLD_MAX_MOVES)
+    return 0;
+  mc->nfold_nmoves = ncities * mc->nfold_k;
+
+  mc->nfold_to        = (city_t *)malloc(mc->nfold_nmoves * sizeof(city_t));
+  mc->nfold_rev_start = (int *)calloc(ncities+1, sizeof(int));
+  mc->nfold_rev       = (int *)malloc(mc->nfold_nmoves * sizeof(int));
+  mc->nfold_rate      = (double *)malloc(mc->nfold_nmoves * sizeof(double));
+  mc->nfold_tree      = (double *)malloc((mc->nfold_nmoves+1) * sizeof(double));
+  if (!mc->nfold_to || !mc->nfold_rev_start || !mc->nfold_rev || !mc->nfold_rate ||
+      !mc->nfold_tree)
+    error("NFoldBuild: could not allocate the n-fold move set");
+
+  for (a=0; a<ncities; a++)
+    for (j=1; j<=mc->nfold_k; j++){
+      m = a*mc->nfold_k + j-1;
+      mc->nfold_to[m] = GetJthNearestNeighbour(a, j);
+      mc->nfold_rev_start[mc->nfold_to[m]+1]++;
+    }
+  for (a=0; a<ncities; a++)                   /* counts to start indices */
+    mc->nfold_rev_start[a+1] += mc->nfold_rev_start[a];
+  for (m=0; m<mc->nfold_nmoves; m++)         /* each move under its neighbour */
+    mc->nfold_rev[mc->nfold_rev_start[mc->nfold_to[m]]++] = m;
+  for (a=ncities; a>0; a--)          /* the loop above moved them all up */
+    mc->nfold_rev_start[a] = mc->nfold_rev_start[a-1];
+  mc->nfold_rev_start[0] = 0;
+  return 1;
+}
+
+/*** NFoldRates: computes all rates for S and builds the tree from them ****
+ ***************************************************************************/
+
+static void NFoldRates(MoveContext *mc, double S)
+{
+  int m, up;
+
+  mc->nfold_S     = S;
+  mc->nfold_total = 0.;
+  for (m=0; m<mc->nfold_nmoves; m++){
+    mc->nfold_rate[m]   = NFoldRate(NFoldDelta(mc, m), S);
+    mc->nfold_tree[m+1] = mc->nfold_rate[m];
+    mc->nfold_total    += mc->nfold_rate[m];
+  }
+  for (m=1; m<=mc->nfold_nmoves; m++){            /* the tree in linear time */
+    up = m + (m & -m);
+    if (up <= mc->nfold_nmoves)
+      mc->nfold_tree[up] += mc->nfold_tree[m];
+  }
+  mc->nfold_stale = 0;
+}
+
+/*** NFoldUpdate: after an accepted swap (in swap), recomputes the moves ***
+ *                of the cities that got new tour neighbours               *
+ ***************************************************************************/
+
+static void NFoldUpdate(MoveContext *mc)
+{
+  city_t x[6];
+  int    nx = 0, s, t, m, seen;
+
+  for (s=0; s<2; s++)
+    for (t=-1; t<=1; t++){
+      x[nx] = mc->curr_tour[(mc->swap[s]+t+ncities) % ncities];
+      for (seen=0; seen<nx && x[seen] != x[nx]; seen++)
+        ;
+      if (seen == nx)
+        nx++;
+    }
+  for (s=0; s<nx; s++){
+    for (m=x[s]*mc->nfold_k; m<(x[s]+1)*mc->nfold_k; m++)
+      NFoldSetRate(mc, m);
+    for (t=mc->nfold_rev_start[x[s]]; t<mc->nfold_rev_start[x[s]+1]; t++)
+      NFoldSetRate(mc, mc->nfold_rev[t]);
+  }
+}
+
+int NFoldSwitch(Annealer *an, double acc_ratio, double S)
+{
+  MoveContext *mc = an->move;                       /* the chain's moves */
+
+  if (mp.nfold_acc_ratio <= 0. || mc->nfold_off)
+    return 0;
+
+  if (mc->nfold_acc < 0.)
+    mc->nfold_acc = acc_ratio;
+  else
+    mc->nfold_acc += NFOLD_ACC_DECAY * (acc_ratio - mc->nfold_acc);
+
+  if (!mc->nfold_on) {
+    if (mc->nfold_acc >= mp.nfold_acc_ratio)
+      return 0;
+    if (!mc->nfold_to && !NFoldBuild(mc)) {
+      mc->nfold_off = 1;                            /* too big: never mind */
+      return 0;
+    }
+    mc->nfold_on    = 1;
+    mc->nfold_stale = 1;                 /* the moves went on while we were off */
+    mc->batch_next  = mc->batch_fill;         /* and batches are no good after this */
+    mc->ndirty      = 0;
+  } else if (mc->nfold_acc > 2. * mp.nfold_acc_ratio) {
+    mc->nfold_on = 0;                        /* warmed up again (say by mixing) */
+    return 0;
+  }
+
+  if (mc->nfold_stale || S < mc->nfold_S || S > (1. + NFOLD_S_SLACK) * mc->nfold_S)
+    NFoldRates(mc, S);
+  return 1;
+}
+
+int NFoldWait(Annealer *an)
+{
+  MoveContext *mc = an->move;                       /* the chain's moves */
+  double p = mc->nfold_total / mc->nfold_nmoves;
+  double wait;
+
+  if (p >= 1.)
+    return 0;
+  wait = floor(log(1. - RandomReal()) / log1p(-p));
+  return (wait < INT_MAX) ? (int)wait : INT_MAX;
+}
+
+double NFoldMove(Annealer *an, double S)
+{
+  MoveContext *mc = an->move;                       /* the chain's moves */
+  int m = FenwickFind(mc, RandomReal() * mc->nfold_total);
+  double rate;
+
+  mc->nhits++;
+  mc->nsweeps    = mc->nhits * lam_group_size;
+  mc->move_kind  = SWAP_MOVE;
+  mc->move_timed = 0;
+  mc->move_ops[SWAP_MOVE].proposed++;
+
+  mc->swap[0]  = mc->curr_position[m / mc->nfold_k];
+  mc->swap[1]  = mc->curr_position[mc->nfold_to[m]];
+  mc->new_cost = calc_new_cost(mc, mc->curr_tour, mc->swap, mc->curr_cost);
+
+  rate = NFoldRate(mc->new_cost - mc->curr_cost, S);       /* thinning from nfold_S */
+  if (rate < mc->nfold_rate[m] && RandomReal() * mc->nfold_rate[m] >= rate)
+    return FORBIDDEN_MOVE;
+  return mc->new_cost - mc->curr_cost;
+}
+
+void NFoldSkip(Annealer *an, int nsteps)
+{
+  MoveContext *mc = an->move;                       /* the chain's moves */
+
+  mc->nhits  += nsteps;
+  mc->nsweeps = mc->nhits * lam_group_size;
+  mc->move_ops[SWAP_MOVE].proposed += nsteps;
+}
+
+
 /*** MOVE GENERATION - PART 2: A FUNC NEEDED IN MOVE.C (BUT NOT LSA.C) *****/
 
 /*** UpdateControl: each 'interval' number of steps, acceptance stats are **
@@ -526,8 +1580,9 @@ void AcceptMove(void)
  *                  this function prints prolix stuff, if required (-p)    *
  ***************************************************************************/
 
-void UpdateControl(uint16_t *m_success) 
+void UpdateControl(Annealer *an, uint16_t *m_success) 
 {
+  MoveContext *mc = an->move;                       /* the chain's moves */
 
   
 /* Seb RV Nov 20 2025 */
@@ -536,14 +1591,14 @@ void UpdateControl(uint16_t *m_success)
  * UpdateControl gets called every proc_tau moves, which   *
  * is a multiple of tau, so even if nsweeps=nhits this can *
  * can only be called during an UpdateStats step.           */
-if (myid == 0){
-}
-  if (!(nsweeps % ap.interval) ){
+  if (!(mc->nsweeps % ap.interval) ){
 
   FILE       *prolixptr;                            /* prolix file pointer */
+  int        k;                                     /* move operator index */
+  int        root = (myid == 0 && an->thread == 0); /* the one that prints */
 
 /* open prolix file for appending new move stats */
-  if ( myid == 0 ) {
+  if ( root ) {
     if ( prolix ) {
       prolixptr = fopen(prolixfile, "a");
       if ( !prolixptr ) {
@@ -565,37 +1620,77 @@ if (myid == 0){
  * I did this way earlier but I didn't date it - SRV NOV 20 2025           */
 
   /* tsp no log - we do not need x */
-  acc_tab.theta_bar+= ap.gain_div_interval * (double)((int) *m_success-44);
+  /* SRV 2026-10-18: m_success pools the successes of all moves, so it   *
+   * only stands for acc_tab's moves (swap, 2-opt) if no Or-opt moves    *
+   * were made; else acc_tab goes by its own ratio, as or_acc_tab does   */
+  if ( mc->or_acc_tab.hits == 0 )
+    mc->acc_tab.theta_bar+= ap.gain_div_interval * (double)((int) *m_success-44);
+  else if ( mc->acc_tab.hits > 0 )
+    mc->acc_tab.theta_bar += ap.gain_div_interval *
+      (100. * (double)mc->acc_tab.success / (double)mc->acc_tab.hits - 44.);
   /* for all the trouble this stupid fucking function gave us
    * in trying to not make assumptions about sweeps, they
    * use this magic number that assumes we have 1 sweep every 100
    * moves. Whatever. SRV Nov 19 2025*/
 
-    if ( acc_tab.theta_bar > neighbor_max ) {
-      acc_tab.theta_bar = neighbor_max;
+    if ( mc->acc_tab.theta_bar > neighbor_max ) {
+      mc->acc_tab.theta_bar = neighbor_max;
     }
-    else if ( acc_tab.theta_bar < THETA_MIN ) {
-      acc_tab.theta_bar = THETA_MIN;
+    else if ( mc->acc_tab.theta_bar < THETA_MIN ) {
+      mc->acc_tab.theta_bar = THETA_MIN;
     }
+
+/* SRV 2026-10-17: the Or-opt moves aim for the same acceptance ratio with *
+ * their own theta_bar; their stats are this node's, since pooling them    *
+ * would cost another MPI_Allreduce                                        */
+  if ( mc->or_acc_tab.hits > 0 ) {
+    mc->or_acc_tab.theta_bar += ap.gain_div_interval *
+      (100. * (double)mc->or_acc_tab.success / (double)mc->or_acc_tab.hits - 44.);
+    if ( mc->or_acc_tab.theta_bar > neighbor_max )
+      mc->or_acc_tab.theta_bar = neighbor_max;
+    else if ( mc->or_acc_tab.theta_bar < THETA_MIN )
+      mc->or_acc_tab.theta_bar = THETA_MIN;
+  }
+
+/* so does the operator selection, if it is adaptive */
+  if ( mp.adaptive_selection )
+    AdaptMoveWeights(mc);
  
 /* if -p: root node prints prolix information to prolix file */
 
   if ( prolix ) {
-    if ( myid == 0 ) { 
-      fprintf(prolixptr, "nsteps = %8d bar = %10.8e hits = %6d ",
-	      nhits, acc_tab.theta_bar, acc_tab.hits ); 
-      fprintf(prolixptr, "success = %6d acc_ratio = %5.2f\n", 
-	      acc_tab.success, (double)acc_tab.success/(double)acc_tab.hits);
+    if ( root ) { 
+      fprintf(prolixptr, "nsteps = %8d bar = %10.8e hits = %6u ",
+	      mc->nhits, mc->acc_tab.theta_bar, mc->acc_tab.hits ); 
+      fprintf(prolixptr, "success = %6u acc_ratio = %5.2f\n", 
+	      mc->acc_tab.success, (double)mc->acc_tab.success/(double)mc->acc_tab.hits);
+      if ( mc->nmove_ops_used > 1 )
+        for ( k=0; k<NMOVE_OPS; k++ )
+          fprintf(prolixptr, "    %-6s bar = %10.8e weight = %5.3f proposed "
+                  "= %6d accepted = %6d ns/move = %7.1f gain = %g\n",
+                  mc->move_ops[k].name, mc->move_ops[k].stats->theta_bar,
+                  mc->move_ops[k].weight, mc->move_ops[k].proposed,
+                  mc->move_ops[k].accepted, mc->move_ops[k].timed ?
+                  mc->move_ops[k].ns / mc->move_ops[k].timed : 0., mc->move_ops[k].gain);
     }
   }
 
 /* reset acceptance stats for next 'interval' */
 
   *m_success=0; 
+  mc->acc_tab.hits       = 0;
+  mc->acc_tab.success    = 0;
+  mc->or_acc_tab.hits    = 0;
+  mc->or_acc_tab.success = 0;
+  for ( k=0; k<NMOVE_OPS; k++ ) {
+    mc->move_ops[k].proposed = 0;
+    mc->move_ops[k].accepted = 0;
+    mc->move_ops[k].gain     = 0.;
+  }
 
 /* close prolix file, if necessary */
 
-  if ( myid == 0 )
+  if ( root )
     if ( prolix )
       fclose(prolixptr);
   
@@ -613,7 +1708,7 @@ if (myid == 0){
  *                 which are static to move.c                              *
  ***************************************************************************/
 
-void WriteResults(FILE *outptr, int precision)
+void WriteResults(MoveContext *mc, FILE *outptr, int precision)
 {
   int i;
 
@@ -649,6 +1744,28 @@ void WriteResults(FILE *outptr, int precision)
   fprintf (outptr,"distribution type=%d q=%lf\n",DistP.distribution,DistP.q);
   fprintf(outptr, "$$\n\n");
 
+  fprintf(outptr, "$move_parameters:\n");
+  fprintf(outptr, "two_opt_fraction = %g\n", mp.two_opt_fraction);
+  fprintf(outptr, "or_opt_fraction = %g\n", mp.or_opt_fraction);
+  fprintf(outptr, "adaptive_selection = %d\n", mp.adaptive_selection);
+  fprintf(outptr, "tour_list = %d\n", mp.tour_list);
+  fprintf(outptr, "batch_size = %d\n", mp.batch_size);
+  fprintf(outptr, "nfold_acc_ratio = %g\n", mp.nfold_acc_ratio);
+  for (i=0; i<NMOVE_OPS; i++)
+    fprintf(outptr, "%s weight = %g\n", mc->move_ops[i].name, mc->move_ops[i].weight);
+  fprintf(outptr, "$$\n\n");
+
+  fprintf(outptr, "$edge_parameters:\n");
+  fprintf(outptr, "neighbour_k = %d\n", nneighbours);
+  fprintf(outptr, "neighbour_cache_bytes = %ld\n", ep.neighbour_cache_bytes);
+  fprintf(outptr, "distance_matrix_bytes = %ld (%s)\n", ep.distance_matrix_bytes,
+          dist_matrix_used ? "matrix" : "on the fly");
+  fprintf(outptr, "edge_weight_type = %s\n", EdgeWeightName());
+  fprintf(outptr, "city_order = %d\n", ep.city_order);
+  fprintf(outptr, "coordinates = %s\n",
+          (sizeof(coord_t) == sizeof(float)) ? "float" : "double");
+  fprintf(outptr, "$$\n\n");
+
  
          /****************************************************************/
          /* equil_param.xxx are static to lsa.c ChuParam from sa.h       */ 
@@ -661,13 +1778,14 @@ void WriteResults(FILE *outptr, int precision)
 	 /*fprintf(outptr, "$$\n\n");                                    */ 
          /****************************************************************/
   
+  FlattenTour(mc);
   fprintf(outptr, "$final_state:\n");
-  fprintf(outptr,"\n annealing minimum cost is: %f", curr_cost); 
-  fprintf(outptr," obtained in %d steps \n", nhits); 
+  fprintf(outptr,"\n annealing minimum cost is: %f", mc->curr_cost); 
+  fprintf(outptr," obtained in %d steps \n", mc->nhits); 
   fprintf (outptr,"min tour is:\n");  
    for ( i=0; i<ncities; i++)
      {
-          fprintf(outptr, "%d\t", curr_tour[i]); 
+          fprintf(outptr, "%d\t", OriginalCity(mc->curr_tour[i])); 
      }  /*end for print */
   fflush(outptr);
   fprintf(outptr, "\n$$\n\n");
@@ -675,11 +1793,11 @@ void WriteResults(FILE *outptr, int precision)
  if (tour_debug) 
 { /* begin debug */
   fprintf(outptr, "$global_state:\n\n");
-  fprintf(outptr,"\n For fun.absolute minimum cost is: %f\n",min_cost);  
+  fprintf(outptr,"\n For fun.absolute minimum cost is: %f\n",mc->min_cost);  
   fprintf (outptr,"absolute min tour is:\n");  
   for ( i=0; i<ncities; i++)
     {
-          fprintf(outptr, "%d\t", min_tour[i]); 
+          fprintf(outptr, "%d\t", OriginalCity(mc->min_tour[i])); 
     }  /*end for print */
   fflush(outptr);
   fprintf(outptr, "$$\n\n");
@@ -687,15 +1805,15 @@ void WriteResults(FILE *outptr, int precision)
  
   fprintf(outptr, "$annealing_output:\n");
   fprintf(outptr, "final_energy:\n");
-  fprintf(outptr, "%.*f\n", precision, curr_cost);
+  fprintf(outptr, "%.*f\n", precision, mc->curr_cost);
 
  if (tour_debug) 
 { /* begin debug */
   fprintf(outptr, "global_energy:\n");
-  fprintf(outptr, "%.*f\n", precision, min_cost);
+  fprintf(outptr, "%.*f\n", precision, mc->min_cost);
 } /* end debug */
 fprintf(outptr, "max_count:\n"); /* this is number of iterations */
-  fprintf(outptr, "%d\n", nhits);
+  fprintf(outptr, "%d\n", mc->nhits);
   fprintf(outptr, "$$\n");
 }
 
@@ -703,14 +1821,15 @@ fprintf(outptr, "max_count:\n"); /* this is number of iterations */
 * Print the current tour and its cost.       *
 * commented out print to outfile.            *
 **********************************************/
- void print_curr_tour(FILE* outfile)
+ void print_curr_tour(MoveContext *mc, FILE* outfile)
 {  /* begin print current tour */
 int i;
-fprintf(outfile,"\n current cost is: %f\n", curr_cost);  
+FlattenTour(mc);
+fprintf(outfile,"\n current cost is: %f\n", mc->curr_cost);  
 fprintf (outfile,"current tour is:\n");  
  for ( i=0; i<ncities; i++)
   {
-          fprintf(outfile, "%d\t", curr_tour[i]);  
+          fprintf(outfile, "%d\t", OriginalCity(mc->curr_tour[i]));  
   }  /*end for print */
  fflush(outfile);
 }  /* end print current tour */
@@ -721,24 +1840,25 @@ fprintf (outfile,"current tour is:\n");
 * Print the annealing minimum tour & cost, and     *
 * just for fun print the minimum tour and its cost *
 ****************************************************/
- void print_min_tour(FILE* outfile)
+ void print_min_tour(MoveContext *mc, FILE* outfile)
 {  /* begin print min tour */
 int i;
-fprintf(outfile,"\n annealing minimum cost is: %f", curr_cost); 
-fprintf(outfile," obtained in %d steps \n", nhits); 
+FlattenTour(mc);
+fprintf(outfile,"\n annealing minimum cost is: %f", mc->curr_cost); 
+fprintf(outfile," obtained in %d steps \n", mc->nhits); 
 fprintf (outfile,"min tour is:\n");  
  for ( i=0; i<ncities; i++)
   {
-          fprintf(outfile, "%d\t", curr_tour[i]); 
+          fprintf(outfile, "%d\t", OriginalCity(mc->curr_tour[i])); 
   }  /*end for print */
 fflush(outfile);
  if (tour_debug) 
 { /* begin debug */
-fprintf(outfile,"\n For fun.absolute minimum cost is: %f\n",min_cost);  
+fprintf(outfile,"\n For fun.absolute minimum cost is: %f\n",mc->min_cost);  
 fprintf (outfile,"absolute min tour is:\n");  
  for ( i=0; i<ncities; i++)
   {
-          fprintf(outfile, "%d\t", min_tour[i]); 
+          fprintf(outfile, "%d\t", OriginalCity(mc->min_tour[i])); 
   }  /*end for print */
 fflush(outfile);
 } /* end debug */
@@ -798,9 +1918,11 @@ void SetProlix(int value, char *file, int init_flag)
  *           in addition to the nhits, nsweeps and acc_tab stuff           *
  ***************************************************************************/
 
-void MakeStateMsg(unsigned char **buf, MPI_Aint padding, MPI_Aint *size)
+void MakeStateMsg(Annealer *an, unsigned char **buf, MPI_Aint padding, MPI_Aint *size)
 {
-  /*int    i;       don't need this anymore SRV 2025-11-15 */
+  MoveContext *mc = an->move;                       /* the chain's moves */
+  int    i;                                      /* move operator index */
+  unsigned char city_bytes = sizeof(city_t);    /* width of the city ids */
 
 
 /* calculate buffer size, compare with move parameters below */
@@ -808,7 +1930,9 @@ void MakeStateMsg(unsigned char **buf, MPI_Aint padding, MPI_Aint *size)
 
 /* allocate buffer */
   
-    MPI_Alloc_mem(nbytes+padding, MPI_INFO_NULL, buf);
+    *buf = (unsigned char *)malloc(nbytes+padding);  /* not MPI_Alloc_mem: */
+    if ( !*buf )                     /* threads of a rank make these too */
+      error("MakeStateMsg: could not allocate the state message");
 
 /* pack longs into longbuf */
 /*Nope. */
@@ -820,22 +1944,37 @@ void MakeStateMsg(unsigned char **buf, MPI_Aint padding, MPI_Aint *size)
    * first since this potentially will lead to more cache          *
    * hits, and more importantly extremely efficient vectorisation  *
    * of memcpy operations.                                         */
-  memcpy(buf_pointer, curr_tour_and_pos, size_arr);
+  /* the edge lengths go first, which keeps them 8 byte aligned;   *
+   * copying them is cheaper than weighing ncities edges again     */
+  FlattenTour(mc);               /* the list tour travels as arrays */
+  memcpy(buf_pointer, mc->edge_len, size_len);
+  buf_pointer += size_len;
+  memcpy(buf_pointer, mc->curr_tour_and_pos, size_arr);
   buf_pointer += size_arr;
-  memcpy(buf_pointer, &acc_tab.hits,sizeof(unsigned char));
-  buf_pointer += sizeof(unsigned char);
-  memcpy(buf_pointer, &acc_tab.success, sizeof(unsigned char));
+  memcpy(buf_pointer, &mc->acc_tab.hits,sizeof(unsigned int));
+  buf_pointer += sizeof(unsigned int);
+  memcpy(buf_pointer, &mc->acc_tab.success, sizeof(unsigned int));
+  buf_pointer += sizeof(unsigned int);
+  memcpy(buf_pointer, &city_bytes, sizeof(unsigned char));
   buf_pointer += sizeof(unsigned char);
-  memcpy(buf_pointer, &ncities, sizeof(unsigned short));
-  buf_pointer += sizeof(unsigned short);
-  memcpy(buf_pointer, &nhits, sizeof(unsigned int));
+  memcpy(buf_pointer, &ncities, sizeof(city_t));
+  buf_pointer += sizeof(city_t);
+  memcpy(buf_pointer, &mc->nhits, sizeof(unsigned int));
   buf_pointer += sizeof(unsigned int);
-  memcpy(buf_pointer,&nsweeps, sizeof(unsigned int));
+  memcpy(buf_pointer,&mc->nsweeps, sizeof(unsigned int));
   buf_pointer += sizeof(unsigned int);
-  memcpy(buf_pointer,&curr_cost, sizeof(double));
+  memcpy(buf_pointer,&mc->curr_cost, sizeof(double));
+  buf_pointer += sizeof(double);
+  memcpy(buf_pointer,&mc->acc_tab.theta_bar, sizeof(double));
   buf_pointer += sizeof(double);
-  memcpy(buf_pointer,&acc_tab.theta_bar, sizeof(double));
+  memcpy(buf_pointer,&mc->or_acc_tab.theta_bar, sizeof(double));
   buf_pointer += sizeof(double);
+  for (i=0; i<NMOVE_OPS; i++){    /* the selector state goes along (SRV) */
+    memcpy(buf_pointer, &mc->move_ops[i].weight, sizeof(double));
+    buf_pointer += sizeof(double);
+    memcpy(buf_pointer, &mc->move_ops[i].rate, sizeof(double));
+    buf_pointer += sizeof(double);
+  }
   
   *size = nbytes; /*size now tells Lam where the move state ends
   so that it can append its information at the end */
@@ -851,9 +1990,12 @@ void MakeStateMsg(unsigned char **buf, MPI_Aint padding, MPI_Aint *size)
  *              the state for this node.                                   *
  ***************************************************************************/
 
-void AcceptStateMsg(unsigned char **buf)
+void AcceptStateMsg(Annealer *an, unsigned char **buf)
 {
+  MoveContext *mc = an->move;                       /* the chain's moves */
   int i;
+  unsigned char city_bytes;                  /* width of the sender's ids */
+  city_t        n;                     /* and its number of cities */
   unsigned char *buf_pointer = *buf;
   /* equivalent to unsigned char *buf_pointer; buf_pointer=buf; */
 
@@ -862,22 +2004,44 @@ void AcceptStateMsg(unsigned char **buf)
    * first since this potentially will lead to more cache          *
    * hits, and more importantly extremely efficient vectorisation  *
    * of memcpy operations.                                         */
-  memcpy( curr_tour_and_pos, buf_pointer,size_arr);
+  memcpy( mc->edge_len, buf_pointer, size_len);
+  buf_pointer += size_len;
+  memcpy( mc->curr_tour_and_pos, buf_pointer,size_arr);
   buf_pointer += size_arr;
-  memcpy(&acc_tab.hits,buf_pointer,sizeof(unsigned char));
-  buf_pointer += sizeof(unsigned char);
-  memcpy(&acc_tab.success, buf_pointer,sizeof(unsigned char));
+  memcpy(&mc->acc_tab.hits,buf_pointer,sizeof(unsigned int));
+  buf_pointer += sizeof(unsigned int);
+  memcpy(&mc->acc_tab.success, buf_pointer,sizeof(unsigned int));
+  buf_pointer += sizeof(unsigned int);
+  memcpy(&city_bytes, buf_pointer,sizeof(unsigned char));
   buf_pointer += sizeof(unsigned char);
-  memcpy(&ncities, buf_pointer,sizeof(unsigned short));
-  buf_pointer += sizeof(unsigned short);
-  memcpy(&nhits, buf_pointer,sizeof(unsigned int));
+  if (city_bytes != sizeof(city_t))            /* mixed WIDE_CITIES builds */
+    error("AcceptStateMsg: got %d byte city ids, expected %d", city_bytes,
+          (int)sizeof(city_t));
+  memcpy(&n, buf_pointer,sizeof(city_t));       /* ncities is shared now, */
+  buf_pointer += sizeof(city_t);                 /* so only check it       */
+  if (n != ncities)
+    error("AcceptStateMsg: got a tour of %d cities, expected %d", (int)n,
+          (int)ncities);
+  memcpy(&mc->nhits, buf_pointer,sizeof(unsigned int));
   buf_pointer += sizeof(unsigned int);
-  memcpy(&nsweeps, buf_pointer,sizeof(unsigned int));
+  memcpy(&mc->nsweeps, buf_pointer,sizeof(unsigned int));
   buf_pointer += sizeof(unsigned int);
-  memcpy(&curr_cost, buf_pointer,sizeof(double));
+  memcpy(&mc->curr_cost, buf_pointer,sizeof(double));
+  buf_pointer += sizeof(double);
+  memcpy(&mc->acc_tab.theta_bar, buf_pointer,sizeof(double));
   buf_pointer += sizeof(double);
-  memcpy(&acc_tab.theta_bar, buf_pointer,sizeof(double));
+  memcpy(&mc->or_acc_tab.theta_bar, buf_pointer,sizeof(double));
   buf_pointer += sizeof(double);
+  for (i=0; i<NMOVE_OPS; i++){
+    memcpy(&mc->move_ops[i].weight, buf_pointer, sizeof(double));
+    buf_pointer += sizeof(double);
+    memcpy(&mc->move_ops[i].rate, buf_pointer, sizeof(double));
+    buf_pointer += sizeof(double);
+  }
+  if (mp.tour_list)
+    mc->tl = TourListBuild(mc->tl, mc->curr_tour, mc->edge_len);
+  mc->batch_next = mc->batch_fill;      /* the batch was weighed on the old tour */
+  mc->nfold_stale = 1;                         /* and so were the n-fold odds */
 /* unpack longs */
   }
 #endif
@@ -885,58 +2049,178 @@ void AcceptStateMsg(unsigned char **buf)
 
 /*** Utility cost functions for TSP tour stuff **************************/
 
+/*** TourEdge: weight of the edge from tour[p] to tour[p+1] (mod ncities) *
+ *               in the precision of EdgeDelta, which is what edge_len     *
+ *               holds (SRV 2026-10-17)                                    *
+ ***************************************************************************/
+double TourEdge(city_t *tour, int p)
+{
+  city_t a = tour[p];
+  city_t b = tour[(p+1)%ncities];
+
+  return EdgeDelta(&a, &b, 0, 1);
+}
+
 /**********************************************
 * Calc_new_cost calculates the cost of the    *
 * tour using only city pairs that are proposed*
 * to be swapped.  The proposed new cost is    *
 * returned by this module                     *
 ***********************************************/
- double calc_new_cost(unsigned short *tour, unsigned short *swap, 
+/* SRV 2026-10-17: the removed edges are all edges of the current tour, so *
+ * their weights come out of edge_len; only the added edges (from, to) are *
+ * weighed, which halves the work; tour has to be curr_tour. SwapEdges,    *
+ * TwoOptEdges and OrOptEdges list the edges a move adds in from and to   *
+ * (returning how many) and sum up the ones it removes, so that FillBatch *
+ * can weigh the edges of many moves at once                               */
+ double calc_new_cost(MoveContext *mc, city_t *tour, city_t *swap, 
  double original_cost)
 
 {/* begin update_cost*/
-  double add_cost=0;/* new edge costs */
+  double remove_cost;/* old edge costs */
+  city_t from[4], to[4];
+  int nadd;
+
+  nadd = SwapEdges(mc, tour, swap, from, to, &remove_cost);
+  return original_cost + EdgeDelta(from, to, 0, nadd) - remove_cost;
+ } /* end update_cost*/
+
+/*** GetRankStats: the CPU ns spent making neighbour ranks and how many **
+ *                 were made, in stats[0..1]                               *
+ ***************************************************************************/
+void GetRankStats(MoveContext *mc, double *stats)
+{
+  stats[0] = mc->rank_ns;
+  stats[1] = (double)mc->rank_n;
+}
+
+static int SwapEdges(MoveContext *mc, city_t *tour, city_t *swap, city_t *from, city_t *to,
+                     double *removed)
+{
   double remove_cost=0;/* old edge costs */
+  int nadd = 2;
   /* need to use modulo arithmetic to make nice with (i.e. generalize) the endpoints */
   /* in modulo arithmetic can't subtract a number.  You must add (dimension-number you want to subtract) */
   /*begin updating edges */
   if (((swap [0] == 0) && (swap[1] == ncities-1)) || ((swap [1] == 0) && (swap[0] == ncities-1)))
     {/* special treatment when both are endpoints */
-       remove_cost += GetDistance(node_coords[tour[ncities-2]], node_coords[tour[ncities-1]]) ;
-       remove_cost += GetDistance(node_coords[tour[0]], node_coords[tour[1]]) ;
-       add_cost += GetDistance(node_coords[tour[1]], node_coords[tour [ncities-1]]) ;
-       add_cost += GetDistance(node_coords[tour[0]], node_coords[tour [ncities-2]]) ;
+       remove_cost += mc->edge_len[ncities-2];
+       remove_cost += mc->edge_len[0];
+       from[0] = tour[1]; to[0] = tour[ncities-1];
+       from[1] = tour[0]; to[1] = tour[ncities-2];
      } /* both are endpoints */
   
   else if (((swap [1] - swap [0]) == -1)|| (swap [1] == 0 && swap[0] == 1) || (swap [1] == (ncities-2) && swap[0] == (ncities -1)))
     { /* Neighbors are special too.  Neighbors are swapping with swap[0] > swap[1]  */
-      remove_cost += GetDistance(node_coords[tour[swap[0]]], node_coords[tour [(swap[0]+1)%ncities]]) ;
-      remove_cost += GetDistance(node_coords[tour[swap[1]]], node_coords[tour [(swap[1]+ncities-1)%ncities]]) ;
-      add_cost += GetDistance(node_coords[tour[swap[1]]], node_coords[tour [(swap[0]+1)%ncities]]) ;
-      add_cost += GetDistance(node_coords[tour[swap[0]]], node_coords[tour [(swap[1]+ncities-1)%ncities]]) ;
+      remove_cost += mc->edge_len[swap[0]];
+      remove_cost += mc->edge_len[(swap[1]+ncities-1)%ncities];
+      from[0] = tour[swap[1]]; to[0] = tour[(swap[0]+1)%ncities];
+      from[1] = tour[swap[0]]; to[1] = tour[(swap[1]+ncities-1)%ncities];
     } /* neighbors are swapping with swap[0] > swap[1]  */
    else if (((swap [1] - swap [0]) == 1) || (swap [0] == 0 && swap[1] == 1) || (swap [0] == (ncities-2) && swap[1] == (ncities -1)))
     { /* Neighbors are special too.  Neighbors are swapping with swap[1] > swap[0]  */
-      remove_cost += GetDistance(node_coords[tour[swap[0]]], node_coords[tour [(swap[0]+ncities-1)%ncities]]) ;
-      remove_cost += GetDistance(node_coords[tour[swap[1]]], node_coords[tour [(swap[1]+1)%ncities]]) ;
-      add_cost += GetDistance(node_coords[tour[swap[1]]], node_coords[tour [(swap[0]+ncities-1)%ncities]]) ;
-      add_cost += GetDistance(node_coords[tour[swap[0]]], node_coords[tour [(swap[1]+1)%ncities]]) ;
+      remove_cost += mc->edge_len[(swap[0]+ncities-1)%ncities];
+      remove_cost += mc->edge_len[swap[1]];
+      from[0] = tour[swap[1]]; to[0] = tour[(swap[0]+ncities-1)%ncities];
+      from[1] = tour[swap[0]]; to[1] = tour[(swap[1]+1)%ncities];
     } /* neighbors are swapping with swap[1] > swap[0]  */
   else
     {  /* most likely not neighbors, not both endpoints.  This is the general case */
-      remove_cost += GetDistance(node_coords[tour[swap[0]]], node_coords[tour [(swap[0]+ncities-1)%ncities]]) ;
-      remove_cost += GetDistance(node_coords[tour[swap[0]]], node_coords[tour [(swap[0]+1)%ncities]]) ;
-      remove_cost += GetDistance(node_coords[tour[swap[1]]], node_coords[tour [(swap[1]+ncities-1)%ncities]]) ;
-      remove_cost += GetDistance(node_coords[tour[swap[1]]], node_coords[tour [(swap[1]+1)%ncities]]) ;
-      add_cost += GetDistance(node_coords[tour[swap[1]]], node_coords[tour [(swap[0]+ncities-1)%ncities]]) ;
-      add_cost += GetDistance(node_coords[tour[swap[1]]], node_coords[tour [(swap[0]+1)%ncities]]) ;
-      add_cost += GetDistance(node_coords[tour[swap[0]]], node_coords[tour [(swap[1]+ncities-1)%ncities]]) ;
-      add_cost += GetDistance(node_coords[tour[swap[0]]], node_coords[tour [(swap[1]+1)%ncities]]) ;
+      remove_cost += mc->edge_len[(swap[0]+ncities-1)%ncities];
+      remove_cost += mc->edge_len[swap[0]];
+      remove_cost += mc->edge_len[(swap[1]+ncities-1)%ncities];
+      remove_cost += mc->edge_len[swap[1]];
+      from[0] = from[1] = tour[swap[1]];
+      from[2] = from[3] = tour[swap[0]];
+      to[0] = tour[(swap[0]+ncities-1)%ncities];
+      to[1] = tour[(swap[0]+1)%ncities];
+      to[2] = tour[(swap[1]+ncities-1)%ncities];
+      to[3] = tour[(swap[1]+1)%ncities];
+      nadd = 4;
      } /* most likely not neighbors, not both endpoints */
  
  /*end for updating  edges */
-  return original_cost + add_cost - remove_cost;
- } /* end update_cost*/
+  *removed = remove_cost;
+  return nadd;
+}
+
+
+
+/*** calc_two_opt_cost: 2-opt version of calc_new_cost (SRV 2026-10-17); **
+ *                      a = tour[swap[0]] and c = tour[swap[1]] become     *
+ *                      neighbours: edges (a, succ a) and (c, succ c) make *
+ *                      way for (a, c) and (succ a, succ c), so there are  *
+ *                      only two edges to weigh; if c is next to a already *
+ *                      this is a null move, which is FORBIDDEN_MOVE, so   *
+ *                      that it does not count as accepted: late in a run  *
+ *                      most near neighbours are tour neighbours, and the  *
+ *                      acc_ratio would never fall                         *
+ ***************************************************************************/
+double calc_two_opt_cost(MoveContext *mc, city_t *tour, city_t *swap, double original_cost)
+{
+  city_t from[2], to[2];
+  double removed;
+  int    nadd;
+
+  nadd = TwoOptEdges(mc, tour, swap, from, to, &removed);
+  if (!nadd)
+    return FORBIDDEN_MOVE;
+  return original_cost + EdgeDelta(from, to, 0, nadd) - removed;
+}
+
+static int TwoOptEdges(MoveContext *mc, city_t *tour, city_t *swap, city_t *from, city_t *to,
+                       double *removed)
+{
+  int    len = (swap[1] - swap[0] + ncities) % ncities;
+
+  *removed = 0.;
+  if (len <= 1 || len == ncities-1)
+    return 0;
+
+  from[0] = tour[swap[0]];                to[0] = tour[swap[1]];
+  from[1] = tour[(swap[0]+1)%ncities];    to[1] = tour[(swap[1]+1)%ncities];
+  *removed = mc->edge_len[swap[0]] + mc->edge_len[swap[1]];
+  return 2;
+}
+
+
+
+/*** calc_or_opt_cost: Or-opt version of calc_new_cost (SRV 2026-10-17); **
+ *                     the len cities s..s' from tour[swap[0]] (between p *
+ *                     and q) go in between c = tour[swap[1]] and succ c: *
+ *                     (p,s) (s',q) (c,succ c) out, (p,q) (c,s) (s',succ  *
+ *                     c) in; null move if c is in the segment or is p,   *
+ *                     which is FORBIDDEN_MOVE as for calc_two_opt_cost   *
+ ***************************************************************************/
+double calc_or_opt_cost(MoveContext *mc, city_t *tour, city_t *swap, int len,
+                        double original_cost)
+{
+  city_t from[3], to[3];
+  double removed;
+  int    nadd;
+
+  nadd = OrOptEdges(mc, tour, swap, len, from, to, &removed);
+  if (!nadd)
+    return FORBIDDEN_MOVE;
+  return original_cost + EdgeDelta(from, to, 0, nadd) - removed;
+}
+
+static int OrOptEdges(MoveContext *mc, city_t *tour, city_t *swap, int len, city_t *from,
+                      city_t *to, double *removed)
+{
+  int    n = ncities;
+  int    i = swap[0], pc = swap[1];
+
+  *removed = 0.;
+  if (n < len+3 || (pc-i+n) % n < len || pc == (i-1+n) % n)
+    return 0;
+
+  from[0] = tour[(i-1+n)%n];      to[0] = tour[(i+len)%n];
+  from[1] = tour[pc];             to[1] = tour[i];
+  from[2] = tour[(i+len-1)%n];    to[2] = tour[(pc+1)%n];
+  *removed = mc->edge_len[(i-1+n)%n] + mc->edge_len[(i+len-1)%n] + mc->edge_len[pc];
+  return 3;
+}
 
 
 
@@ -945,16 +2229,17 @@ void AcceptStateMsg(unsigned char **buf)
 * compare new cost to global min cost; stores lowest in      * 
 * min_tour and min_cost only for fun, so not in annealing run*
 *************************************************************/
-void global_min(void)
+void global_min(MoveContext *mc)
 {  /* begin global_min */
 int i; /*loop counter */
 /* cost and tour must be saved */
-if (curr_cost < min_cost)
+if (mc->curr_cost < mc->min_cost)
    { /* we have a new minimum */
-        min_cost = curr_cost ;
+        FlattenTour(mc);
+        mc->min_cost = mc->curr_cost ;
          for ( i=0; i<ncities; i++)
             {/*begin for */
-                min_tour [i] = curr_tour [i];
+                mc->min_tour [i] = mc->curr_tour [i];
             } /*end for */
  }/* we have a new minimum */
 }  /* end global_min */
@@ -988,4 +2273,5 @@ void FreeMoveState(MoveState *move_stuff){
  
 void FreeDistances(){
   free(distances);
+  distances = NULL;
 }
@@ -43,6 +43,21 @@
 #include "sa.h"
 #endif
 
+/* following for EdgeParms (neighbour list parameters) */
+#ifndef EDGE_WT_INCLUDED
+#include "edge_wt.h"
+#endif
+
+/* following for RandState (StateRead restores the generator) */
+#ifndef RANDOM_INCLUDED
+#include "random.h"
+#endif
+
+/* following for TourList (the list tour of a MoveContext) */
+#ifndef TOUR_LIST_INCLUDED
+#include "tour_list.h"
+#endif
+
 
 /*** CONSTANTS *************************************************************/
 
@@ -51,8 +66,6 @@
  * on problem size. Set to problem size/2 in InitMoves         */ 
 /* #define THETA_INIT 5.0       initial value for all theta_bar (move size) */
 
-#define LOWBITS    0x330E                /* following two are for drand to */
-#define BYTESIZE   8                                   /* erand conversion */
 
 
 /*** A GLOBAL **************************************************************/
@@ -113,22 +126,175 @@ typedef struct {
 /*double acc_ratio; Seb RV 2025 November 14 - removed
  * acceptance ratio for parameter */
 /*Changed hits and success to unsigned chars */
+/* SRV 2026-10-18: back to unsigned ints, as the Or-opt control divides   *
+ * them, and a chain can make more than 255 moves between UpdateControls  */
   double theta_bar;              /* theta bar is proportional to move size */
-  unsigned char hits; /* number of moves since last call to UpdateControl() */
-  unsigned char success; /* number of these moves that were accepted */
+  unsigned int hits;  /* number of moves since last call to UpdateControl() */
+  unsigned int success;  /* number of these moves that were accepted */
 } AccStats;
+
+/* SRV 2026-10-17: the kinds of moves GenerateMove can propose; both pick  *
+ * a city and its j-th nearest neighbour under the same theta_bar control  */
+#define SWAP_MOVE    0             /* exchange the positions of the two  */
+#define TWO_OPT_MOVE 1             /* reverse the tour between the two   */
+#define OR_OPT_MOVE  2             /* move 1-3 cities from the first one */
+                                   /* on to just after the second one    */
+#define OR_OPT_MAX   3             /* longest segment an Or-opt moves    */
+#define NMOVE_OPS    3             /* number of entries in the registry  */
+
+/* SRV 2026-10-17: the move operators, indexed by the kinds above; Gene-   *
+ * rateMove picks one by weight and calls its hooks: propose sets up swap  *
+ * (and the segment length), delta returns the proposed cost, and accept  *
+ * or reject finish the move; the counters feed the adaptive selector and *
+ * the .prolix output; the hooks work on the chain's MoveContext (below)   */
+struct MoveContext;
+
+typedef struct {
+  const char *name;                         /* for .prolix and .output */
+  AccStats   *stats;             /* acceptance stats (theta_bar) it uses */
+  void       (*propose)(struct MoveContext *mc);
+  double     (*delta)(struct MoveContext *mc);
+  void       (*accept)(struct MoveContext *mc);
+  void       (*reject)(struct MoveContext *mc);
+  double     weight;           /* probability that GenerateMove picks it */
+  double     rate;       /* smoothed energy gained per ns (adaptive only) */
+  unsigned int proposed;          /* moves proposed since UpdateControl */
+  unsigned int accepted;              /* ... and how many got accepted */
+  double     gain;          /* energy given up by those accepted moves */
+  double     ns;                  /* ns spent in the timed moves so far */
+  unsigned int timed;                  /* number of timed moves so far */
+} MoveOp;
+
+/* move parameters, read from the optional $move_parameters section of the *
+ * .params file (see ReadMoveParameters in tsp_sa.c)                       */
+typedef struct {
+  double two_opt_fraction;           /* share of moves that are 2-opt RO */
+  double or_opt_fraction;           /* share of moves that are Or-opt RO */
+  int    adaptive_selection;    /* 1: fractions adapt to the energy each */
+                                /* operator gains per ns (bandit) RO     */
+  int    tour_list;             /* 1: keep the tour as a two-level list  */
+                                /* (tour_list.c), for huge instances RO  */
+  int    batch_size;            /* moves proposed and weighed at a time  */
+                                /* (1: one by one; array tour only); 32  */
+                                /* gives about 1.6x the moves/s at low   */
+                                /* acceptance, where a batch stays valid */
+                                /* RO                                    */
+  double nfold_acc_ratio;       /* below this acc_ratio, go rejection-   */
+                                /* free (n-fold way); 0: never RO        */
+} MoveParms;
+
+/* SRV 2026-10-17: a move of a batch (batch_size > 1): drawn, resolved and *
+ * weighed against the tour as it was when the batch was filled; if a move *
+ * accepted since then touched the tour positions it read (its window),   *
+ * it is weighed again when its turn comes, for the same two cities       */
+#define MOVE_BATCH_MAX 256                 /* largest batch_size allowed */
+
+typedef struct {
+  int    kind;                    /* SWAP_MOVE, TWO_OPT_MOVE, OR_OPT_MOVE */
+  int    i, j;       /* tour position and neighbour rank that were drawn */
+  int    or_len;                            /* cities moved (Or-opt only) */
+  city_t city[2];                  /* tour[i] and its j-th neighbour */
+  city_t swap[2];                          /* ... and their positions */
+  double added;                          /* weight of the edges it adds */
+  double removed;                     /* and of the ones it takes away */
+  int    null;             /* 1 if it changes nothing (no edges to add) */
+  int    lo[2], span[2];        /* its window: span[w] positions from lo */
+  int    mark;               /* accepted moves (windows) it has seen */
+  int    timed;                           /* 1 if its batch was timed */
+} MoveCandidate;
                          /* determines when to call UpdateControl routine */
 
+/* SRV 2026-10-17: move sizes (deviates) for DrawNeighbourMove, drawn      *
+ * RANK_BUFFER at a time for the theta_bar of one AccStats (see FillRanks) */
+#define RANK_BUFFER 256                  /* neighbour ranks drawn at a time */
+
+typedef struct {
+  double theta_bar;                      /* the one the buffer is used for */
+  double scale;        /* dev_scale of it; 0: the deviates are for it alone */
+  int    next;                /* next one to hand out; RANK_BUFFER: none */
+  double theta[RANK_BUFFER];
+} RankBuffer;
+
+/* SRV 2026-10-17: the moves of one annealing chain: its tour and all the  *
+ * move.c state that goes with it (acceptance stats, operator registry,   *
+ * batch and n-fold way), which StartTour allocates and hangs on the       *
+ * chain's Annealer (an->move); the parameters and the neighbour lists are *
+ * the same for all chains and stay static in move.c; what every move     *
+ * touches comes first                                                     */
+typedef struct MoveContext {
+  city_t   *curr_tour;          /* tour of city ids in current order visited */
+  city_t   *curr_position;  /* tour position of each city (index: city id) */
+  double   *edge_len;  /* edge_len[p] is the weight of the edge from curr_ */
+                       /* tour[p] to curr_tour[p+1] (mod ncities), so that */
+                       /* moves only weigh the edges they add              */
+  TourList *tl;                          /* the list tour (tour_list = 1) */
+  double   curr_cost;                          /* cost of the current tour */
+  double   new_cost;                      /* cost of the proposed new tour */
+  city_t   swap[2];          /* indices of the swapped elements in the tour */
+                             /* (with tour_list: the two cities themselves) */
+  int      move_kind;     /* SWAP_MOVE, TWO_OPT_MOVE or OR_OPT_MOVE, which- */
+                          /* ever was proposed                              */
+  int      or_len;           /* cities moved by the proposed Or-opt move */
+  int      move_timed;          /* 1 if the proposed move is being timed */
+  unsigned int nhits;      /* number of moves since the start of execution */
+  unsigned int nsweeps;   /* number of sweeps since the start of execution */
+  AccStats acc_tab;        /* struct to accumulate acceptance statistics */
+  AccStats or_acc_tab;       /* the same, for the Or-opt moves by their */
+                             /* own, which need other move sizes         */
+  Annealer *an;                  /* the chain it belongs to, back pointer */
+
+  MoveOp   move_ops[NMOVE_OPS];               /* the move operator registry */
+  int      nmove_ops_used;               /* operators with a weight above 0 */
+
+  RankBuffer ranks;                                          /* for acc_tab */
+  RankBuffer or_ranks;                                    /* for or_acc_tab */
+
+  MoveCandidate batch[MOVE_BATCH_MAX];        /* the batch (batch_size > 1) */
+  int      batch_next;         /* next candidate to hand out; batch is */
+  int      batch_fill;         /* empty once it reaches batch_fill      */
+  int      nbatches;               /* batches filled, for timing a sample */
+  int      dirty_lo[2*MOVE_BATCH_MAX];         /* windows of the moves     */
+  int      dirty_span[2*MOVE_BATCH_MAX];       /* accepted since the batch */
+  int      ndirty;                             /* was filled               */
+
+/* the rejection-free mode: its move set is the swaps of each city a with *
+ * one of its nfold_k nearest neighbours, move m = a*nfold_k + j-1 for the *
+ * j-th; nfold_rate[m] is the Metropolis acceptance of m at nfold_S, and   *
+ * nfold_tree the Fenwick tree (binary indexed tree) of those              */
+  int      nfold_on;                     /* 1 while we are rejection-free */
+  int      nfold_stale;        /* 1 if the tour changed behind its back */
+  int      nfold_k;
+  int      nfold_nmoves;                             /* ncities * nfold_k */
+  city_t   *nfold_to;                /* the neighbour each move swaps in */
+  int      *nfold_rev_start;            /* the moves that swap in city c  */
+  int      *nfold_rev;                  /* are nfold_rev[nfold_rev_start */
+                                        /* [c] .. nfold_rev_start[c+1]-1] */
+  double   *nfold_rate;
+  double   *nfold_tree;                    /* 1-based, nfold_nmoves long */
+  double   nfold_total;                      /* the sum of all nfold_rate */
+  double   nfold_S;                /* the inverse temperature of the rates */
+  double   nfold_acc;                /* smoothed acc_ratio (-1: none yet) */
+  int      nfold_off;      /* 1 if the move set would be too big: never */
+
+  city_t   *curr_tour_and_pos;  /* the block curr_tour and curr_position */
+                                /* live in, which mixing sends in one go */
+  city_t   *min_tour;          /* the minimum annealing tour found so far */
+                               /* (tour_debug only), not really SA method */
+  double   min_cost;             /* cost of the minimum tour found so far */
+  double   rank_ns;               /* CPU ns FillRanks spent, and the */
+  unsigned long rank_n;               /* number of moves drawn from it */
+} MoveContext;
+
 /* contains copies of the static variables of moves.c together with the 
  * current tour */
 typedef struct {
-  unsigned short *curr_tour;
-  unsigned short *curr_position;
+  city_t *curr_tour;
+  city_t *curr_position;
   double curr_cost;
   AccStats *acc_tab_ptr;
   unsigned int nhits;
   unsigned int nsweeps; 
-  unsigned short ncities;
+  city_t ncities;
 } MoveState;
 
 /* Opts struct is used to save command line options in savestate.c */
@@ -180,12 +346,32 @@ SAType ReadTune(FILE *fp);
 
 AParms ReadAParameters(FILE *fp);
 
+/*** ReadEdgeParameters: reads the optional edge_parameters section; the ***
+ *                       defaults from edge_wt.h are used if it is missing *
+ ***************************************************************************/
+
+EdgeParms ReadEdgeParameters(FILE *fp);
+
+/*** ReadMoveParameters: reads the optional move_parameters section; ******
+ *                       without it all moves are swaps, as they used to be*
+ ***************************************************************************/
+
+MoveParms ReadMoveParameters(FILE *fp);
+
 
 /*** PrintTimes: prints user and wallclock times to the .times file ********
  ***************************************************************************/
 
 void PrintTimes(FILE *fp, double *times);
 
+/*** StartMissCounter, StopMissCounter: count the hardware cache misses ****
+ *                     between initialization and FinalMove for -t runs    *
+ ***************************************************************************/
+
+void StartMissCounter(void);
+
+void StopMissCounter(void);
+
 /*** PrintEquil: writes an 'equilibrate_variance' section with 'title' *****
  *               to the stream specified by fp                             *
  ***************************************************************************/
@@ -200,7 +386,7 @@ void PrintEquil(FILE *fp, double *equil_var, char *title);
  *                 to the caller                                           *
  ***************************************************************************/
 
-AParms GetFinalInfo(void);
+AParms GetFinalInfo(MoveContext *mc);
 
 
 /* initializing functions */
@@ -216,12 +402,22 @@ void InitTSP(FILE *infile);
 /*** InitMoves: initializes the following move.c-specific stuff: ***********
  *              - static annealing parameter struct (ap)                   *
  *              - initializes random number generator in lsa.c             *
- *              - initializes acc_tab for acceptance statistics            *
  *              it then returns the initial temperature to the caller      *
  ***************************************************************************/
 
 double InitMoves(FILE *fp, int Tau);
 
+/*** InitThreadMoves: seeds the random number generator of thread 'thread' *
+ *                    (with the stream of that thread on this rank) and    *
+ *                    gives it its scratch for the neighbour queries; for  *
+ *                    hybrid runs, where InitMoves did that for thread 0;  *
+ *                    FreeThreadMoves frees the scratch again              *
+ ***************************************************************************/
+
+void InitThreadMoves(int thread);
+
+void FreeThreadMoves(void);
+
 /***************************************************************************/
 /* miscellaneous functions */
 /***************************************************************************/
@@ -231,7 +427,7 @@ double InitMoves(FILE *fp, int Tau);
  *                 output file                                             *
  ***************************************************************************/
 
-void WriteResults(FILE *outptr, int precision);
+void WriteResults(MoveContext *mc, FILE *outptr, int precision);
 
 /***************************************************************************/
 /*** SetProlix: sets flag for printing prolix output on acceptance stats ***
@@ -249,7 +445,7 @@ void SetProlix(int value, char *file, int init_flag);
 /****************************************
 * init_cost initializes tour costs to 0 *
 *****************************************/
-void init_cost(void);
+void init_cost(MoveContext *mc);
 
 /**********************************************
 * Calc_new_cost calculates the cost of the    *
@@ -257,46 +453,76 @@ void init_cost(void);
 * to be swapped.  The proposed new cost is    *
 * returned by this module                     *
 ***********************************************/
-double calc_new_cost(unsigned short *tour, unsigned short* swap, double cost);
+double calc_new_cost(MoveContext *mc, city_t *tour, city_t* swap, double cost);
+
+/*** GetRankStats: puts the CPU ns spent drawing the neighbour ranks (the *
+ *                 move sizes) and the number of ranks drawn into         *
+ *                 stats[0..1] (SRV 2026-10-17)                           *
+ ***************************************************************************/
+void GetRankStats(MoveContext *mc, double *stats);
+
+/*** TourEdge: weight of the edge from tour[p] to tour[p+1] (mod ncities) */
+double TourEdge(city_t *tour, int p);
+
+/*** calc_two_opt_cost: the cost of the tour after the 2-opt move that ****
+ *                      makes tour[swap[0]] and tour[swap[1]] neighbours   *
+ ***************************************************************************/
+double calc_two_opt_cost(MoveContext *mc, city_t *tour, city_t *swap,
+                         double cost);
+
+/*** calc_or_opt_cost: the cost of the tour after the Or-opt move that ****
+ *                     puts the len cities from tour[swap[0]] on between  *
+ *                     tour[swap[1]] and its successor                    *
+ ***************************************************************************/
+double calc_or_opt_cost(MoveContext *mc, city_t *tour, city_t *swap, int len,
+                        double cost);
+
+/*** InitMoveOps: fills the move operator registry of mc from the move ***
+ *                parameters; called by StartTour for each chain           *
+ ***************************************************************************/
+void InitMoveOps(MoveContext *mc);
 
 /***************************************************
 * allocates dynamic memory for the tsp tour arrays *
 ***************************************************/
-int tour_allocate(void);
+int tour_allocate(MoveContext *mc);
 
 /*****************************************************
 * deallocates dymanic memory for the tsp tour arrays * 
+* and the MoveContext they are in                    *
 ******************************************************/
-void tour_deallocate(void);
+void tour_deallocate(MoveContext *mc);
 
 /*************************************************************
 * compare new cost to global min cost; stores lowest in      * 
 * min_tour and min_cost only for fun, so not in annealing run*
 *************************************************************/
-void global_min(void);
+void global_min(MoveContext *mc);
 
 /***********************************************************
 * this module prints the not annealed minimum tour for fun *
 ??????????????????may want to get rid of this??????????
 ***********************************************************/
-void print_min_tour(FILE* outfile);
+void print_min_tour(MoveContext *mc, FILE* outfile);
 
 /***************************************
 * this module prints the current tour  *
 ****************************************/
-void print_curr_tour(FILE* outfile);
+void print_curr_tour(MoveContext *mc, FILE* outfile);
 
 /*******************************************
 * generates starting tour and sets min tour *
+* for the chain an, after it has given it a *
+* MoveContext (an->move)                    *
 ********************************************/
-double StartTour( void );
+double StartTour(Annealer *an);
 
 /*******************************************
  * State File functions                    *
  ******************************************/
 
 void StateRead(char *statefile, Opts *options, MoveState *moveptr, double *state, 
-    unsigned short *rand, double *delta);
+    RandState *rand, double *delta);
 
 void RestoreProlix();
 
@@ -55,7 +55,8 @@ int main(int argc, char **argv){
   double cost;
   char buff[MAX_RECORD];
   
-  unsigned short *curr_tour;
+  city_t *curr_tour;
+  unsigned int city;
   extern char *optarg;
   extern int optind;
   extern int optopt;
@@ -115,9 +116,10 @@ int main(int argc, char **argv){
     sscanf(buff, "annealing minimum cost is: %lf", &orig_cost);
   }
   fgets(buff, MAX_RECORD, output_file);
-  curr_tour=(unsigned short*)calloc(ncities, sizeof(unsigned short));
+  curr_tour=(city_t*)calloc(ncities, sizeof(city_t));
   for(i=0; i<ncities; i++){
-    fscanf(output_file, "%d", &curr_tour[i]); 
+    fscanf(output_file, "%u", &city);
+    curr_tour[i] = city;
   }
   cost=tour_cost(curr_tour);
   format=(char*)calloc(MAX_RECORD, sizeof(char));
@@ -54,7 +54,7 @@ static char *filename; /* name of state file */
  /* Not functional right now - SRV 2025-11-16 */
 
 void StateRead(char *statefile, Opts *options, MoveState *moveptr, double *stats,
-  unsigned short *rand, double *delta){
+  RandState *rand, double *delta){
 //  FILE *infile;
 //  int i;
 //
@@ -117,8 +117,11 @@ void StateRead(char *statefile, Opts *options, MoveState *moveptr, double *stats
 //  for(i=0; i<31; i++)
 //    fscanf(infile, "%lg\n", &(stats[i]));
 //
-//  for(i=0; i<3; i++)
-//    fscanf(infile, "%hd\n", &(rand[i]));
+//  for(i=0; i<2; i++)
+//    fscanf(infile, "%u\n", &(rand->key[i]));
+//  for(i=0; i<4; i++)
+//    fscanf(infile, "%u\n", &(rand->ctr[i]));
+//  fscanf(infile, "%d\n", &(rand->pos));
 //
 //
 //
@@ -138,7 +141,7 @@ void StateWrite(char *statefile){
 //  Opts *options;
 //  MoveState *move_status;
 //  double *lamsave;
-//  unsigned short *prand;
+//  RandState prand;
 //  double *delta;
 //
 //  /* if StateWrite() called for the first time, make filename static. */
@@ -150,7 +153,7 @@ void StateWrite(char *statefile){
 //  options = GetOptions();
 //  move_status = MoveSave();
 //  lamsave = GetLamstats();
-//  prand = GetERandState();
+//  GetRandomState(&prand);
 //  if (time_flag)
 //    delta = GetTimes();
 //  outfile = fopen(filename, "w");
@@ -204,8 +207,11 @@ void StateWrite(char *statefile){
 //  for(i=0; i < 31; i++)
 //    fprintf(outfile,"%.16g\n", lamsave[i]);
 //
-//  for(i=0; i < 3; i++)
-//    fprintf(outfile,"%d\n", prand[i]);
+//  for(i=0; i < 2; i++)
+//    fprintf(outfile,"%u\n", prand.key[i]);
+//  for(i=0; i < 4; i++)
+//    fprintf(outfile,"%u\n", prand.ctr[i]);
+//  fprintf(outfile,"%d\n", prand.pos);
 //  fclose(outfile);
 //
 //  free(options);
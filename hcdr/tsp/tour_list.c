@@ -0,0 +1,630 @@
+/* SRV 2026-10-17
+ * tour_list.c: the two-level doubly-linked list tour (see tour_list.h).
+ *
+ * Every city is a node with links to its two tour neighbours, kept in the
+ * order of the node's segment; a segment with its reversal bit set is
+ * read backwards, so that the city after a is
+ *
+ *   SUC(a) = segment(a) reversed ? prev[a] : next[a]
+ *
+ * also across segment boundaries. The segments form a cycle of their own
+ * with ranks 0 to nsegs-1 along the tour (wrapping once), and the nodes
+ * of a segment have increasing ids along its next links; ranks and ids
+ * answer TourBetween. A path that starts and ends on segment boundaries
+ * is reversed by reversing the segments in between and flipping their
+ * bits, with only the two links at its ends changed; other paths first
+ * have their end segments split, by handing the smaller part over to the
+ * neighbouring segment, or are reversed node by node if they lie within
+ * one segment. The edge weights travel with the links.
+ *
+ * Those hand-overs let segments grow and shrink, and a reversal within a
+ * segment costs its size, so once a move is done, any segment that got
+ * shorter than group/2 or longer than 2*group is evened out with its
+ * smaller neighbour, or merged into it or cut in two (see Rebalance):
+ * segments stay O(sqrt(n)) long.
+ */
+
+#include "tour_list.h"
+#include "error.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define ID_LIMIT (1<<30)   /* renumber a segment whose ids got this big */
+#define TOUCHED_MAX 16     /* segments a move and Rebalance resize, at most */
+
+typedef struct {
+  city_t next, prev;           /* neighbours in the order of the segment */
+  double wnext, wprev;                 /* weights of the edges to them */
+  int    seg;                                   /* segment of the city */
+  int    id;                  /* increases along the next links of seg */
+} ListNode;
+
+typedef struct {
+  int    next, prev;             /* neighbouring segments in tour order */
+  int    rank;                       /* place in tour order, 0..nsegs-1 */
+  int    reversed;              /* 1: the next links point backwards */
+  city_t first, last;               /* the nodes with the lowest and */
+                                    /* highest id                    */
+  int    size;                            /* number of cities in here */
+} ListSegment;
+
+struct TourList {                 /* one per tour (annealing chain) */
+  ListNode    *nodes;
+  ListSegment *segs;
+  int          nsegs;                          /* segments in the tour */
+  int          maxsegs;                           /* room in segs for */
+  int         *spare;                    /* the entries of segs not in */
+  int          nspare;                   /* the tour, for splits        */
+  int          group;                /* cities per segment at the start */
+  int          touched[TOUCHED_MAX];  /* segments MovePiece resized since */
+  int          ntouched;              /* the last Rebalance             */
+};
+
+
+/*** small helpers: links in tour direction ********************************/
+
+static double EdgeWeight(city_t a, city_t b)
+{
+  return EdgeDelta(&a, &b, 0, 1);     /* same precision as move.c's sums */
+}
+
+static void SetSuc(TourList *tl, city_t a, city_t b, double w)
+{
+  if (tl->segs[tl->nodes[a].seg].reversed) {
+    tl->nodes[a].prev  = b;
+    tl->nodes[a].wprev = w;
+  } else {
+    tl->nodes[a].next  = b;
+    tl->nodes[a].wnext = w;
+  }
+}
+
+static void SetPred(TourList *tl, city_t a, city_t b, double w)
+{
+  if (tl->segs[tl->nodes[a].seg].reversed) {
+    tl->nodes[a].next  = b;
+    tl->nodes[a].wnext = w;
+  } else {
+    tl->nodes[a].prev  = b;
+    tl->nodes[a].wprev = w;
+  }
+}
+
+static void FlipLinks(TourList *tl, city_t a)
+{                                  /* next becomes prev and back */
+  city_t hold   = tl->nodes[a].next;
+  double w_hold = tl->nodes[a].wnext;
+
+  tl->nodes[a].next  = tl->nodes[a].prev;
+  tl->nodes[a].wnext = tl->nodes[a].wprev;
+  tl->nodes[a].prev  = hold;
+  tl->nodes[a].wprev = w_hold;
+}
+
+static int Order(TourList *tl, city_t a)
+{                       /* increases in tour direction within the segment */
+                        /* of a                                            */
+  return tl->segs[tl->nodes[a].seg].reversed ? -tl->nodes[a].id : tl->nodes[a].id;
+}
+
+static city_t SegHead(TourList *tl, int s)
+{                     /* first and last city of segment s in tour direction */
+  return tl->segs[s].reversed ? tl->segs[s].last : tl->segs[s].first;
+}
+
+static city_t SegTail(TourList *tl, int s)
+{
+  return tl->segs[s].reversed ? tl->segs[s].first : tl->segs[s].last;
+}
+
+
+/*** BUILDING AND FLATTENING ***********************************************/
+
+TourList *TourListBuild(TourList *tl, const city_t *order, const double *len)
+{
+  int n = ncities;
+  int p, s;
+
+  if (tl == NULL) {
+    tl = (TourList *)malloc(sizeof(TourList));
+    if (tl == NULL)
+      error("TourListBuild: could not allocate the tour list");
+    tl->group = (int)sqrt((double)n);
+    if (tl->group < 1)
+      tl->group = 1;
+    /* Rebalance keeps segments at least (group+1)/2 long, but for the */
+    /* last one TourListBuild makes, and a split needs one spare        */
+    tl->maxsegs = n / ((tl->group + 1) / 2) + 2;
+    tl->nodes = (ListNode *)malloc(n * sizeof(ListNode));
+    tl->segs  = (ListSegment *)malloc(tl->maxsegs * sizeof(ListSegment));
+    tl->spare = (int *)malloc(tl->maxsegs * sizeof(int));
+    if (tl->nodes == NULL || tl->segs == NULL || tl->spare == NULL)
+      error("TourListBuild: could not allocate the tour list");
+  }
+  tl->nsegs    = (n + tl->group - 1) / tl->group;
+  tl->nspare   = 0;
+  tl->ntouched = 0;
+  for (s=tl->maxsegs-1; s>=tl->nsegs; s--)
+    tl->spare[tl->nspare++] = s;
+
+  for (p=0; p<n; p++) {
+    tl->nodes[order[p]].next  = order[(p+1) % n];
+    tl->nodes[order[p]].prev  = order[(p-1+n) % n];
+    tl->nodes[order[p]].wnext = len[p];
+    tl->nodes[order[p]].wprev = len[(p-1+n) % n];
+    tl->nodes[order[p]].seg   = p / tl->group;
+    tl->nodes[order[p]].id    = p % tl->group;
+  }
+  for (s=0; s<tl->nsegs; s++) {
+    tl->segs[s].next     = (s+1) % tl->nsegs;
+    tl->segs[s].prev     = (s-1+tl->nsegs) % tl->nsegs;
+    tl->segs[s].rank     = s;
+    tl->segs[s].reversed = 0;
+    tl->segs[s].first    = order[s*tl->group];
+    tl->segs[s].last     = order[(s+1)*tl->group < n ? (s+1)*tl->group-1 : n-1];
+    tl->segs[s].size     = ((s+1)*tl->group < n ? (s+1)*tl->group : n) - s*tl->group;
+  }
+  return tl;
+}
+
+void TourListFlatten(TourList *tl, city_t *order, city_t *position, double *len)
+{
+  city_t c = order[0];
+  int    p;
+
+  for (p=0; p<ncities; p++) {
+    order[p]    = c;
+    position[c] = p;
+    len[p]      = TourNextLen(tl, c);
+    c           = TourNext(tl, c);
+  }
+}
+
+void TourListFree(TourList *tl)
+{
+  if (tl == NULL)
+    return;
+  free(tl->nodes);
+  free(tl->segs);
+  free(tl->spare);
+  free(tl);
+}
+
+
+/*** QUERIES ***************************************************************/
+
+city_t TourNext(TourList *tl, city_t a)
+{
+  return tl->segs[tl->nodes[a].seg].reversed ? tl->nodes[a].prev : tl->nodes[a].next;
+}
+
+city_t TourPrev(TourList *tl, city_t a)
+{
+  return tl->segs[tl->nodes[a].seg].reversed ? tl->nodes[a].next : tl->nodes[a].prev;
+}
+
+double TourNextLen(TourList *tl, city_t a)
+{
+  return tl->segs[tl->nodes[a].seg].reversed ? tl->nodes[a].wprev : tl->nodes[a].wnext;
+}
+
+double TourPrevLen(TourList *tl, city_t a)
+{
+  return tl->segs[tl->nodes[a].seg].reversed ? tl->nodes[a].wnext : tl->nodes[a].wprev;
+}
+
+static int Before(TourList *tl, city_t a, city_t b)
+{                 /* a before b, counting from the segment of rank 0 */
+  if (tl->nodes[a].seg == tl->nodes[b].seg)
+    return Order(tl, a) < Order(tl, b);
+  return tl->segs[tl->nodes[a].seg].rank < tl->segs[tl->nodes[b].seg].rank;
+}
+
+int TourBetween(TourList *tl, city_t a, city_t b, city_t c)
+{
+  if (!Before(tl, c, a))
+    return !Before(tl, b, a) && !Before(tl, c, b);
+  return !Before(tl, b, a) || !Before(tl, c, b);
+}
+
+
+/*** REVERSALS *************************************************************/
+
+/*** Renumber: gives the nodes of segment s the ids 0, 1, ... again *******/
+
+static void Renumber(TourList *tl, int s)
+{
+  city_t c = tl->segs[s].first;
+  int    id;
+
+  for (id=0; id<tl->segs[s].size; id++) {
+    tl->nodes[c].id = id;
+    c = tl->nodes[c].next;
+  }
+}
+
+/*** MovePiece: hands the m cities at one end of segment s over to the ***
+ *              neighbouring segment t on that side: the head of s (which *
+ *              becomes the tail of t) if at_end, else the tail of s      *
+ *              (which becomes the head of t)                             *
+ ***************************************************************************/
+
+static void MovePiece(TourList *tl, int s, int m, int t, int at_end)
+{
+  int    flip = tl->segs[s].reversed != tl->segs[t].reversed;
+  int    count, id, step;
+  city_t c, hold, end = 0;
+
+  if (at_end) {                          /* from the head of s forward */
+    if (tl->segs[t].reversed) {
+      id = tl->nodes[tl->segs[t].first].id - 1;  step = -1;
+    } else {
+      id = tl->nodes[tl->segs[t].last].id + 1;   step = 1;
+    }
+    for (c=SegHead(tl, s), count=0; count<m; c=hold, count++) {
+      hold = TourNext(tl, c);
+      tl->nodes[c].seg = t;
+      tl->nodes[c].id  = id;
+      id += step;
+      if (flip)
+        FlipLinks(tl, c);
+      end = c;
+    }
+    if (tl->segs[t].reversed)             /* end: the new tail of t, */
+      tl->segs[t].first = end;            /* c: the new head of s    */
+    else
+      tl->segs[t].last  = end;
+    if (tl->segs[s].reversed)
+      tl->segs[s].last  = c;
+    else
+      tl->segs[s].first = c;
+  } else {                               /* from the tail of s back */
+    if (tl->segs[t].reversed) {
+      id = tl->nodes[tl->segs[t].last].id + 1;   step = 1;
+    } else {
+      id = tl->nodes[tl->segs[t].first].id - 1;  step = -1;
+    }
+    for (c=SegTail(tl, s), count=0; count<m; c=hold, count++) {
+      hold = TourPrev(tl, c);
+      tl->nodes[c].seg = t;
+      tl->nodes[c].id  = id;
+      id += step;
+      if (flip)
+        FlipLinks(tl, c);
+      end = c;
+    }
+    if (tl->segs[t].reversed)             /* end: the new head of t, */
+      tl->segs[t].last  = end;            /* c: the new tail of s    */
+    else
+      tl->segs[t].first = end;
+    if (tl->segs[s].reversed)
+      tl->segs[s].first = c;
+    else
+      tl->segs[s].last  = c;
+  }
+  tl->segs[s].size -= count;
+  tl->segs[t].size += count;
+  if (abs(id) > ID_LIMIT)
+    Renumber(tl, t);
+  if (tl->ntouched <= TOUCHED_MAX-2) {           /* for Rebalance */
+    tl->touched[tl->ntouched++] = s;
+    tl->touched[tl->ntouched++] = t;
+  }
+}
+
+/*** SplitBefore: makes b the head of its segment *************************/
+
+static void SplitBefore(TourList *tl, city_t b)
+{
+  int    s = tl->nodes[b].seg;
+  city_t head = SegHead(tl, s);
+  int    before;                  /* cities of the segment ahead of b */
+
+  if (b == head)
+    return;
+  before = Order(tl, b) - Order(tl, head);
+  if (before <= tl->segs[s].size - before)
+    MovePiece(tl, s, before, tl->segs[s].prev, 1);
+  else
+    MovePiece(tl, s, tl->segs[s].size - before, tl->segs[s].next, 0);
+}
+
+/*** SplitAfter: makes c the tail of its segment, without touching b, the **
+ *               head of its own segment                                   *
+ ***************************************************************************/
+
+static void SplitAfter(TourList *tl, city_t c, city_t b)
+{
+  int    s = tl->nodes[c].seg;
+  city_t tail = SegTail(tl, s);
+  int    upto;                        /* cities of the segment up to c */
+
+  if (c == tail)
+    return;
+  upto = Order(tl, c) - Order(tl, SegHead(tl, s)) + 1;
+  if (s != tl->nodes[b].seg &&
+      (upto <= tl->segs[s].size - upto || tl->segs[s].next == tl->nodes[b].seg))
+    MovePiece(tl, s, upto, tl->segs[s].prev, 1);
+  else
+    MovePiece(tl, s, tl->segs[s].size - upto, tl->segs[s].next, 0);
+}
+
+/*** RankSegments: numbers the segments 0, 1, ... along the tour again, ***
+ *                 from s on                                               *
+ ***************************************************************************/
+
+static void RankSegments(TourList *tl, int s)
+{
+  int rank;
+
+  for (rank=0; rank<tl->nsegs; rank++, s=tl->segs[s].next)
+    tl->segs[s].rank = rank;
+}
+
+/*** Smaller: the smaller of the two neighbouring segments of s **********/
+
+static int Smaller(TourList *tl, int s)
+{
+  int sa = tl->segs[s].prev, sd = tl->segs[s].next;
+
+  return tl->segs[sa].size <= tl->segs[sd].size ? sa : sd;
+}
+
+/*** MergeSegment: hands all of segment s over to its neighbour t and *****
+ *                 takes s out of the tour                                 *
+ ***************************************************************************/
+
+static void MergeSegment(TourList *tl, int s, int t)
+{
+  int sa = tl->segs[s].prev, sd = tl->segs[s].next;
+
+  MovePiece(tl, s, tl->segs[s].size, t, t == sa);
+  tl->segs[sa].next = sd;
+  tl->segs[sd].prev = sa;
+  tl->spare[tl->nspare++] = s;
+  tl->nsegs--;
+  RankSegments(tl, sd);
+}
+
+/*** SplitSegment: cuts segment s in two halves, the one with the higher ***
+ *                 ids going to a spare segment; both keep the reversal    *
+ *                 bit, so no link changes                                 *
+ ***************************************************************************/
+
+static void SplitSegment(TourList *tl, int s)
+{
+  int    u, k, half = tl->segs[s].size / 2;
+  city_t c, m = tl->segs[s].first;
+
+  if (tl->nspare == 0)
+    error("SplitSegment: no segment left to split %d into", s);
+  u = tl->spare[--tl->nspare];
+
+  for (k=half; k<tl->segs[s].size; k++)       /* m: the first node of u */
+    m = tl->nodes[m].next;
+  tl->segs[u].reversed = tl->segs[s].reversed;
+  tl->segs[u].first    = m;
+  tl->segs[u].last     = tl->segs[s].last;
+  tl->segs[u].size     = half;
+  tl->segs[s].last     = tl->nodes[m].prev;
+  tl->segs[s].size    -= half;
+  for (c=m; ; c=tl->nodes[c].next) {
+    tl->nodes[c].seg = u;
+    if (c == tl->segs[u].last)
+      break;
+  }
+
+  if (tl->segs[s].reversed) {               /* u is ahead of s in the tour */
+    tl->segs[u].prev = tl->segs[s].prev;
+    tl->segs[u].next = s;
+    tl->segs[tl->segs[s].prev].next = u;
+    tl->segs[s].prev = u;
+  } else {                                           /* u follows s */
+    tl->segs[u].next = tl->segs[s].next;
+    tl->segs[u].prev = s;
+    tl->segs[tl->segs[s].next].prev = u;
+    tl->segs[s].next = u;
+  }
+  tl->nsegs++;
+  RankSegments(tl, s);
+}
+
+/*** Rebalance: brings the segments MovePiece left shorter than group/2 **
+ *              (while there are more than two) and then the ones longer   *
+ *              than 2*group back to size; a segment is evened out with    *
+ *              its smaller neighbour, unless the two of them are too few  *
+ *              cities for two segments (merge) or too many (split): that *
+ *              keeps merges and splits, which rank all segments again,   *
+ *              rare; the cities handed over add to touched, and a merge  *
+ *              leaves an emptied segment in there, which is skipped      *
+ ***************************************************************************/
+
+static void Rebalance(TourList *tl)
+{
+  int k, s, t, sum, g = tl->group;
+
+  for (k=0; k<tl->ntouched; k++) {
+    s = tl->touched[k];
+    if (tl->segs[s].size == 0 || 2*tl->segs[s].size >= g || tl->nsegs <= 2)
+      continue;
+    t   = Smaller(tl, s);
+    sum = tl->segs[s].size + tl->segs[t].size;
+    if (2*(sum/2) < g)
+      MergeSegment(tl, s, t);
+    else
+      MovePiece(tl, t, sum/2 - tl->segs[s].size, s, s == tl->segs[t].prev);
+  }
+  for (k=0; k<tl->ntouched; k++) {
+    s = tl->touched[k];
+    while (tl->segs[s].size > 2*g) {
+      t   = Smaller(tl, s);
+      sum = tl->segs[s].size + tl->segs[t].size;
+      if (sum - sum/2 > 2*g || t == s)
+        SplitSegment(tl, s);
+      else
+        MovePiece(tl, s, tl->segs[s].size - sum/2, t, t == tl->segs[s].prev);
+    }
+  }
+  tl->ntouched = 0;
+}
+
+/*** ReverseInside: reverses the path b..c which lies within one segment **
+ ***************************************************************************/
+
+static void ReverseInside(TourList *tl, city_t b, city_t c)
+{
+  int    s = tl->nodes[b].seg;
+  city_t a = TourPrev(tl, b), d = TourNext(tl, c);
+  city_t x, hold;
+  int    ids = tl->nodes[b].id + tl->nodes[c].id;
+  double w_ac = EdgeWeight(a, c), w_bd = EdgeWeight(b, d);
+
+  for (x=b; ; x=hold) {
+    hold = TourNext(tl, x);
+    FlipLinks(tl, x);
+    tl->nodes[x].id = ids - tl->nodes[x].id;
+    if (x == c)
+      break;
+  }
+  if (tl->segs[s].first == b)
+    tl->segs[s].first = c;
+  else if (tl->segs[s].first == c)
+    tl->segs[s].first = b;
+  if (tl->segs[s].last == b)
+    tl->segs[s].last = c;
+  else if (tl->segs[s].last == c)
+    tl->segs[s].last = b;
+
+  SetSuc(tl, a, c, w_ac);
+  SetPred(tl, c, a, w_ac);
+  SetSuc(tl, b, d, w_bd);
+  SetPred(tl, d, b, w_bd);
+}
+
+/*** ReverseSegments: reverses the path b..c, where b is the head of its ***
+ *                    segment and c the tail of its own, k segments on     *
+ ***************************************************************************/
+
+static void ReverseSegments(TourList *tl, city_t b, city_t c, int k)
+{
+  int    sb = tl->nodes[b].seg, sc = tl->nodes[c].seg;
+  int    sa = tl->segs[sb].prev, sd = tl->segs[sc].next;
+  int    rank = tl->segs[sb].rank;
+  int    s, hold, t;
+  city_t a = TourPrev(tl, b), d = TourNext(tl, c);
+  double w_ac = EdgeWeight(a, c), w_bd = EdgeWeight(b, d);
+
+  for (s=sb, t=0; t<k; t++, s=hold) {
+    hold = tl->segs[s].next;
+    tl->segs[s].next = tl->segs[s].prev;
+    tl->segs[s].prev = hold;
+    tl->segs[s].reversed ^= 1;
+  }
+  for (s=sc, t=0; t<k; t++, s=tl->segs[s].next)
+    tl->segs[s].rank = (rank + t) % tl->nsegs;
+  tl->segs[sa].next = sc;
+  tl->segs[sc].prev = sa;
+  tl->segs[sb].next = sd;
+  tl->segs[sd].prev = sb;
+
+  SetSuc(tl, a, c, w_ac);                   /* the bits of b and c flipped, */
+  SetPred(tl, c, a, w_ac);                  /* so their outer links are now */
+  SetSuc(tl, b, d, w_bd);                   /* where SetPred and SetSuc    */
+  SetPred(tl, d, b, w_bd);                  /* look for them               */
+}
+
+/*** ReversePath: reverses the path b..c (in tour direction), or the rest **
+ *                of the tour, which gives the same cycle, if that is      *
+ *                fewer segments                                           *
+ ***************************************************************************/
+
+static void ReversePath(TourList *tl, city_t b, city_t c)
+{
+  city_t a = TourPrev(tl, b), d = TourNext(tl, c);
+  int    k;
+
+  if (b == c || d == b || a == d)        /* all of the tour, or all but */
+    return;                              /* one city: the same cycle    */
+
+  if (tl->nodes[b].seg == tl->nodes[c].seg && Order(tl, b) <= Order(tl, c)) {
+    ReverseInside(tl, b, c);
+    return;
+  }
+  if (tl->nodes[d].seg == tl->nodes[a].seg && Order(tl, d) <= Order(tl, a)) {
+    ReverseInside(tl, d, a);
+    return;
+  }
+
+  SplitBefore(tl, b);
+  SplitAfter(tl, c, b);
+  k = (tl->segs[tl->nodes[c].seg].rank - tl->segs[tl->nodes[b].seg].rank + tl->nsegs) % tl->nsegs + 1;
+  if (2*k <= tl->nsegs)
+    ReverseSegments(tl, b, c, k);
+  else                                 /* d and a are segment ends too */
+    ReverseSegments(tl, d, a, tl->nsegs - k);
+  Rebalance(tl);
+}
+
+
+/*** MOVES *****************************************************************/
+
+void TourTwoOpt(TourList *tl, city_t a, city_t c)
+{
+  ReversePath(tl, TourNext(tl, a), c);
+}
+
+void TourSwapCities(TourList *tl, city_t a, city_t c)
+{
+  city_t   nb[4], x, y;
+  int      nnb = 0, k, m, s;
+  ListNode hold;
+
+  nb[0] = TourPrev(tl, a);  nb[1] = TourNext(tl, a);         /* their neighbours */
+  nb[2] = TourPrev(tl, c);  nb[3] = TourNext(tl, c);
+  for (k=0; k<4; k++) {                          /* without a, c or twice */
+    if (nb[k] == a || nb[k] == c)
+      continue;
+    for (m=0; m<nnb; m++)
+      if (nb[m] == nb[k])
+        break;
+    if (m == nnb)
+      nb[nnb++] = nb[k];
+  }
+
+  hold     = tl->nodes[a];                     /* a takes the place of c ... */
+  tl->nodes[a] = tl->nodes[c];
+  tl->nodes[c] = hold;
+  if (tl->nodes[a].next == a) tl->nodes[a].next = c;    /* ... which is next to */
+  if (tl->nodes[a].prev == a) tl->nodes[a].prev = c;    /* a if they were       */
+  if (tl->nodes[c].next == c) tl->nodes[c].next = a;    /* neighbours           */
+  if (tl->nodes[c].prev == c) tl->nodes[c].prev = a;
+
+  for (k=0; k<nnb; k++) {                 /* the neighbours point across */
+    y = nb[k];
+    if (tl->nodes[y].next == a)       tl->nodes[y].next = c;
+    else if (tl->nodes[y].next == c)  tl->nodes[y].next = a;
+    if (tl->nodes[y].prev == a)       tl->nodes[y].prev = c;
+    else if (tl->nodes[y].prev == c)  tl->nodes[y].prev = a;
+  }
+  for (k=0; k<2; k++) {                      /* and so do the segments */
+    s = tl->nodes[k ? c : a].seg;
+    if (k && s == tl->nodes[a].seg)
+      break;
+    if (tl->segs[s].first == a)       tl->segs[s].first = c;
+    else if (tl->segs[s].first == c)  tl->segs[s].first = a;
+    if (tl->segs[s].last == a)        tl->segs[s].last = c;
+    else if (tl->segs[s].last == c)   tl->segs[s].last = a;
+  }
+
+  for (k=0; k<2; k++) {                    /* weigh the edges of a and c */
+    x = k ? c : a;
+    y = tl->nodes[x].next;
+    tl->nodes[x].wnext = EdgeWeight(x, y);
+    if (tl->nodes[y].next == x) tl->nodes[y].wnext = tl->nodes[x].wnext;
+    if (tl->nodes[y].prev == x) tl->nodes[y].wprev = tl->nodes[x].wnext;
+    y = tl->nodes[x].prev;
+    tl->nodes[x].wprev = EdgeWeight(x, y);
+    if (tl->nodes[y].next == x) tl->nodes[y].wnext = tl->nodes[x].wprev;
+    if (tl->nodes[y].prev == x) tl->nodes[y].wprev = tl->nodes[x].wprev;
+  }
+}
@@ -0,0 +1,58 @@
+/* SRV 2026-10-17
+ * tour_list.h: the tour as a two-level doubly-linked list (Fredman et al.)
+ * for big instances; the cities are grouped into about sqrt(n) segments,
+ * each with its own reversal bit, so a path is reversed in O(sqrt(n))
+ * rather than O(n), and next, prev and between take O(1). Moves on it are
+ * named by cities, not tour positions. */
+
+#ifndef TOUR_LIST_INCLUDED
+#define TOUR_LIST_INCLUDED
+
+#include "edge_wt.h"
+
+/* a tour, one per annealing chain; what it holds is private to tour_list.c */
+typedef struct TourList TourList;
+
+/*** TourListBuild: builds the list from the flat tour order[0..ncities-1] *
+ *                  where len[p] is the weight of the edge from order[p]   *
+ *                  to order[p+1] (mod ncities), as in move.c's edge_len;  *
+ *                  rebuilds tl, or a new list if tl is NULL, and returns  *
+ *                  it                                                     *
+ ***************************************************************************/
+TourList *TourListBuild(TourList *tl, const city_t *order, const double *len);
+
+/*** TourListFlatten: writes the tour back into flat arrays, starting from *
+ *                    order[0]: order and len as above, and position[c]    *
+ *                    the index of city c in order                         *
+ ***************************************************************************/
+void TourListFlatten(TourList *tl, city_t *order, city_t *position, double *len);
+
+void TourListFree(TourList *tl);
+
+/*** TourNext, TourPrev: the city after/before a in tour direction *********
+ ***************************************************************************/
+city_t TourNext(TourList *tl, city_t a);
+
+city_t TourPrev(TourList *tl, city_t a);
+
+/*** TourNextLen, TourPrevLen: weight of the edge from a to TourNext(a)/ ***
+ *                             TourPrev(a), kept with the links            *
+ ***************************************************************************/
+double TourNextLen(TourList *tl, city_t a);
+
+double TourPrevLen(TourList *tl, city_t a);
+
+/*** TourBetween: 1 if b is on the way from a to c (a and c included) ******
+ ***************************************************************************/
+int TourBetween(TourList *tl, city_t a, city_t b, city_t c);
+
+/*** TourTwoOpt: the 2-opt move that replaces the edges (a, next a) and ****
+ *               (c, next c) by (a, c) and (next a, next c)                *
+ ***************************************************************************/
+void TourTwoOpt(TourList *tl, city_t a, city_t c);
+
+/*** TourSwapCities: exchanges the places of cities a and c in the tour ****
+ ***************************************************************************/
+void TourSwapCities(TourList *tl, city_t a, city_t c);
+
+#endif
@@ -49,6 +49,10 @@
 #include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>                /* hardware cache miss count */
+#include <sys/syscall.h>
+#endif
 
 
 #include "error.h"
@@ -58,6 +62,7 @@
 #include "sa.h"   /* generic lam parms and problem specific state variables */
 #include "initialize.h"
 #include "random.h"
+#include "group.h"                   /* teams of threads for hybrid mode */
 /* also includes generic prototypes for app specific move routines */
 
 #ifndef MPI_INCLUDED
@@ -160,6 +165,13 @@ static int    diff_outfile = 0;  /* set to 1 if the output file has a diff na- *
                                   * me than input file when using -w           */
            /* set the landscape flag (and the landscape filename) in lsa.c */
 
+static int    miss_fd = -1;      /* fd of the cache miss counter (-t only) */
+static long long cache_misses = -1;  /* misses summed over all nodes, or   *
+                                      * -1 if there is no counter          */
+static unsigned long final_moves;  /* moves of this node's chains, kept *
+                                    * for PrintTimes, which comes after   *
+                                    * the chains' moves are freed (SRV)   */
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -431,7 +443,7 @@ void InitDistribution(FILE *fp)
 	  ((DistP.distribution == 5)||(DistP.distribution == 8)||(DistP.distribution == 10))
 	  {error ("tsp_sa: chose a distribution that returns positive values \n");
 	  }
-	else if (DistP.distribution == 7 )
+	else if ((DistP.distribution == 7) || (DistP.distribution == 11))
           {  
 	    if ((DistP.q >= 3.0) || (DistP.q <= 1.0))
 	      {error ("tsp_sa: q must be between 1 and 3 \n");}
@@ -449,6 +461,8 @@ void InitDistribution(FILE *fp)
 	    /* do not change for entire run.      */
 	    /* these live in distributions.h      */
 	    /***************LG 05-02***************/ 
+
+	dev_init(DistP.distribution, DistP.q);   /* the sampler, once (SRV) */
 }  /* end InitDistribution */
 
 
@@ -469,14 +483,14 @@ void InitDistribution(FILE *fp)
 * opens the input file,                                                    *
 * *** should open output file, but initialize(lsa.c) does it  ***          * 
 * calls InitTSP(move.c) - reads problem specific data, and gets intial tour*
-* calls InitMoves (move.c) - stats=0, gets aparms & randomizes xsubj       *
-* calculates initial energy and returns it as a parameter                  *
+* calls InitMoves (move.c) - stats=0, gets aparms & seeds the generator    *
+* calculates initial energy and puts it into the chain an (an->energy)     *
 * sets global minimum variables;                                           *
 * returns initial temperature (ap.start_tempr)                             *
 ***************************************************************************/
 
 double InitialMove (int argc, char ** argv, int opt_index,
-                    NucStatePtr state_ptr, double *p_chisq)
+                    NucStatePtr state_ptr, Annealer *an)
 { /* BEGIN InitialMove */
 
   FILE    *param_infile;
@@ -540,8 +554,10 @@ double InitialMove (int argc, char ** argv, int opt_index,
     ngroups=in_tune.ngroups;
     score_method=in_tune.score_method;
     glob_interval=in_tune.glob_interval;
+    state_ptr->tune.shmem_flag          = in_tune.shmem_flag;
+    nthreads = in_tune.shmem_flag > 1 ? in_tune.shmem_flag : 1;
 #endif
-    AssignGroups();
+    AssignGroups(an);
   
 /* initialize some Lam/Greening structures */
   p = state_ptr->tune.progname;     /* tune.progname contains program name */
@@ -563,20 +579,42 @@ double InitialMove (int argc, char ** argv, int opt_index,
   }
 
                     /* read input from tsp lib file */
-	           /* generate initial tour and get initial energy */
         InitTSP(instance_infile); /* this routine is in move.c */
-        *p_chisq = StartTour(); /* this routine is in move.c */
 
  /* set initial temperature and initialize random number generator and *
-  * annealing parameters                                               */
+  * annealing parameters; this comes before StartTour now, since it    *
+  * sets up the distance matrix that tour_cost uses (SRV 2026-10-17)   */
 	i_temp   = InitMoves(param_infile, state_ptr->tune.tau); 
+#ifdef MPI
+        if ( nthreads > 1 )         /* the chains share the neighbour rows */
+          ShareNeighbourTable();
+#endif
+
+	           /* generate initial tour and get initial energy */
+        an->energy = StartTour(an); /* this routine is in move.c */
         InitDistribution(param_infile);   /* initialize distribution stuff */
         fclose(param_infile);
         fclose(instance_infile);
 
+  if ( time_flag )
+    StartMissCounter();
+
   return i_temp;
 }
 
+#ifdef MPI
+/*** InitialChain: sets up chain 'thread' of a rank in hybrid mode: its ****
+ *                 own generator stream, move state and initial tour; the  *
+ *                 problem instance is the one InitialMove read            *
+ ***************************************************************************/
+
+void InitialChain(Annealer *an, int thread)
+{
+  InitThreadMoves(thread);
+  an->energy = StartTour(an);
+}
+#endif
+
 /***************************************************************************
  * functions that communicate with savestate.c.                            *
  * *************************************************************************/
@@ -694,7 +732,7 @@ void RestoreOptions(Opts *options)
  ***************************************************************************/
 
 
-void RestoreState(char *statefile, NucStatePtr state_ptr, double *p_chisq)
+void RestoreState(char *statefile, NucStatePtr state_ptr, Annealer *an)
 {
   FILE           *infile;                /* pointer to original input file */
   FILE           *instance_infile, *param_infile;
@@ -706,7 +744,7 @@ void RestoreState(char *statefile, NucStatePtr state_ptr, double *p_chisq)
   Opts           *options;         /* used to restore command line options */
   MoveState      *move_ptr;                       /* used to restore moves */
   double         *stats;                      /* used to restore Lam stats */
-  unsigned short *rand;                         /* used to restore ERand48 */
+  RandState      *rand;          /* used to restore the random generator */
   double         delta[2];                        /* used to restore times */
   double         _temp;
 
@@ -721,7 +759,7 @@ void RestoreState(char *statefile, NucStatePtr state_ptr, double *p_chisq)
 
   stats    = (double *)calloc(31, sizeof(double));
   move_ptr = (MoveState *)malloc(sizeof(MoveState));
-  rand     = (unsigned short *)calloc(3, sizeof(unsigned short));
+  rand     = (RandState *)calloc(1, sizeof(RandState));
 
   StateRead(statefile, options, move_ptr, stats, rand, delta);
   
@@ -771,10 +809,12 @@ void RestoreState(char *statefile, NucStatePtr state_ptr, double *p_chisq)
  fclose(param_infile);
  fclose(instance_infile);
      RestoreMoves(move_ptr);
-    RestoreLamstats(stats);
-  if (time_flag)
+    RestoreLamstats(an, stats);
+  if (time_flag) {
     RestoreTimes(delta);
-    InitERand(rand);
+    StartMissCounter();
+  }
+    SetRandomState(rand);
   if( prolix_flag )
     RestoreProlix();
   free(param_inname);
@@ -790,13 +830,17 @@ void RestoreState(char *statefile, NucStatePtr state_ptr, double *p_chisq)
 * Calculates and  prints the final tour cost;        *
 * deallocates tour memory.                           *
 ******************************************************/
-void FinalMove( void )
+void FinalMove(Annealer *an)
 
 {  /* begin final_move*/
   FILE     *outfile;                             /* pointer to output file */
   int      i = 0;                           /* loop counter */
   AParms   ap;           /* annealing parameter stuct for annealing output */
   double   equil_var[2];         /* array for results of equilibration run */
+  unsigned long cache_stats[3];     /* neighbour cache hits/misses/evictions */
+  char     cache_line[MAX_RECORD];           /* log line for those stats */
+  unsigned long moves;              /* moves of the chain(s), for -t */
+  double   rank_stats[2];    /* ns spent drawing neighbour ranks, ranks */
 
 
 #ifdef MPI
@@ -804,16 +848,25 @@ void FinalMove( void )
   double   minyet = DBL_MAX;         /* minimum score, used to find winner */
 
   double   *final_e;               /* array of final energies of all nodes */
+  double   team_e[TEAM_MAX];       /* hybrid mode: those of the rank's chains */
+  int      best = 0;                  /* ... and the rank's best chain */
   
   final_e = (double *)calloc(nnodes, sizeof(double));
 #endif
 
 /* get the final energies and iterations from move.c */
-  ap = GetFinalInfo();
+  ap = GetFinalInfo(an->move);
+  moves = (unsigned long)ap.max_count;        /* this chain's nhits ... */
+#ifdef MPI
+  if ( nthreads > 1 )                    /* ... and in hybrid mode, all */
+    TeamSumLong(an->team, an->thread, &moves, 1);   /* the rank's chains' */
+#endif
+  if ( an->thread == 0 )
+    final_moves = moves;
 
 /* for equilibration runs: get the final equilibration results */
   if ( equil )
-    GetEquil(equil_var);
+    GetEquil(an, equil_var);
 #ifdef MPI
 /* Seb: Might change this to use MPI_Reduce instead of this interesting choice *
  * We shall see. */
@@ -826,6 +879,21 @@ void FinalMove( void )
 //  for(i=0; i<nnodes; i++)                   /* initialize the energy array */
 //    final_e[i] = 0;  
   
+/* hybrid mode: the best chain of each rank competes for its rank; thread */
+/* 0 then finds the winning rank and tells the others                      */
+
+  if ( nthreads > 1 ) {
+    TeamAllgather(an->team, an->thread, &ap.stop_energy, team_e, sizeof(double));
+    for (i=0; i<nthreads; i++)
+      if ( team_e[i] <= minyet ) {
+        minyet = team_e[i];
+        best   = i;
+      }
+    ap.stop_energy = minyet;
+    minyet = DBL_MAX;
+  }
+
+  if ( an->thread == 0 ) {
                                 /* collect the final scores from all nodes */
   MPI_Allgather(&ap.stop_energy, 1, MPI_DOUBLE, final_e, 1, MPI_DOUBLE, 
 		MPI_COMM_WORLD);
@@ -836,6 +904,13 @@ void FinalMove( void )
       winner = i;
     }
   }
+  }
+
+  if ( nthreads > 1 ) {
+    TeamBcast(an->team, an->thread, &winner, sizeof(int), 0);
+    if ( an->thread != best )
+      winner = -1;
+  }
 
 /* write the answer to the output file */
 
@@ -857,7 +932,7 @@ void FinalMove( void )
     if ( equil ) 
       PrintEquil(outfile, equil_var, "equilibrate_variance"); 
     else
-      WriteResults(outfile, precision);
+      WriteResults(an->move, outfile, precision);
    
     fclose(outfile);
 #ifdef MPI
@@ -870,9 +945,66 @@ void FinalMove( void )
       /*States Not Implemented at the moment - SRV 2025-11-16 */
       //StateRm();
 
-/* free all memory */
-	tour_deallocate();
-  free(node_coords);
+/* hardware cache misses, summed over all nodes, for the .times file */
+  if ( time_flag && an->thread == 0 )
+    StopMissCounter();
+
+/* report the neighbour row cache, summed over all nodes, to the .log */
+/* (in hybrid mode, the chains of a rank count their hits each) */
+  if ( GetNeighbourCacheStats(cache_stats) ) {
+#ifdef MPI
+    if ( nthreads > 1 )
+      TeamSumLong(an->team, an->thread, cache_stats, 1);
+#endif
+    if ( an->thread == 0 ) {
+#ifdef MPI
+    MPI_Allreduce(MPI_IN_PLACE, cache_stats, 3, MPI_UNSIGNED_LONG, MPI_SUM,
+                  MPI_COMM_WORLD);
+#endif
+    sprintf(cache_line, "Neighbour cache: hits = %lu misses = %lu "
+            "evictions = %lu hit_ratio = %.4f", cache_stats[0], cache_stats[1],
+            cache_stats[2], (cache_stats[0]+cache_stats[1]) ?
+            (double)cache_stats[0]/(double)(cache_stats[0]+cache_stats[1]) : 0.);
+    WriteLogComment(cache_line);
+    }
+  }
+
+/* report what drawing the move sizes (neighbour ranks) cost per move */
+  GetRankStats(an->move, rank_stats);
+#ifdef MPI
+  if ( nthreads > 1 )
+    TeamSum(an->team, an->thread, rank_stats, 2);
+#endif
+  if ( an->thread == 0 ) {
+#ifdef MPI
+  MPI_Allreduce(MPI_IN_PLACE, rank_stats, 2, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD);
+#endif
+  sprintf(cache_line, "Move sizes: distribution %d took %.1f ns per move "
+          "(%.0f moves)", DistP.distribution,
+          rank_stats[1] > 0. ? rank_stats[0]/rank_stats[1] : 0., rank_stats[1]);
+  WriteLogComment(cache_line);
+  }
+
+/* free all memory; in hybrid mode, the chains of a rank share all but     */
+/* their tours and scratch, which thread 0 frees once they are all done    */
+	tour_deallocate(an->move);
+  an->move = NULL;
+#ifdef MPI
+  if ( nthreads > 1 ) {
+    if ( an->thread != 0 )
+      FreeThreadMoves();
+    TeamBarrier(an->team, an->thread);
+    if ( an->thread != 0 )
+      return;
+  }
+#endif
+  FreeNeighbourTable();
+  FreeSpatialGrid();
+  FreeDistanceMatrix();
+  FreeDistances();
+  FreeCityLabels();
+  FreeCoords();
   
 }  /* end FinalMove*/
 
@@ -946,6 +1078,7 @@ SAType ReadTune(FILE *fp)
   double dbuf4;
 
   unsigned short sbuf;
+  char   title[MAX_RECORD];                     /* buffer for title lines */
 
 
 
@@ -1000,6 +1133,13 @@ SAType ReadTune(FILE *fp)
       error("ReadTune: score method value was not recognised.");
   }
   in_tune.score_method=sbuf;
+
+                /* threads per rank (hybrid mode), unless the section ends */
+  in_tune.shmem_flag = 0;
+  if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' )
+    if ( 1 != fscanf(fp, "%hu\n", &in_tune.shmem_flag) ||
+         in_tune.shmem_flag > TEAM_MAX )
+      error("ReadTune: error reading threads");
 #endif
 
   in_tune.tunefile  = NULL;                  /* We're not using this stuff */
@@ -1052,6 +1192,137 @@ AParms ReadAParameters(FILE *fp)
 
 
 
+/*** ReadEdgeParameters: reads the EdgeParms struct from the optional ******
+ *                       edge_parameters section; older .params files do   *
+ *                       not have one, so we fall back to the defaults     *
+ *                       in edge_wt.h; trailing entries may be left out    *
+ *                       and keep their defaults too - SRV 2026-10-17      *
+ ***************************************************************************/
+
+EdgeParms ReadEdgeParameters(FILE *fp)
+{
+  EdgeParms  l_eparms;                           /* local EdgeParms struct */
+  char       title[MAX_RECORD];                 /* buffer for title lines */
+
+  l_eparms.neighbour_k           = NEIGHBOUR_K_DEFAULT;
+  l_eparms.neighbour_cache_bytes = 0;
+  l_eparms.distance_matrix_bytes = DIST_MATRIX_BYTES_DEFAULT;
+  l_eparms.city_order            = FILE_ORDER;
+
+  fp = FindSection(fp, "edge_parameters");
+  if( !fp )
+    return l_eparms;
+
+  fscanf(fp,"%*s\n");                         /* advance past title line 1 */
+
+  if ( 1 != fscanf(fp, "%hu\n", &(l_eparms.neighbour_k)) )
+    error("ReadEdgeParameters: error reading neighbour list size");
+
+                          /* title line 2, unless the section ends here */
+  if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' ) {
+    if ( 1 != fscanf(fp, "%ld\n", &(l_eparms.neighbour_cache_bytes)) ||
+         l_eparms.neighbour_cache_bytes < 0 )
+      error("ReadEdgeParameters: error reading neighbour cache budget");
+
+                          /* title line 3, unless the section ends here */
+    if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' ) {
+      if ( 1 != fscanf(fp, "%ld\n", &(l_eparms.distance_matrix_bytes)) ||
+           l_eparms.distance_matrix_bytes < 0 )
+        error("ReadEdgeParameters: error reading distance matrix cap");
+
+                          /* title line 4, unless the section ends here */
+      if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' ) {
+        if ( 1 != fscanf(fp, "%d\n", &(l_eparms.city_order)) ||
+             l_eparms.city_order < FILE_ORDER ||
+             l_eparms.city_order > MORTON_ORDER )
+          error("ReadEdgeParameters: error reading city order");
+      }
+    }
+  }
+
+  return l_eparms;
+}
+
+
+
+/*** ReadMoveParameters: reads the MoveParms struct from the optional ******
+ *                       move_parameters section; older .params files do   *
+ *                       not have one, and then we only swap; trailing     *
+ *                       entries may be left out (0, batch_size 1) - SRV   *
+ *                       2026-10-17                                        *
+ ***************************************************************************/
+
+MoveParms ReadMoveParameters(FILE *fp)
+{
+  MoveParms  l_mparms;                           /* local MoveParms struct */
+  char       title[MAX_RECORD];                 /* buffer for title lines */
+
+  l_mparms.two_opt_fraction = 0.;
+  l_mparms.or_opt_fraction  = 0.;
+  l_mparms.adaptive_selection = 0;
+  l_mparms.tour_list          = 0;
+  l_mparms.batch_size         = 1;
+  l_mparms.nfold_acc_ratio    = 0.;
+
+  fp = FindSection(fp, "move_parameters");
+  if( !fp )
+    return l_mparms;
+
+  fscanf(fp,"%*s\n");                         /* advance past title line 1 */
+
+  if ( 1 != fscanf(fp, "%lf\n", &(l_mparms.two_opt_fraction)) ||
+       l_mparms.two_opt_fraction < 0. || l_mparms.two_opt_fraction > 1. )
+    error("ReadMoveParameters: error reading 2-opt fraction");
+
+                          /* title line 2, unless the section ends here */
+  if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' ) {
+    if ( 1 != fscanf(fp, "%lf\n", &(l_mparms.or_opt_fraction)) ||
+         l_mparms.or_opt_fraction < 0. ||
+         l_mparms.two_opt_fraction + l_mparms.or_opt_fraction > 1. )
+      error("ReadMoveParameters: error reading Or-opt fraction");
+
+                                                    /* title line 3, ditto */
+    if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' ) {
+      if ( 1 != fscanf(fp, "%d\n", &(l_mparms.adaptive_selection)) ||
+           l_mparms.adaptive_selection < 0 || l_mparms.adaptive_selection > 1 )
+        error("ReadMoveParameters: error reading adaptive_selection");
+
+                                                    /* title line 4, ditto */
+      if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' ) {
+        if ( 1 != fscanf(fp, "%d\n", &(l_mparms.tour_list)) ||
+             l_mparms.tour_list < 0 || l_mparms.tour_list > 1 )
+          error("ReadMoveParameters: error reading tour_list");
+
+                                                    /* title line 5, ditto */
+        if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' ) {
+          if ( 1 != fscanf(fp, "%d\n", &(l_mparms.batch_size)) ||
+               l_mparms.batch_size < 1 ||
+               l_mparms.batch_size > MOVE_BATCH_MAX )
+            error("ReadMoveParameters: error reading batch_size");
+
+                                                    /* title line 6, ditto */
+          if ( 1 == fscanf(fp, "%255s\n", title) && title[0] != '$' ) {
+            if ( 1 != fscanf(fp, "%lf\n", &(l_mparms.nfold_acc_ratio)) ||
+                 l_mparms.nfold_acc_ratio < 0. ||
+                 l_mparms.nfold_acc_ratio > 1. )
+              error("ReadMoveParameters: error reading nfold_acc_ratio");
+          }
+        }
+      }
+    }
+  }
+
+/* the rejection-free mode knows the swap moves on the array tour only */
+  if ( l_mparms.nfold_acc_ratio > 0. &&
+       ( l_mparms.two_opt_fraction > 0. || l_mparms.or_opt_fraction > 0. ||
+         l_mparms.adaptive_selection || l_mparms.tour_list ) )
+    error("ReadMoveParameters: nfold_acc_ratio needs swap moves only");
+
+  return l_mparms;
+}
+
+
+
 
 /*** WriteTimes: writes the time-structure to a .times file ****************
  ***************************************************************************/
@@ -1080,13 +1351,69 @@ void WriteTimes(double *times)
 
 
 
-/*** PrintTimes: writes two (parallel: three) times sections ***************
+/*** PrintTimes: writes two (parallel: three) times sections; also the ****
+ *               move throughput (moves of this node per wallclock second) *
+ *               which is what we compare move generator changes by        *
  ***************************************************************************/
 
 void PrintTimes(FILE *fp, double *times)
 {
   fprintf(fp, "wallclock: %.3f\n", times[0]);
   fprintf(fp, "user:      %.3f\n", times[1]);
+  if ( times[0] > 0. )
+    fprintf(fp, "moves/sec: %.0f\n", (double)final_moves/times[0]);
+  if ( cache_misses >= 0 )
+    fprintf(fp, "cache misses: %lld\n", cache_misses);
+}
+
+
+
+/*** StartMissCounter: starts counting the hardware cache misses of this ***
+ *                     process (user space only), if the kernel lets us;   *
+ *                     used to see what the city order does (SRV 2026)     *
+ ***************************************************************************/
+
+void StartMissCounter(void)
+{
+#ifdef __linux__
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size           = sizeof(attr);
+  attr.type           = PERF_TYPE_HARDWARE;
+  attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  miss_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+
+
+/*** StopMissCounter: reads the cache miss counter and sums it over all ****
+ *                    nodes into cache_misses; stays -1 if any node had   *
+ *                    no counter (VMs often don't have one)                *
+ ***************************************************************************/
+
+void StopMissCounter(void)
+{
+  long long misses = -1;                    /* this node's count, or -1 */
+  long long have;                           /* 1 if this node has one   */
+
+  if ( miss_fd >= 0 ) {
+    if ( read(miss_fd, &misses, sizeof(misses)) != sizeof(misses) )
+      misses = -1;
+    close(miss_fd);
+    miss_fd = -1;
+  }
+  have = (misses >= 0);
+#ifdef MPI
+  MPI_Allreduce(MPI_IN_PLACE, &have, 1, MPI_LONG_LONG, MPI_MIN,
+                MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, &misses, 1, MPI_LONG_LONG, MPI_SUM,
+                MPI_COMM_WORLD);
+#endif
+  cache_misses = have ? misses : -1;
 }
 
 